@@ -0,0 +1,10 @@
+# Libraries
+LIBS=protocolo pthread m z
+
+# Custom libraries' paths
+SHARED_LIBPATHS=
+STATIC_LIBPATHS=../protocolo
+
+# Compiler flags
+CDEBUG=-g -Wall -D_GNU_SOURCE -DDEBUG -fdiagnostics-color=always
+CRELEASE=-O3 -Wall -D_GNU_SOURCE -DNDEBUG
@@ -0,0 +1,451 @@
+/**
+ * @file bench.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del generador de carga del servidor
+ *
+ * Cada hilo recorre sus conexiones en ronda hasta que vence la duracion. En v2 completa la ventana de frames sin
+ * confirmar de cada conexion y despues espera con poll() los ACK de todas; en v1 envia un frame por conexion.
+ * Los frames se serializan una sola vez al inicio: durante la medicion solo se agrega el id al encabezado.
+ * Uso: bin/bench [-i ip] [-p puerto] [-c conexiones] [-t hilos] [-d segundos] [-m %mensajes]
+ *                [-s bytes_mensaje] [-e elementos_paquete] [-z bytes_elemento] [-v version] [-x umbral_compresion]
+ *                [-w ventana]
+ */
+
+#include "bench.h"
+
+static t_frame frame_mensaje;
+static t_frame frame_paquete;
+static t_parametros parametros;
+static struct timespec fin_medicion;
+
+static uint64_t ahora_ns(void)
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+}
+
+static void uso(char* programa)
+{
+	fprintf(stderr, "Uso: %s [-i ip] [-p puerto] [-c conexiones] [-t hilos] [-d segundos] [-m %%mensajes]\n"
+		"       [-s bytes_mensaje] [-e elementos_paquete] [-z bytes_elemento] [-v version]\n"
+		"       [-x umbral_compresion] [-w ventana]\n", programa);
+}
+
+int leer_parametros(int argc, char** argv, t_parametros* parametros)
+{
+	// Valores por defecto: el servidor local de server/src/utils.h
+	parametros->ip = "127.0.0.1";
+	parametros->puerto = "4444";
+	parametros->conexiones = 64;
+	parametros->hilos = sysconf(_SC_NPROCESSORS_ONLN);
+	parametros->duracion = 5;
+	parametros->porcentaje_mensajes = 80;
+	parametros->tamanio_mensaje = 64;
+	parametros->elementos_paquete = 10;
+	parametros->tamanio_elemento = 32;
+	parametros->version = PROTOCOLO_VERSION_MAXIMA;
+	parametros->umbral_compresion = 0;
+	parametros->ventana = 16;
+
+	int opcion;
+	while((opcion = getopt(argc, argv, "i:p:c:t:d:m:s:e:z:v:x:w:")) != -1) {
+		switch(opcion) {
+		case 'i': parametros->ip = optarg; break;
+		case 'p': parametros->puerto = optarg; break;
+		case 'c': parametros->conexiones = atoi(optarg); break;
+		case 't': parametros->hilos = atoi(optarg); break;
+		case 'd': parametros->duracion = atoi(optarg); break;
+		case 'm': parametros->porcentaje_mensajes = atoi(optarg); break;
+		case 's': parametros->tamanio_mensaje = atoi(optarg); break;
+		case 'e': parametros->elementos_paquete = atoi(optarg); break;
+		case 'z': parametros->tamanio_elemento = atoi(optarg); break;
+		case 'v': parametros->version = atoi(optarg); break;
+		case 'x': parametros->umbral_compresion = atoi(optarg); break;
+		case 'w': parametros->ventana = atoi(optarg); break;
+		default: return -1;
+		}
+	}
+
+	if(parametros->hilos > parametros->conexiones)
+		parametros->hilos = parametros->conexiones; // un hilo sin conexiones no mide nada
+	if(parametros->conexiones < 1 || parametros->hilos < 1 || parametros->duracion < 1
+		|| parametros->porcentaje_mensajes < 0 || parametros->porcentaje_mensajes > 100
+		|| parametros->tamanio_mensaje < 1 || parametros->elementos_paquete < 0 || parametros->tamanio_elemento < 1
+		|| parametros->version < PROTOCOLO_VERSION_1 || parametros->version > PROTOCOLO_VERSION_MAXIMA
+		|| parametros->umbral_compresion < 0 || (parametros->umbral_compresion > 0 && parametros->version < PROTOCOLO_VERSION_2)
+		|| parametros->ventana < 1)
+		return -1;
+	return 0;
+}
+
+int conectar(char* ip, char* puerto, int version, bool comprimir)
+{
+	// Con ids cada frame recibe su ACK. Los frames con id no consumen credito: el control de flujo es la ventana
+	int socket_cliente = protocolo_conectar(ip, puerto, version, PROTOCOLO_CAPACIDAD_IDS | (comprimir ? PROTOCOLO_CAPACIDAD_COMPRESION : 0));
+	if(socket_cliente != -1) // se mide al servidor, no al algoritmo de Nagle
+		setsockopt(socket_cliente, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+	return socket_cliente;
+}
+
+/**
+ * @brief Arma un frame con el encabezado de @p version, comprimiendo el payload si corresponde
+ */
+static t_frame armar_frame(int version, int cod_op, void* payload, int size, int umbral_compresion)
+{
+	uint8_t flags = 0;
+	t_compresor* compresor = NULL;
+	if(umbral_compresion > 0 && size >= umbral_compresion && (compresor = compresor_crear(COMPRESION_NIVEL_DEFECTO)) != NULL) {
+		void* comprimido;
+		int size_comprimido = compresor_comprimir(compresor, payload, size, &comprimido);
+		if(size_comprimido != -1) {
+			payload = comprimido;
+			size = size_comprimido;
+			flags |= PROTOCOLO_FLAG_COMPRIMIDO;
+		}
+	}
+
+	uint8_t encabezado[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int tamanio_encabezado = protocolo_codificar_encabezado(version, encabezado, cod_op, flags, size);
+
+	t_frame frame;
+	frame.encabezado = tamanio_encabezado;
+	frame.cod_op = cod_op;
+	frame.flags = flags;
+	frame.tamanio = tamanio_encabezado + size;
+	frame.datos = malloc(frame.tamanio);
+	memcpy(frame.datos, encabezado, tamanio_encabezado);
+	memcpy(frame.datos + tamanio_encabezado, payload, size);
+	if(compresor != NULL)
+		compresor_destruir(compresor);
+	return frame;
+}
+
+t_frame armar_mensaje(int version, int tamanio, int umbral_compresion)
+{
+	char* mensaje = malloc(tamanio);
+	memset(mensaje, 'm', tamanio - 1);
+	mensaje[tamanio - 1] = '\0';
+
+	t_frame frame = armar_frame(version, MENSAJE, mensaje, tamanio, umbral_compresion);
+	free(mensaje);
+	return frame;
+}
+
+t_frame armar_paquete(int version, int elementos, int tamanio, int umbral_compresion)
+{
+	uint8_t prefijo[VARINT_MAXIMO]; // alcanza tambien para el int de v1
+	int tamanio_prefijo = protocolo_codificar_elemento(version, prefijo, tamanio);
+	int size = elementos * (tamanio_prefijo + tamanio);
+
+	char* stream = malloc(size > 0 ? size : 1);
+	char* cursor = stream;
+	for(int i = 0; i < elementos; i++) { // mismo formato que agregar_a_paquete() (v1) o el emisor (v2): | tamanio | datos |
+		memcpy(cursor, prefijo, tamanio_prefijo);
+		memset(cursor + tamanio_prefijo, 'p', tamanio - 1);
+		cursor[tamanio_prefijo + tamanio - 1] = '\0';
+		cursor += tamanio_prefijo + tamanio;
+	}
+
+	t_frame frame = armar_frame(version, PAQUETE, stream, size, umbral_compresion);
+	free(stream);
+	return frame;
+}
+
+int enviar_frame(int socket, t_frame* frame)
+{
+	int enviados = 0;
+	while(enviados < frame->tamanio) {
+		ssize_t resultado = send(socket, (char*) frame->datos + enviados, frame->tamanio - enviados, MSG_NOSIGNAL);
+		if(resultado == -1) {
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		enviados += resultado;
+	}
+	return 0;
+}
+
+int enviar_frame_id(int socket, int version, t_frame* frame, uint32_t id)
+{
+	uint8_t encabezado[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int size = frame->tamanio - frame->encabezado;
+	int tamanio_encabezado = protocolo_codificar_encabezado_id(version, encabezado, frame->cod_op, frame->flags, size, id);
+	struct iovec partes[2] = {
+		{ .iov_base = encabezado, .iov_len = tamanio_encabezado },
+		{ .iov_base = (char*) frame->datos + frame->encabezado, .iov_len = size }
+	};
+	struct msghdr mensaje = { .msg_iov = partes, .msg_iovlen = 2 };
+
+	int total = tamanio_encabezado + size;
+	int enviados = 0;
+	while(enviados < total) {
+		ssize_t resultado = sendmsg(socket, &mensaje, MSG_NOSIGNAL);
+		if(resultado == -1) {
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		enviados += resultado;
+		// Envio parcial: se saltean las partes (y el pedazo de parte) que ya salieron
+		while(mensaje.msg_iovlen > 0 && (size_t) resultado >= mensaje.msg_iov->iov_len) {
+			resultado -= mensaje.msg_iov->iov_len;
+			mensaje.msg_iov++;
+			mensaje.msg_iovlen--;
+		}
+		if(mensaje.msg_iovlen > 0) {
+			mensaje.msg_iov->iov_base = (char*) mensaje.msg_iov->iov_base + resultado;
+			mensaje.msg_iov->iov_len -= resultado;
+		}
+	}
+	return total;
+}
+
+static bool termino(void)
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return ahora.tv_sec > fin_medicion.tv_sec
+		|| (ahora.tv_sec == fin_medicion.tv_sec && ahora.tv_nsec >= fin_medicion.tv_nsec);
+}
+
+static void caer(t_hilo_bench* hilo, t_conexion_bench* conexion)
+{
+	close(conexion->socket);
+	conexion->socket = -1;
+	hilo->errores++;
+}
+
+static t_frame* elegir_frame(t_hilo_bench* hilo)
+{
+	bool es_mensaje = (int) (rand_r(&hilo->semilla) % 100) < parametros.porcentaje_mensajes;
+	return es_mensaje ? &frame_mensaje : &frame_paquete;
+}
+
+static void contar_frame(t_hilo_bench* hilo, t_frame* frame, int tamanio)
+{
+	hilo->bytes += tamanio;
+	if(frame == &frame_mensaje)
+		hilo->mensajes++;
+	else
+		hilo->paquetes++;
+}
+
+/**
+ * @brief v1: sin ids no hay ACK, asi que solo se mide cuanto tarda el kernel en aceptar cada frame
+ */
+static void medir_envios(t_hilo_bench* hilo)
+{
+	while(!termino()) {
+		for(int i = 0; i < hilo->cantidad; i++) {
+			t_conexion_bench* conexion = &hilo->conexiones[i];
+			if(conexion->socket == -1)
+				continue; // conexion caida
+
+			t_frame* frame = elegir_frame(hilo);
+			uint64_t inicio = ahora_ns();
+			if(enviar_frame(conexion->socket, frame) == -1) {
+				caer(hilo, conexion);
+				continue;
+			}
+			histograma_registrar(&hilo->latencias, ahora_ns() - inicio);
+			contar_frame(hilo, frame, frame->tamanio);
+		}
+	}
+}
+
+/**
+ * @brief Envia frames con id hasta completar la ventana de la conexion
+ */
+static void completar_ventana(t_hilo_bench* hilo, t_conexion_bench* conexion)
+{
+	while(conexion->sin_confirmar < parametros.ventana) {
+		t_enviado* enviado = &conexion->enviados[conexion->proximo_id % parametros.ventana];
+		if(enviado->frame != NULL)
+			return; // los ACK pueden llegar desordenados: el de un id anterior todavia ocupa este lugar
+
+		enviado->frame = elegir_frame(hilo);
+		enviado->id = conexion->proximo_id++;
+		enviado->inicio = ahora_ns();
+		if((enviado->tamanio = enviar_frame_id(conexion->socket, parametros.version, enviado->frame, enviado->id)) == -1) {
+			caer(hilo, conexion);
+			return;
+		}
+		conexion->sin_confirmar++;
+	}
+}
+
+/**
+ * @brief Registra la ida y vuelta del frame al que contesta @p encabezado y libera su lugar en la ventana
+ * @note Lo que no contesta a un frame del bench (ej. un CREDITO) se ignora
+ */
+static void confirmar(t_hilo_bench* hilo, t_conexion_bench* conexion, t_encabezado* encabezado, uint8_t* payload, uint64_t llegada)
+{
+	if(!(encabezado->flags & PROTOCOLO_FLAG_ID))
+		return;
+	t_enviado* enviado = &conexion->enviados[encabezado->id % parametros.ventana];
+	if(enviado->frame == NULL || enviado->id != encabezado->id)
+		return;
+
+	histograma_registrar(&hilo->latencias, llegada - enviado->inicio);
+	if(encabezado->cod_op != ACK || encabezado->size < 1 || payload[0] != PROTOCOLO_ACK_OK)
+		hilo->rechazados++;
+	contar_frame(hilo, enviado->frame, enviado->tamanio);
+	enviado->frame = NULL;
+	conexion->sin_confirmar--;
+}
+
+/**
+ * @brief Lee sin bloquear los ACK que llegaron a la conexion
+ * @return 0 si sigue abierta, -1 si se cerro, fallo o mando algo que no es un frame valido
+ */
+static int leer_confirmaciones(t_hilo_bench* hilo, t_conexion_bench* conexion)
+{
+	ssize_t leidos;
+	while((leidos = recv(conexion->socket, conexion->entrada + conexion->recibidos, BENCH_ENTRADA - conexion->recibidos, MSG_DONTWAIT)) > 0) {
+		uint64_t llegada = ahora_ns();
+		conexion->recibidos += leidos;
+
+		int consumidos = 0;
+		int estado;
+		t_encabezado encabezado;
+		while((estado = protocolo_decodificar_encabezado(parametros.version, conexion->entrada + consumidos, conexion->recibidos - consumidos, &encabezado)) == 1
+			&& (uint64_t) encabezado.encabezado + encabezado.size <= (uint64_t) (conexion->recibidos - consumidos)) {
+			confirmar(hilo, conexion, &encabezado, conexion->entrada + consumidos + encabezado.encabezado, llegada);
+			consumidos += encabezado.encabezado + encabezado.size;
+		}
+		conexion->recibidos -= consumidos;
+		memmove(conexion->entrada, conexion->entrada + consumidos, conexion->recibidos);
+		if(estado == -1 || conexion->recibidos == BENCH_ENTRADA)
+			return -1; // el servidor solo le contesta ACK al bench: un frame que no entra no es uno
+	}
+	return leidos == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) ? -1 : 0;
+}
+
+/**
+ * @brief v2: mantiene la ventana de cada conexion llena y mide envio -> ACK de cada frame
+ */
+static void medir_confirmaciones(t_hilo_bench* hilo)
+{
+	while(!termino()) {
+		int esperando = 0;
+		for(int i = 0; i < hilo->cantidad; i++) {
+			t_conexion_bench* conexion = &hilo->conexiones[i];
+			if(conexion->socket != -1)
+				completar_ventana(hilo, conexion);
+			// poll() ignora los fd negativos: asi esperas[i] sigue correspondiendo a conexiones[i]
+			bool espera = conexion->socket != -1 && conexion->sin_confirmar > 0;
+			hilo->esperas[i] = (struct pollfd) { .fd = espera ? conexion->socket : -1, .events = POLLIN };
+			esperando += espera;
+		}
+		if(esperando == 0)
+			return; // se cayeron todas
+
+		if(poll(hilo->esperas, hilo->cantidad, BENCH_ESPERA_MS) <= 0)
+			continue;
+		for(int i = 0; i < hilo->cantidad; i++)
+			if(hilo->esperas[i].revents != 0 && leer_confirmaciones(hilo, &hilo->conexiones[i]) == -1)
+				caer(hilo, &hilo->conexiones[i]);
+	}
+}
+
+static void* correr_hilo(void* arg)
+{
+	t_hilo_bench* hilo = arg;
+	if(parametros.version == PROTOCOLO_VERSION_1)
+		medir_envios(hilo);
+	else
+		medir_confirmaciones(hilo);
+	return NULL;
+}
+
+void informar(t_parametros* parametros, t_hilo_bench* hilos, double segundos)
+{
+	t_histograma total;
+	histograma_iniciar(&total);
+	uint64_t mensajes = 0, paquetes = 0, bytes = 0, rechazados = 0;
+	int errores = 0;
+	for(int i = 0; i < parametros->hilos; i++) {
+		histograma_sumar(&total, &hilos[i].latencias);
+		mensajes += hilos[i].mensajes;
+		paquetes += hilos[i].paquetes;
+		bytes += hilos[i].bytes;
+		rechazados += hilos[i].rechazados;
+		errores += hilos[i].errores;
+	}
+
+	bool con_ack = parametros->version > PROTOCOLO_VERSION_1;
+	printf("conexiones: %d  hilos: %d  protocolo: v%d  duracion: %.2f s\n", parametros->conexiones, parametros->hilos, parametros->version, segundos);
+	if(con_ack)
+		printf("frames confirmados: %lu (MENSAJE %lu, PAQUETE %lu)  rechazados: %lu  ventana: %d  conexiones caidas: %d\n",
+			mensajes + paquetes, mensajes, paquetes, rechazados, parametros->ventana, errores);
+	else
+		printf("frames enviados: %lu (MENSAJE %lu, PAQUETE %lu)  conexiones caidas: %d\n", mensajes + paquetes, mensajes, paquetes, errores);
+	printf("throughput: %.0f frames/s  %.2f MB/s\n", (mensajes + paquetes) / segundos, bytes / segundos / (1024 * 1024));
+	if(total.total > 0)
+		printf("%s (us): min %.2f  p50 %.2f  p99 %.2f  p999 %.2f  max %.2f  promedio %.2f\n",
+			con_ack ? "latencia envio -> ACK" : "latencia de envio (sin ACK en v1)",
+			total.minimo / 1000.0,
+			histograma_percentil(&total, 50) / 1000.0,
+			histograma_percentil(&total, 99) / 1000.0,
+			histograma_percentil(&total, 99.9) / 1000.0,
+			total.maximo / 1000.0,
+			(double) total.suma / total.total / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+	if(leer_parametros(argc, argv, &parametros) == -1) {
+		uso(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	frame_mensaje = armar_mensaje(parametros.version, parametros.tamanio_mensaje, parametros.umbral_compresion);
+	frame_paquete = armar_paquete(parametros.version, parametros.elementos_paquete, parametros.tamanio_elemento, parametros.umbral_compresion);
+
+	// Se reparten las conexiones entre los hilos (los primeros se llevan el resto)
+	t_hilo_bench* hilos = calloc(parametros.hilos, sizeof(t_hilo_bench));
+	for(int i = 0; i < parametros.hilos; i++) {
+		hilos[i].cantidad = parametros.conexiones / parametros.hilos + (i < parametros.conexiones % parametros.hilos);
+		hilos[i].conexiones = calloc(hilos[i].cantidad, sizeof(t_conexion_bench));
+		hilos[i].esperas = malloc(hilos[i].cantidad * sizeof(struct pollfd));
+		hilos[i].semilla = i + 1;
+		histograma_iniciar(&hilos[i].latencias);
+		for(int j = 0; j < hilos[i].cantidad; j++) {
+			t_conexion_bench* conexion = &hilos[i].conexiones[j];
+			conexion->enviados = calloc(parametros.ventana, sizeof(t_enviado));
+			conexion->socket = conectar(parametros.ip, parametros.puerto, parametros.version, parametros.umbral_compresion > 0);
+			if(conexion->socket == -1) {
+				fprintf(stderr, "No se pudo conectar a %s:%s\n", parametros.ip, parametros.puerto);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &fin_medicion);
+	uint64_t inicio = ahora_ns();
+	fin_medicion.tv_sec += parametros.duracion;
+	for(int i = 0; i < parametros.hilos; i++)
+		pthread_create(&hilos[i].hilo, NULL, correr_hilo, &hilos[i]);
+	for(int i = 0; i < parametros.hilos; i++)
+		pthread_join(hilos[i].hilo, NULL);
+	double segundos = (ahora_ns() - inicio) / 1e9;
+
+	informar(&parametros, hilos, segundos);
+
+	for(int i = 0; i < parametros.hilos; i++) {
+		for(int j = 0; j < hilos[i].cantidad; j++) {
+			if(hilos[i].conexiones[j].socket != -1)
+				close(hilos[i].conexiones[j].socket);
+			free(hilos[i].conexiones[j].enviados);
+		}
+		free(hilos[i].conexiones);
+		free(hilos[i].esperas);
+	}
+	free(hilos);
+	free(frame_mensaje.datos);
+	free(frame_paquete.datos);
+	return EXIT_SUCCESS;
+}
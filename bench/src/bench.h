@@ -0,0 +1,161 @@
+/**
+ * @file bench.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del generador de carga del servidor
+ *
+ * Abre varias conexiones concurrentes contra el servidor, envia una mezcla configurable de
+ * MENSAJE y PAQUETE durante un tiempo fijo e informa frames/s, bytes/s y percentiles de latencia.
+ * En v2 se negocia PROTOCOLO_CAPACIDAD_IDS: cada frame lleva un id y la latencia es la ida y vuelta desde que se
+ * empieza a enviar hasta que llega su ACK (con persistencia, cuando ya es durable). Cada conexion mantiene hasta
+ * -w frames sin confirmar. En v1 no hay ids ni ACK: solo se mide el envio (hasta que el kernel acepta el frame).
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+// Librerias standard de C
+#include<stdio.h> // printf, fprintf
+#include<stdlib.h> // malloc, free, atoi
+#include<string.h> // memset, memcpy
+#include<stdbool.h> // bool
+#include<stdint.h> // uint64_t
+#include<time.h> // clock_gettime
+#include<errno.h> // errno
+
+// Librerias standard de POSIX/Linux
+#include<unistd.h> // getopt, close, sysconf
+#include<pthread.h> // un hilo por grupo de conexiones
+#include<sys/socket.h> // send, sendmsg, recv, setsockopt
+#include<sys/uio.h> // iovec
+#include<poll.h> // poll (esperar los ACK de varias conexiones)
+#include<netinet/in.h> // IPPROTO_TCP
+#include<netinet/tcp.h> // TCP_NODELAY
+
+// Protocolo compartido con el cliente y el servidor (op_code, encabezados, handshake, compresion)
+#include<protocolo.h>
+#include<compresion.h>
+
+// Histograma de latencias
+#include "histograma.h"
+
+/* Bytes de confirmaciones a medio leer por conexion (un ACK ocupa menos de 16) */
+#define BENCH_ENTRADA 4096
+/* Espera maxima de poll() por los ACK, para no pasarse de la duracion */
+#define BENCH_ESPERA_MS 100
+
+/**
+ * @brief Parametros del bench (ver uso() en bench.c)
+ */
+typedef struct
+{
+	char* ip; /**< IP del servidor */
+	char* puerto; /**< puerto del servidor */
+	int conexiones; /**< cantidad de conexiones concurrentes (M) */
+	int hilos; /**< hilos que reparten las conexiones entre si */
+	int duracion; /**< segundos de medicion */
+	int porcentaje_mensajes; /**< % de frames que son MENSAJE (el resto son PAQUETE) */
+	int tamanio_mensaje; /**< bytes del string de cada MENSAJE (con el '\0') */
+	int elementos_paquete; /**< elementos de cada PAQUETE */
+	int tamanio_elemento; /**< bytes de cada elemento del PAQUETE */
+	int version; /**< version de protocolo (1 = sin handshake, como un cliente viejo) */
+	int umbral_compresion; /**< payloads de este tamanio o mas van comprimidos (0 = sin compresion, solo v2) */
+	int ventana; /**< frames enviados sin confirmar por conexion (solo v2) */
+} t_parametros;
+
+/**
+ * @brief Un frame ya serializado, listo para enviar tantas veces como haga falta
+ */
+typedef struct
+{
+	void* datos; /**< | encabezado | payload |, en la version de protocolo elegida y sin id */
+	int tamanio; /**< bytes totales del frame (sin id) */
+	int encabezado; /**< bytes del encabezado en datos: el payload empieza despues */
+	int cod_op; /**< MENSAJE o PAQUETE, para volver a armar el encabezado con id */
+	uint8_t flags; /**< flags del encabezado (ej. PROTOCOLO_FLAG_COMPRIMIDO) */
+} t_frame;
+
+/**
+ * @brief Frame enviado con id que espera su ACK
+ */
+typedef struct
+{
+	t_frame* frame; /**< frame enviado (NULL = lugar libre) */
+	uint32_t id; /**< id con el que se envio */
+	int tamanio; /**< bytes en el cable, con el id */
+	uint64_t inicio; /**< cuando se empezo a enviar, en ns */
+} t_enviado;
+
+/**
+ * @brief Una conexion del bench y sus frames sin confirmar
+ */
+typedef struct
+{
+	int socket; /**< -1 si la conexion se cayo */
+	uint32_t proximo_id; /**< id del proximo frame */
+	int sin_confirmar; /**< frames enviados que todavia no tienen ACK */
+	t_enviado* enviados; /**< ventana de frames sin confirmar, indexada por id % ventana */
+	uint8_t entrada[BENCH_ENTRADA]; /**< lo recibido que todavia no forma un frame completo */
+	int recibidos; /**< bytes validos en entrada */
+} t_conexion_bench;
+
+/**
+ * @brief Estado y resultados de cada hilo del bench
+ */
+typedef struct
+{
+	pthread_t hilo;
+	t_conexion_bench* conexiones; /**< conexiones que atiende este hilo */
+	int cantidad; /**< cantidad de conexiones */
+	struct pollfd* esperas; /**< para poll() sobre las conexiones con frames sin confirmar */
+	unsigned semilla; /**< para elegir MENSAJE o PAQUETE (rand_r) */
+	t_histograma latencias; /**< envio -> ACK de cada frame (en v1, solo el envio), en ns */
+	uint64_t mensajes; /**< MENSAJE confirmados (en v1, enviados) */
+	uint64_t paquetes; /**< PAQUETE confirmados (en v1, enviados) */
+	uint64_t bytes; /**< bytes de los frames confirmados (en v1, enviados) */
+	uint64_t rechazados; /**< frames confirmados con PROTOCOLO_ACK_ERROR */
+	int errores; /**< conexiones que fallaron durante la medicion */
+} t_hilo_bench;
+
+/**
+ * @brief Lee los parametros de la linea de comandos
+ * @return 0 si son validos, -1 si hay que mostrar el uso
+ */
+int leer_parametros(int argc, char** argv, t_parametros* parametros);
+
+/**
+ * @brief Abre una conexion TCP con el servidor y, si @p version es mayor a 1, hace el handshake pidiendo PROTOCOLO_CAPACIDAD_IDS
+ * @param comprimir si se pide tambien PROTOCOLO_CAPACIDAD_COMPRESION
+ * @return fd del socket conectado, o -1 si fallo la conexion o el servidor no acepto la version (o las capacidades)
+ */
+int conectar(char* ip, char* puerto, int version, bool comprimir);
+
+/**
+ * @brief Serializa un MENSAJE de @p tamanio bytes (contando el '\0'), comprimido si llega a @p umbral_compresion (0 = nunca)
+ */
+t_frame armar_mensaje(int version, int tamanio, int umbral_compresion);
+
+/**
+ * @brief Serializa un PAQUETE de @p elementos elementos de @p tamanio bytes cada uno, comprimido si llega a @p umbral_compresion (0 = nunca)
+ */
+t_frame armar_paquete(int version, int elementos, int tamanio, int umbral_compresion);
+
+/**
+ * @brief Envia todo el frame, reintentando envios parciales
+ * @return 0 si se envio, -1 si fallo la conexion
+ */
+int enviar_frame(int socket, t_frame* frame);
+
+/**
+ * @brief Envia el frame con @p id en el encabezado (sin copiar el payload)
+ * @return bytes enviados, o -1 si fallo la conexion
+ * @pre version >= PROTOCOLO_VERSION_2 y PROTOCOLO_CAPACIDAD_IDS acordada en el handshake
+ */
+int enviar_frame_id(int socket, int version, t_frame* frame, uint32_t id);
+
+/**
+ * @brief Imprime los resultados sumados de todos los hilos
+ */
+void informar(t_parametros* parametros, t_hilo_bench* hilos, double segundos);
+
+#endif /* BENCH_H_ */
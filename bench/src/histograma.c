@@ -0,0 +1,82 @@
+/**
+ * @file histograma.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del histograma de latencias del bench
+ *
+ * Para v >= 64 el bucket se arma con el exponente (posicion del bit mas alto) y los 5 bits siguientes (mantisa).
+ * @see http://hdrhistogram.org/
+ */
+
+#include "histograma.h"
+
+void histograma_iniciar(t_histograma* histograma)
+{
+	memset(histograma, 0, sizeof(t_histograma));
+	histograma->minimo = UINT64_MAX;
+}
+
+static int indice_de(uint64_t valor)
+{
+	if(valor < HISTOGRAMA_LINEAL)
+		return valor;
+	int exponente = 63 - __builtin_clzll(valor); // >= 6
+	int mantisa = (valor >> (exponente - 5)) & (HISTOGRAMA_SUBBUCKETS - 1);
+	return HISTOGRAMA_LINEAL + (exponente - 6) * HISTOGRAMA_SUBBUCKETS + mantisa;
+}
+
+/**
+ * @brief Mayor valor que cae en el bucket @p indice
+ */
+static uint64_t limite_superior(int indice)
+{
+	if(indice < HISTOGRAMA_LINEAL)
+		return indice;
+	int exponente = (indice - HISTOGRAMA_LINEAL) / HISTOGRAMA_SUBBUCKETS + 6;
+	uint64_t mantisa = (indice - HISTOGRAMA_LINEAL) % HISTOGRAMA_SUBBUCKETS;
+	uint64_t ancho = 1ULL << (exponente - 5);
+	return ((HISTOGRAMA_SUBBUCKETS + mantisa) << (exponente - 5)) + ancho - 1;
+}
+
+void histograma_registrar(t_histograma* histograma, uint64_t valor)
+{
+	histograma->cuentas[indice_de(valor)]++;
+	histograma->total++;
+	histograma->suma += valor;
+	if(valor < histograma->minimo)
+		histograma->minimo = valor;
+	if(valor > histograma->maximo)
+		histograma->maximo = valor;
+}
+
+void histograma_sumar(t_histograma* destino, const t_histograma* origen)
+{
+	for(int i = 0; i < HISTOGRAMA_BUCKETS; i++)
+		destino->cuentas[i] += origen->cuentas[i];
+	destino->total += origen->total;
+	destino->suma += origen->suma;
+	if(origen->minimo < destino->minimo)
+		destino->minimo = origen->minimo;
+	if(origen->maximo > destino->maximo)
+		destino->maximo = origen->maximo;
+}
+
+uint64_t histograma_percentil(const t_histograma* histograma, double percentil)
+{
+	if(histograma->total == 0)
+		return 0;
+
+	uint64_t objetivo = (uint64_t) (percentil / 100.0 * histograma->total + 0.5);
+	if(objetivo < 1)
+		objetivo = 1;
+
+	uint64_t acumulado = 0;
+	for(int i = 0; i < HISTOGRAMA_BUCKETS; i++) {
+		acumulado += histograma->cuentas[i];
+		if(acumulado >= objetivo) {
+			uint64_t limite = limite_superior(i);
+			return limite < histograma->maximo ? limite : histograma->maximo;
+		}
+	}
+	return histograma->maximo;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file histograma.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del histograma de latencias del bench
+ *
+ * Histograma log-lineal (al estilo HDR): los valores chicos tienen un bucket cada uno y los grandes
+ * se agrupan en 32 buckets por potencia de 2, asi el error relativo queda acotado (~3%) para cualquier
+ * magnitud con un arreglo fijo de contadores. Registrar es O(1) y no reserva memoria.
+ * @see http://hdrhistogram.org/
+ */
+
+#ifndef HISTOGRAMA_H_
+#define HISTOGRAMA_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint64_t
+#include<string.h> // memset
+
+/* Valores menores a esto van cada uno en su propio bucket */
+#define HISTOGRAMA_LINEAL 64
+/* Buckets por cada potencia de 2 a partir de HISTOGRAMA_LINEAL */
+#define HISTOGRAMA_SUBBUCKETS 32
+/* 64 lineales + 32 por cada exponente de 6 a 63 */
+#define HISTOGRAMA_BUCKETS (HISTOGRAMA_LINEAL + (64 - 6) * HISTOGRAMA_SUBBUCKETS)
+
+/**
+ * @brief Distribucion de valores (ej. latencias en nanosegundos)
+ */
+typedef struct
+{
+	uint64_t cuentas[HISTOGRAMA_BUCKETS]; /**< cantidad de valores por bucket */
+	uint64_t total; /**< cantidad de valores registrados */
+	uint64_t minimo; /**< menor valor registrado */
+	uint64_t maximo; /**< mayor valor registrado */
+	uint64_t suma; /**< suma de los valores (para el promedio) */
+} t_histograma;
+
+/**
+ * @brief Deja el histograma vacio
+ */
+void histograma_iniciar(t_histograma* histograma);
+
+/**
+ * @brief Registra un valor
+ */
+void histograma_registrar(t_histograma* histograma, uint64_t valor);
+
+/**
+ * @brief Acumula @p origen en @p destino (para juntar los histogramas de cada hilo)
+ */
+void histograma_sumar(t_histograma* destino, const t_histograma* origen);
+
+/**
+ * @brief Devuelve el valor por debajo del cual queda el @p percentil % de los registros
+ * @param histograma histograma con al menos un valor
+ * @param percentil entre 0 y 100 (ej. 99.9)
+ * @return limite superior del bucket que contiene al percentil (0 si esta vacio)
+ */
+uint64_t histograma_percentil(const t_histograma* histograma, double percentil);
+
+#endif /* HISTOGRAMA_H_ */
@@ -1,6 +1,10 @@
 # Libraries
-LIBS=commons pthread readline m
+LIBS=protocolo commons pthread readline m z
+
+# Custom libraries' paths
+SHARED_LIBPATHS=
+STATIC_LIBPATHS=../protocolo
 
 # Compiler flags
-CDEBUG=-g -Wall -DDEBUG -fdiagnostics-color=always
+CDEBUG=-g -Wall -DDEBUG -DTRAZAS -fdiagnostics-color=always
 CRELEASE=-O3 -Wall -DNDEBUG
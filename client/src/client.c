@@ -12,11 +12,13 @@
 
 #include "client.h"
 
+static int config_int_o_defecto(t_config* config, char* clave, int por_defecto);
+
 int main(void)
 {
 	/*---------------------------------------------------PARTE 2-------------------------------------------------------------*/
 
-	int conexion;
+	t_conexion_pool* conexion;
 	char* ip;
 	char* puerto;
 	char* valor;
@@ -63,6 +65,12 @@ int main(void)
 
 	log_info(logger, "VALOR leido de la config: %s", valor);
 
+#ifdef TRAZAS
+	// TRAZA_ARCHIVO: si esta, cada etapa del envio se mide y se vuelca en ese archivo al terminar (ver traza.h)
+	if(config_has_property(config, "TRAZA_ARCHIVO") && !traza_iniciar(config_get_string_value(config, "TRAZA_ARCHIVO"), 0))
+		log_warning(logger, "No se pudieron activar las trazas");
+#endif
+
 
 	/* ---------------- LEER DE CONSOLA ---------------- */
 
@@ -72,16 +80,45 @@ int main(void)
 
 	// ADVERTENCIA: Antes de continuar, tenemos que asegurarnos que el servidor esté corriendo para poder conectarnos a él
 
-	// Creamos una conexión hacia el servidor
-	conexion = crear_conexion(ip, puerto);
+	// Tomamos una conexión hacia el servidor del pool: la primera vez resuelve, conecta y negocia
+	// la version del protocolo (PROTOCOLO=1 en la config: servidor viejo, sin handshake) y, si la config
+	// lo pide (COMPRESION_UMBRAL > 0), la compresion de los frames grandes. Ver pool_conexiones.h
+	iniciar_pool_conexiones(config);
+	conexion = pool_conexiones_tomar(ip, puerto);
+	if(conexion == NULL) {
+		log_error(logger, "No se pudo conectar con el servidor %s:%s", ip, puerto);
+		terminar_programa(logger, config);
+		return EXIT_FAILURE;
+	}
+	log_info(logger, "Protocolo v%d", conexion->version);
+
+	// Los envios se agrupan en lotes (ver emisor.h)
+	t_emisor* emisor = iniciar_emisor(conexion->socket, conexion->version, config);
+	if(conexion->capacidades & PROTOCOLO_CAPACIDAD_COMPRESION) {
+		int umbral = config_int_o_defecto(config, "COMPRESION_UMBRAL", 0);
+		int nivel = config_int_o_defecto(config, "COMPRESION_NIVEL", COMPRESION_NIVEL_DEFECTO);
+		if(emisor_activar_compresion(emisor, umbral, nivel) == 0)
+			log_info(logger, "Compresion activa para payloads de %d bytes o mas", umbral);
+	}
+	// Con control de flujo el emisor espera el credito del servidor en lugar de llenarle los buffers
+	if(conexion->capacidades & PROTOCOLO_CAPACIDAD_CREDITOS)
+		emisor_activar_creditos(emisor, &conexion->credito);
 
 	// Enviamos al servidor el valor de CLAVE como mensaje
-	enviar_mensaje(valor, conexion);
+	if(emisor_enviar_mensaje(emisor, valor) == -1)
+		log_error(logger, "No se pudo enviar el mensaje al servidor");
 
 	// Armamos y enviamos el paquete
-	paquete(conexion);
+	paquete(emisor);
 
-	terminar_programa(conexion, logger, config);
+	// Guardamos CLAVE=valor en el servidor (PUT) y lo consultamos de vuelta (ver almacen.h del servidor)
+	bool sana = guardar_y_consultar(conexion, emisor, valor, config, logger);
+
+	// Devuelve la conexion al pool (si no hubo errores queda para reutilizar)
+	emisor_destruir(emisor);
+	pool_conexiones_devolver(conexion, sana);
+
+	terminar_programa(logger, config);
 
 	/*---------------------------------------------------PARTE 5-------------------------------------------------------------*/
 	// Proximamente
@@ -136,7 +173,7 @@ void leer_consola(t_log* logger)
 	free(leido);
 }
 
-void paquete(int conexion)
+void paquete(t_emisor* emisor)
 {
 	// Ahora toca lo divertido!
 	char* leido = NULL;
@@ -156,19 +193,138 @@ void paquete(int conexion)
 	// ¡No te olvides de liberar las líneas y el paquete antes de regresar!
 	free(leido);
 
-	// Enviar Paquete
-	enviar_paquete(paquete, conexion);
+	// Enviar Paquete (se copia al lote del emisor, asi que se puede eliminar enseguida)
+	emisor_enviar_paquete(emisor, paquete);
 
 	// Eliminar paquete
 	eliminar_paquete(paquete);
 }
 
-void terminar_programa(int conexion, t_log* logger, t_config* config)
+/**
+ * @brief Lee una clave numerica de la config, o devuelve @p por_defecto si no esta
+ */
+static int config_int_o_defecto(t_config* config, char* clave, int por_defecto)
+{
+	return config_has_property(config, clave) ? config_get_int_value(config, clave) : por_defecto;
+}
+
+/**
+ * @brief Loggea lo que contesto el servidor a un GET de CLAVE
+ * @param encontrada 1 si la tiene, 0 si no, -1 si fallo la consulta
+ */
+static void informar_clave(t_log* logger, int encontrada, const char* guardado)
+{
+	if(encontrada == 1)
+		log_info(logger, "El servidor tiene CLAVE=%s", guardado);
+	else if(encontrada == 0)
+		log_info(logger, "El servidor no tiene CLAVE");
+	else
+		log_error(logger, "No se pudo consultar CLAVE al servidor");
+}
+
+bool guardar_y_consultar(t_conexion_pool* conexion, t_emisor* emisor, char* valor, t_config* config, t_log* logger)
+{
+	// Lo encolado en el emisor (mensaje y paquete) sale antes: el servidor procesa cada conexion en orden
+	if(emisor_flush(emisor) == -1)
+		return false;
+
+	if(conexion->capacidades & PROTOCOLO_CAPACIDAD_IDS) {
+		// PUT, GET y EXISTS salen juntos y despues se espera cada contestacion por su id
+		t_pipeline* pipeline = pipeline_crear(conexion->socket, conexion->version,
+			config_int_o_defecto(config, "PIPELINE_VENTANA", PIPELINE_VENTANA_DEFECTO), &conexion->credito);
+		uint32_t id_put, id_get, id_exists;
+		t_respuesta respuesta;
+		bool sana = pipeline_put(pipeline, "CLAVE", valor, &id_put) == 0
+			&& pipeline_enviar(pipeline, GET, "CLAVE", strlen("CLAVE"), &id_get) == 0
+			&& pipeline_enviar(pipeline, EXISTS, valor, strlen(valor), &id_exists) == 0;
+
+		if(sana && pipeline_esperar(pipeline, id_put, &respuesta) == 0) {
+			if(respuesta.cod_op != ACK || respuesta.estado != PROTOCOLO_ACK_OK)
+				log_error(logger, "El servidor rechazo el PUT de CLAVE");
+		} else
+			sana = false;
+		if(sana && pipeline_esperar(pipeline, id_get, &respuesta) == 0)
+			informar_clave(logger, respuesta.estado == PROTOCOLO_ENCONTRADO, respuesta.valor != NULL ? respuesta.valor : "");
+		else {
+			informar_clave(logger, -1, NULL);
+			sana = false;
+		}
+		if(sana && pipeline_esperar(pipeline, id_exists, &respuesta) == 0) {
+			if(respuesta.estado == PROTOCOLO_ENCONTRADO)
+				log_info(logger, "El servidor recibio el mensaje '%s'", valor);
+		} else
+			sana = false;
+		pipeline_destruir(pipeline);
+		return sana;
+	}
+
+	// Servidor sin ids: el PUT va por el emisor y cada consulta espera su respuesta
+	t_paquete* put = crear_paquete();
+	put->codigo_operacion = PUT;
+	agregar_a_paquete(put, "CLAVE", strlen("CLAVE") + 1);
+	agregar_a_paquete(put, valor, strlen(valor) + 1);
+	emisor_enviar_paquete(emisor, put);
+	eliminar_paquete(put);
+	if(emisor_flush(emisor) == -1)
+		return false;
+
+	char* guardado = NULL;
+	int encontrada = consultar(conexion->socket, conexion->version, &conexion->credito, GET, "CLAVE", &guardado);
+	informar_clave(logger, encontrada, guardado);
+	free(guardado);
+	if(encontrada == -1)
+		return false;
+	encontrada = consultar(conexion->socket, conexion->version, &conexion->credito, EXISTS, valor, NULL);
+	if(encontrada == 1)
+		log_info(logger, "El servidor recibio el mensaje '%s'", valor);
+	return encontrada != -1;
+}
+
+void iniciar_pool_conexiones(t_config* config)
+{
+	t_config_pool config_pool = pool_conexiones_config_defecto();
+	config_pool.version = config_int_o_defecto(config, "PROTOCOLO", PROTOCOLO_VERSION_MAXIMA);
+	config_pool.capacidades = config_int_o_defecto(config, "COMPRESION_UMBRAL", 0) > 0 ? PROTOCOLO_CAPACIDAD_COMPRESION : 0;
+	config_pool.capacidades |= PROTOCOLO_CAPACIDAD_IDS; // las solicitudes con id se confirman; las demas siguen igual
+	if(config_int_o_defecto(config, "CONTROL_FLUJO", 1))
+		config_pool.capacidades |= PROTOCOLO_CAPACIDAD_CREDITOS;
+	config_pool.libres_por_destino = config_int_o_defecto(config, "POOL_LIBRES", config_pool.libres_por_destino);
+	config_pool.inactividad_maxima_s = config_int_o_defecto(config, "POOL_INACTIVIDAD_S", config_pool.inactividad_maxima_s);
+	config_pool.dns_ttl_s = config_int_o_defecto(config, "POOL_DNS_TTL_S", config_pool.dns_ttl_s);
+	config_pool.reintentos = config_int_o_defecto(config, "POOL_REINTENTOS", config_pool.reintentos);
+	config_pool.timeout_ms = config_int_o_defecto(config, "CONEXION_TIMEOUT_MS", config_pool.timeout_ms);
+	config_pool.backoff_inicial_ms = config_int_o_defecto(config, "POOL_BACKOFF_MS", config_pool.backoff_inicial_ms);
+	config_pool.backoff_maximo_ms = config_int_o_defecto(config, "POOL_BACKOFF_MAXIMO_MS", config_pool.backoff_maximo_ms);
+	pool_conexiones_configurar(config_pool);
+}
+
+t_emisor* iniciar_emisor(int conexion, int version, t_config* config)
+{
+	// BATCH_BYTES: tamanio del lote; BATCH_DEMORA_MS: espera maxima de un frame (0 = sin lotes)
+	int umbral = config_int_o_defecto(config, "BATCH_BYTES", 16384);
+	int demora_ms = config_int_o_defecto(config, "BATCH_DEMORA_MS", 5);
+	bool nodelay = config_int_o_defecto(config, "TCP_NODELAY", 1);
+	bool cork = config_int_o_defecto(config, "TCP_CORK", 0);
+	return emisor_crear(conexion, version, umbral, demora_ms, nodelay, cork);
+}
+
+void terminar_programa(t_log* logger, t_config* config)
 {
 	/* Y por ultimo, hay que liberar lo que utilizamos (conexion, log y config) 
 	  con las funciones de las commons y del TP mencionadas en el enunciado */
 
+#ifdef TRAZAS
+	  // El emisor ya termino: lo que queda en los anillos es todo lo que se midio
+	  if(traza_activa) {
+		  int eventos = traza_volcar();
+		  if(eventos == -1)
+			  log_warning(logger, "No se pudieron volcar las trazas");
+		  else
+			  log_info(logger, "%d eventos de traza volcados en %s", eventos, config_get_string_value(config, "TRAZA_ARCHIVO"));
+	  }
+#endif
 	  log_destroy(logger); // Cierra el logger
 	  config_destroy(config); // Cierra el .config
-	  liberar_conexion(conexion);
+	  pool_conexiones_vaciar(); // Cierra las conexiones que quedaron libres en el pool
+	  pool_vaciar(); // Libera los paquetes que quedaron guardados para reutilizar
 }
@@ -32,6 +32,10 @@
 
 // Inclusión del archivo de utilidades
 #include "utils.h"
+#include "pool_paquetes.h" // paquetes reutilizables entre envios
+#include "emisor.h" // envio por lotes
+#include "pool_conexiones.h" // conexiones reutilizables entre envios
+#include "pipeline.h" // solicitudes con id y contestacion del servidor
 
 /**
  * @brief Crea un archivo logger, listo para utilizar
@@ -54,18 +58,45 @@ t_config* iniciar_config(void);
 void leer_consola(t_log*);
 
 /**
- * @brief 
- * @param 
+ * @brief Lee lineas de la consola, las agrega a un paquete y lo envia
+ * @param emisor emisor por lotes de la conexion con el servidor
  */
-void paquete(int);
+void paquete(t_emisor*);
+
+/**
+ * @brief Configura el pool de conexiones con los valores de la config
+ * @param config config con PROTOCOLO, COMPRESION_UMBRAL, CONTROL_FLUJO, CONEXION_TIMEOUT_MS y POOL_* (si falta alguna se usa su valor por defecto)
+ */
+void iniciar_pool_conexiones(t_config* config);
+
+/**
+ * @brief Crea el emisor por lotes de la conexion con los valores de la config
+ * @param conexion fd del socket conectado
+ * @param version version de protocolo negociada
+ * @param config config con BATCH_BYTES, BATCH_DEMORA_MS, TCP_NODELAY y TCP_CORK (si falta alguna se usa su valor por defecto)
+ * @return emisor listo para usar
+ */
+t_emisor* iniciar_emisor(int conexion, int version, t_config* config);
+
+/**
+ * @brief Guarda CLAVE=valor en el servidor (PUT), lo consulta de vuelta (GET y EXISTS) y loggea lo que contesta
+ * @param conexion conexion del pool: si acordo PROTOCOLO_CAPACIDAD_IDS todo sale en un solo lote (ver pipeline.h),
+ * si no, el PUT va por el emisor y cada consulta espera su respuesta
+ * @param emisor emisor de la conexion (se vacia antes de usar el socket directamente)
+ * @param valor valor de CLAVE en la config
+ * @param config config con PIPELINE_VENTANA (si falta se usa PIPELINE_VENTANA_DEFECTO)
+ * @param logger donde loggear lo que contesta el servidor
+ * @return true si la conexion sigue sana, false si fallo algun envio o respuesta
+ */
+bool guardar_y_consultar(t_conexion_pool* conexion, t_emisor* emisor, char* valor, t_config* config, t_log* logger);
 
 /**
  * @brief Cierra y libera to las estructuras de memoria utilizadas
- * @param conexion (int) fd del socket de conexion
  * @param logger uilizado para logger mensajes
  * @param onfig archivo de configs
+ * @note Las conexiones se cierran al vaciar el pool: hay que devolverlas antes con pool_conexiones_devolver()
  */
-void terminar_programa(int, t_log*, t_config*);
+void terminar_programa(t_log*, t_config*);
 
 // Cierra las guards de inclusión
 #endif /* CLIENT_H_ */
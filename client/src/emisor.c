@@ -0,0 +1,253 @@
+/**
+ * @file emisor.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del emisor por lotes del cliente
+ *
+ * Los frames se serializan directamente en el buffer del emisor, con el encabezado de la version negociada (ver protocolo.h).
+ * Un frame que no entra en el buffer se envia aparte con enviar_iovecs(), despues del lote pendiente.
+ * Con compresion activa, los payloads grandes se comprimen antes de encolarlos (el lote lleva el payload ya comprimido).
+ */
+
+#include "emisor.h"
+
+static void* enviar_vencidos(void* arg);
+
+t_emisor* emisor_crear(int socket, int version, int umbral, int demora_ms, bool nodelay, bool usar_cork)
+{
+	t_emisor* emisor = malloc(sizeof(t_emisor));
+	emisor->socket = socket;
+	emisor->version = version;
+	emisor->conversion = NULL;
+	emisor->capacidad_conversion = 0;
+	emisor->compresor = NULL;
+	emisor->umbral_compresion = 0;
+	emisor->credito = NULL;
+	emisor->umbral = umbral > 0 ? umbral : 1;
+	emisor->buffer = malloc(emisor->umbral);
+	emisor->size = 0;
+	emisor->demora_ms = demora_ms;
+	emisor->usar_cork = usar_cork;
+	emisor->activo = true;
+	emisor->error = 0;
+	pthread_mutex_init(&emisor->mutex, NULL);
+
+	// El reloj de la condicion tiene que ser el mismo que el de vencimiento (MONOTONIC no salta con la hora del sistema)
+	pthread_condattr_t atributos;
+	pthread_condattr_init(&atributos);
+	pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+	pthread_cond_init(&emisor->hay_pendientes, &atributos);
+	pthread_condattr_destroy(&atributos);
+
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &(int){nodelay}, sizeof(int));
+
+	if(emisor->demora_ms > 0)
+		pthread_create(&emisor->hilo, NULL, enviar_vencidos, emisor);
+	return emisor;
+}
+
+/**
+ * @brief Envia el lote pendiente (con el mutex tomado)
+ */
+static int enviar_lote(t_emisor* emisor)
+{
+	if(emisor->size == 0)
+		return emisor->error;
+
+	struct iovec iov = { .iov_base = emisor->buffer, .iov_len = emisor->size };
+	if(enviar_iovecs(emisor->socket, &iov, 1) == -1)
+		emisor->error = -1; // se informa ahora y en cada llamada siguiente
+	emisor->size = 0;
+	return emisor->error;
+}
+
+/**
+ * @brief Hilo que envia cada lote cuando vence su demora maxima
+ */
+static void* enviar_vencidos(void* arg)
+{
+	t_emisor* emisor = arg;
+	pthread_mutex_lock(&emisor->mutex);
+	while(emisor->activo) {
+		if(emisor->size == 0) {
+			pthread_cond_wait(&emisor->hay_pendientes, &emisor->mutex); // nada encolado: se duerme hasta el proximo frame
+			continue;
+		}
+		// Hay un lote: se espera hasta su vencimiento (o hasta que otro lo envie antes por umbral o flush)
+		if(pthread_cond_timedwait(&emisor->hay_pendientes, &emisor->mutex, &emisor->vencimiento) == ETIMEDOUT)
+			enviar_lote(emisor);
+	}
+	pthread_mutex_unlock(&emisor->mutex);
+	return NULL;
+}
+
+/**
+ * @brief Si se agoto el credito, envia el lote y espera CREDITO del servidor (con el mutex tomado)
+ * @note El servidor devuelve credito a medida que procesa: el lote pendiente tiene que salir antes de esperar
+ */
+static int esperar_credito(t_emisor* emisor)
+{
+	while(emisor->credito != NULL && *emisor->credito <= 0 && emisor->error == 0) {
+		if(enviar_lote(emisor) == -1)
+			break;
+		t_encabezado encabezado;
+		if(recibir_encabezado(emisor->socket, emisor->version, &encabezado) == -1 || encabezado.cod_op != CREDITO
+			|| recibir_credito(emisor->socket, &encabezado, emisor->credito) == -1)
+			emisor->error = -1;
+	}
+	return emisor->error;
+}
+
+/**
+ * @brief Serializa un frame en el buffer (con el mutex tomado), enviando antes lo que haga falta
+ */
+static int encolar(t_emisor* emisor, int cod_op, void* datos, int size)
+{
+	uint8_t flags = 0;
+	if(emisor->compresor != NULL && size >= emisor->umbral_compresion) {
+		void* comprimido;
+		int size_comprimido = compresor_comprimir(emisor->compresor, datos, size, &comprimido);
+		if(size_comprimido != -1) { // si no achico, sale tal cual
+			datos = comprimido;
+			size = size_comprimido;
+			flags |= PROTOCOLO_FLAG_COMPRIMIDO;
+		}
+	}
+
+	uint8_t encabezado[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int tamanio_encabezado = protocolo_codificar_encabezado(emisor->version, encabezado, cod_op, flags, size);
+	int total = tamanio_encabezado + size;
+
+	// Alcanza con que quede credito: el frame lo puede dejar en negativo
+	if(esperar_credito(emisor) == -1)
+		return -1;
+	if(emisor->credito != NULL)
+		*emisor->credito -= total;
+
+	if(emisor->size + total > emisor->umbral) {
+		if(total > emisor->umbral) {
+			// No entra ni con el buffer vacio: sale directo, despues del lote pendiente.
+			// Con TCP_CORK el final del lote y el frame grande comparten segmentos.
+			if(emisor->usar_cork)
+				setsockopt(emisor->socket, IPPROTO_TCP, TCP_CORK, &(int){1}, sizeof(int));
+			enviar_lote(emisor);
+			struct iovec iov[2] = {
+				{ .iov_base = encabezado, .iov_len = tamanio_encabezado },
+				{ .iov_base = datos, .iov_len = size }
+			};
+			if(enviar_iovecs(emisor->socket, iov, 2) == -1)
+				emisor->error = -1;
+			if(emisor->usar_cork)
+				setsockopt(emisor->socket, IPPROTO_TCP, TCP_CORK, &(int){0}, sizeof(int));
+			return emisor->error;
+		}
+		enviar_lote(emisor); // se hace lugar enviando el lote actual
+	}
+
+	if(emisor->size == 0 && emisor->demora_ms > 0) {
+		// Primer frame del lote: arranca a correr su demora maxima
+		clock_gettime(CLOCK_MONOTONIC, &emisor->vencimiento);
+		emisor->vencimiento.tv_sec += emisor->demora_ms / 1000;
+		emisor->vencimiento.tv_nsec += (emisor->demora_ms % 1000) * 1000000L;
+		if(emisor->vencimiento.tv_nsec >= 1000000000L) {
+			emisor->vencimiento.tv_sec++;
+			emisor->vencimiento.tv_nsec -= 1000000000L;
+		}
+		pthread_cond_signal(&emisor->hay_pendientes);
+	}
+
+	memcpy(emisor->buffer + emisor->size, encabezado, tamanio_encabezado);
+	memcpy(emisor->buffer + emisor->size + tamanio_encabezado, datos, size);
+	emisor->size += total;
+
+	// Se llego al umbral, o no se acumula (demora 0): se envia ya
+	if(emisor->size >= emisor->umbral || emisor->demora_ms <= 0)
+		return enviar_lote(emisor);
+	return emisor->error;
+}
+
+int emisor_activar_compresion(t_emisor* emisor, int umbral, int nivel)
+{
+	if(emisor->version < PROTOCOLO_VERSION_2)
+		return -1; // v1 no tiene flags para avisar que el payload viene comprimido
+	t_compresor* compresor = compresor_crear(nivel);
+	if(compresor == NULL)
+		return -1;
+
+	pthread_mutex_lock(&emisor->mutex);
+	if(emisor->compresor != NULL)
+		compresor_destruir(emisor->compresor);
+	emisor->compresor = compresor;
+	emisor->umbral_compresion = umbral;
+	pthread_mutex_unlock(&emisor->mutex);
+	return 0;
+}
+
+void emisor_activar_creditos(t_emisor* emisor, int64_t* credito)
+{
+	pthread_mutex_lock(&emisor->mutex);
+	emisor->credito = credito;
+	pthread_mutex_unlock(&emisor->mutex);
+}
+
+int emisor_enviar_mensaje(t_emisor* emisor, char* mensaje)
+{
+	pthread_mutex_lock(&emisor->mutex);
+	int error = encolar(emisor, MENSAJE, mensaje, strlen(mensaje) + 1); // el size incluye el \0
+	pthread_mutex_unlock(&emisor->mutex);
+	return error;
+}
+
+int emisor_enviar_paquete(t_emisor* emisor, t_paquete* paquete)
+{
+	void* stream = paquete->buffer->stream;
+	int size = paquete->buffer->size;
+
+	pthread_mutex_lock(&emisor->mutex);
+	// PUT lleva sus dos elementos (| clave | valor |) con el mismo formato que PAQUETE
+	if(emisor->version >= PROTOCOLO_VERSION_2 && (paquete->codigo_operacion == PAQUETE || paquete->codigo_operacion == PUT)) {
+		// agregar_a_paquete() arma los elementos en v1: se pasan a varint en un buffer que se reutiliza entre envios
+		int size_v2 = protocolo_tamanio_paquete_v2(stream, size);
+		if(size_v2 == -1) {
+			pthread_mutex_unlock(&emisor->mutex);
+			return -1;
+		}
+		if(size_v2 > emisor->capacidad_conversion) {
+			emisor->conversion = realloc(emisor->conversion, size_v2);
+			emisor->capacidad_conversion = size_v2;
+		}
+		size = protocolo_paquete_v1_a_v2(stream, size, emisor->conversion);
+		stream = emisor->conversion;
+	}
+	int error = encolar(emisor, paquete->codigo_operacion, stream, size);
+	pthread_mutex_unlock(&emisor->mutex);
+	return error;
+}
+
+int emisor_flush(t_emisor* emisor)
+{
+	pthread_mutex_lock(&emisor->mutex);
+	int error = enviar_lote(emisor);
+	pthread_mutex_unlock(&emisor->mutex);
+	return error;
+}
+
+void emisor_destruir(t_emisor* emisor)
+{
+	pthread_mutex_lock(&emisor->mutex);
+	enviar_lote(emisor);
+	emisor->activo = false;
+	pthread_cond_signal(&emisor->hay_pendientes);
+	pthread_mutex_unlock(&emisor->mutex);
+
+	if(emisor->demora_ms > 0)
+		pthread_join(emisor->hilo, NULL);
+
+	pthread_cond_destroy(&emisor->hay_pendientes);
+	pthread_mutex_destroy(&emisor->mutex);
+	free(emisor->buffer);
+	free(emisor->conversion);
+	if(emisor->compresor != NULL)
+		compresor_destruir(emisor->compresor);
+	free(emisor);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file emisor.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del emisor por lotes del cliente
+ *
+ * En lugar de una syscall por enviar_mensaje(), los frames se acumulan en un buffer por conexion
+ * y se envian juntos cuando: se llega a un tamanio (umbral), pasa una demora maxima desde el primer frame
+ * encolado, o se pide explicitamente con emisor_flush(). Umbral y demora regulan latencia vs. throughput.
+ * Con control de flujo (emisor_activar_creditos()) cada frame descuenta su tamanio del credito de la conexion:
+ * con el credito agotado el emisor envia lo que tenga y espera el CREDITO del servidor antes de encolar mas,
+ * en lugar de que un send() se bloquee en cualquier momento porque el servidor no da abasto.
+ */
+
+#ifndef EMISOR_H_
+#define EMISOR_H_
+
+// Librerias standard de C
+#include<stdbool.h> // bool
+#include<time.h> // clock_gettime para la demora maxima
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilo que envia los lotes vencidos
+#include<netinet/in.h> // IPPROTO_TCP
+#include<netinet/tcp.h> // TCP_NODELAY, TCP_CORK
+
+// Compresion de payloads (v2)
+#include<compresion.h>
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/**
+ * @brief Buffer de frames pendientes de envio para una conexion
+ */
+typedef struct
+{
+	int socket; /**< socket conectado al servidor */
+	int version; /**< version de protocolo negociada con handshake_cliente() (PROTOCOLO_VERSION_1 si no hubo) */
+	uint8_t* conversion; /**< buffer reutilizable para pasar los PAQUETE a v2 */
+	int capacidad_conversion; /**< bytes reservados en conversion */
+	t_compresor* compresor; /**< NULL si no se comprime (ver emisor_activar_compresion()) */
+	int umbral_compresion; /**< payloads mas chicos que esto salen sin comprimir (ej. MENSAJE cortos) */
+	int64_t* credito; /**< credito de la conexion (NULL = sin control de flujo, ver emisor_activar_creditos()) */
+	char* buffer; /**< frames serializados pendientes */
+	int size; /**< bytes pendientes en buffer */
+	int umbral; /**< al llegar a esta cantidad de bytes se envia el lote (es tambien la capacidad de buffer) */
+	int demora_ms; /**< tiempo maximo que un frame puede esperar en el buffer (0 = no se acumula) */
+	bool usar_cork; /**< TCP_CORK al enviar un lote seguido de un frame grande, para que salgan en segmentos llenos */
+	struct timespec vencimiento; /**< momento en que hay que enviar el lote actual */
+	pthread_mutex_t mutex; /**< protege el buffer (los frames se pueden encolar desde varios hilos) */
+	pthread_cond_t hay_pendientes; /**< despierta al hilo de envio cuando se encola el primer frame de un lote */
+	pthread_t hilo; /**< hilo que envia los lotes cuya demora vencio */
+	bool activo; /**< false cuando se esta destruyendo el emisor */
+	int error; /**< 0, o -1 si fallo algun envio (se informa en el proximo encolado o flush) */
+} t_emisor;
+
+/**
+ * @brief Crea un emisor para un socket ya conectado
+ * @param socket fd del socket conectado al servidor
+ * @param version version de protocolo con la que se arman los frames (la que devolvio handshake_cliente())
+ * @param umbral bytes a acumular antes de enviar (ej. 16384)
+ * @param demora_ms demora maxima de un frame en el buffer (0 = se envia cada frame apenas se encola)
+ * @param nodelay activa TCP_NODELAY: como el emisor ya agrupa, el algoritmo de Nagle solo agregaria latencia
+ * @param usar_cork usa TCP_CORK al enviar un lote seguido de un frame que no entra en el buffer
+ * @return emisor listo para encolar
+ */
+t_emisor* emisor_crear(int socket, int version, int umbral, int demora_ms, bool nodelay, bool usar_cork);
+
+/**
+ * @brief Comprime los payloads de @p umbral bytes o mas que se encolen desde ahora
+ * @param emisor emisor de una conexion v2 cuyo handshake acepto PROTOCOLO_CAPACIDAD_COMPRESION
+ * @param umbral tamanio minimo de payload a comprimir (los frames chicos no ganan nada y solo suman CPU)
+ * @param nivel nivel de deflate (1 = mas rapido ... 9 = mas chico)
+ * @return 0 si se activo, -1 si la conexion es v1 o zlib no pudo inicializarse
+ * @note Un payload que no achica al comprimirlo se envia igual, sin comprimir
+ */
+int emisor_activar_compresion(t_emisor* emisor, int umbral, int nivel);
+
+/**
+ * @brief Respeta desde ahora el credito de la conexion (PROTOCOLO_CAPACIDAD_CREDITOS)
+ * @param emisor emisor de una conexion cuyo handshake acepto PROTOCOLO_CAPACIDAD_CREDITOS
+ * @param credito credito de la conexion (ej. el de t_conexion_pool): lo que llegue por otros medios tambien se suma ahi
+ * @note Mientras espera credito el emisor es el unico que lee la conexion: no hay que tener solicitudes con id en vuelo
+ */
+void emisor_activar_creditos(t_emisor* emisor, int64_t* credito);
+
+/**
+ * @brief Encola un MENSAJE (equivalente por lotes de enviar_mensaje())
+ * @return 0 si se encolo (o envio), -1 si fallo algun envio de esta conexion
+ */
+int emisor_enviar_mensaje(t_emisor* emisor, char* mensaje);
+
+/**
+ * @brief Encola un paquete (equivalente por lotes de enviar_paquete())
+ * @return 0 si se encolo (o envio), -1 si fallo algun envio de esta conexion (o el paquete esta mal formado)
+ * @note El paquete se copia al buffer: se puede eliminar apenas retorna. En v2 sus elementos se copian con tamanios varint
+ */
+int emisor_enviar_paquete(t_emisor* emisor, t_paquete* paquete);
+
+/**
+ * @brief Envia ya todo lo pendiente
+ * @return 0 si se envio todo, -1 si fallo algun envio
+ */
+int emisor_flush(t_emisor* emisor);
+
+/**
+ * @brief Envia lo pendiente, frena el hilo de envio y libera el emisor
+ * @note No cierra el socket (eso sigue siendo liberar_conexion())
+ */
+void emisor_destruir(t_emisor* emisor);
+
+#endif /* EMISOR_H_ */
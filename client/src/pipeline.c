@@ -0,0 +1,251 @@
+/**
+ * @file pipeline.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de las solicitudes con id del cliente (pipelining)
+ *
+ * Las solicitudes se codifican directo en un buffer de salida y salen juntas en un send() (como el emisor),
+ * y las contestaciones se leen de a bloques a un buffer de entrada y se reparten por id en la ventana.
+ */
+
+#include "pipeline.h"
+
+t_pipeline* pipeline_crear(int socket, int version, int ventana, int64_t* credito)
+{
+	if(version < PROTOCOLO_VERSION_2)
+		return NULL; // el encabezado v1 no tiene lugar para el id
+	uint32_t tamanio = 1;
+	while(tamanio < (uint32_t) ventana)
+		tamanio *= 2;
+
+	t_pipeline* pipeline = calloc(1, sizeof(t_pipeline));
+	pipeline->socket = socket;
+	pipeline->credito = credito;
+	pipeline->version = version;
+	pipeline->solicitudes = calloc(tamanio, sizeof(t_solicitud));
+	pipeline->mascara = tamanio - 1;
+	pipeline->capacidad_salida = PIPELINE_LOTE;
+	pipeline->salida = malloc(pipeline->capacidad_salida);
+	pipeline->capacidad_entrada = 4096;
+	pipeline->entrada = malloc(pipeline->capacidad_entrada);
+	return pipeline;
+}
+
+/**
+ * @brief Envia todas las solicitudes encoladas
+ */
+static int enviar_salida(t_pipeline* pipeline)
+{
+	if(pipeline->error == 0 && pipeline->size_salida > 0) {
+		struct iovec iov = { .iov_base = pipeline->salida, .iov_len = pipeline->size_salida };
+		pipeline->error = enviar_iovecs(pipeline->socket, &iov, 1);
+		pipeline->size_salida = 0;
+	}
+	return pipeline->error;
+}
+
+/**
+ * @brief Guarda una contestacion en el lugar de la ventana de su solicitud
+ * @return 0 si todo bien, -1 si el id no corresponde a ninguna solicitud en vuelo
+ */
+static int guardar_contestacion(t_pipeline* pipeline, t_encabezado* encabezado, const uint8_t* payload)
+{
+	t_solicitud* solicitud = &pipeline->solicitudes[encabezado->id & pipeline->mascara];
+	if(!(encabezado->flags & PROTOCOLO_FLAG_ID) || solicitud->estado != SOLICITUD_PENDIENTE || solicitud->id != encabezado->id
+		|| (encabezado->cod_op != RESPUESTA && encabezado->cod_op != ACK) || encabezado->size < 1)
+		return -1;
+
+	if((int) encabezado->size + 1 > solicitud->capacidad) { // + 1: el valor se entrega con '\0'
+		solicitud->capacidad = encabezado->size + 1;
+		solicitud->datos = realloc(solicitud->datos, solicitud->capacidad);
+	}
+	memcpy(solicitud->datos, payload, encabezado->size);
+	solicitud->datos[encabezado->size] = '\0';
+	solicitud->size = encabezado->size;
+	solicitud->cod_op = encabezado->cod_op;
+	solicitud->estado = SOLICITUD_COMPLETA;
+	pipeline->pendientes--;
+	return 0;
+}
+
+/**
+ * @brief Envia lo encolado, espera a que lleguen bytes y guarda todas las contestaciones completas
+ * @return 0 si todo bien, -1 si fallo la conexion o llego algo invalido
+ */
+static int recibir(t_pipeline* pipeline)
+{
+	if(enviar_salida(pipeline) == -1)
+		return -1;
+
+	// Lo pendiente pasa al principio; si ya ocupa todo (una contestacion grande), se agranda
+	int pendientes = pipeline->fin_entrada - pipeline->inicio_entrada;
+	memmove(pipeline->entrada, pipeline->entrada + pipeline->inicio_entrada, pendientes);
+	pipeline->inicio_entrada = 0;
+	pipeline->fin_entrada = pendientes;
+	if(pendientes == pipeline->capacidad_entrada) {
+		pipeline->capacidad_entrada *= 2;
+		pipeline->entrada = realloc(pipeline->entrada, pipeline->capacidad_entrada);
+	}
+
+	ssize_t recibidos;
+	while((recibidos = recv(pipeline->socket, pipeline->entrada + pipeline->fin_entrada,
+		pipeline->capacidad_entrada - pipeline->fin_entrada, 0)) == -1 && errno == EINTR);
+	if(recibidos <= 0)
+		return pipeline->error = -1;
+	pipeline->fin_entrada += recibidos;
+
+	t_encabezado encabezado;
+	int estado;
+	while((estado = protocolo_decodificar_encabezado(pipeline->version, pipeline->entrada + pipeline->inicio_entrada,
+		pipeline->fin_entrada - pipeline->inicio_entrada, &encabezado)) == 1) {
+		if(encabezado.size > PROTOCOLO_FRAME_MAXIMO)
+			return pipeline->error = -1; // no se agranda la entrada a lo que diga un encabezado corrupto
+		int largo = encabezado.encabezado + encabezado.size;
+		if(pipeline->fin_entrada - pipeline->inicio_entrada < largo) {
+			if(largo > pipeline->capacidad_entrada) { // se agranda una sola vez, a lo que ocupa la contestacion
+				pipeline->capacidad_entrada = largo;
+				pipeline->entrada = realloc(pipeline->entrada, pipeline->capacidad_entrada);
+			}
+			break; // falta el resto del payload
+		}
+		const uint8_t* payload = pipeline->entrada + pipeline->inicio_entrada + encabezado.encabezado;
+		uint32_t bytes;
+		if(encabezado.cod_op == CREDITO) { // credito por lo que se envio antes con el emisor
+			if(varint_decodificar(payload, encabezado.size, &bytes) <= 0)
+				return pipeline->error = -1;
+			if(pipeline->credito != NULL)
+				*pipeline->credito += bytes;
+		}
+		else if(guardar_contestacion(pipeline, &encabezado, payload) == -1)
+			return pipeline->error = -1;
+		pipeline->inicio_entrada += largo;
+	}
+	if(estado == -1)
+		return pipeline->error = -1;
+	return 0;
+}
+
+/**
+ * @brief Reserva el lugar de la ventana para una solicitud nueva y le asigna id
+ * @return la solicitud, o NULL si fallo la conexion mientras se esperaba lugar
+ */
+static t_solicitud* tomar_lugar(t_pipeline* pipeline)
+{
+	t_solicitud* solicitud = &pipeline->solicitudes[pipeline->proximo_id & pipeline->mascara];
+	while(solicitud->estado == SOLICITUD_PENDIENTE) // ventana llena: la solicitud mas vieja sigue en vuelo
+		if(recibir(pipeline) == -1)
+			return NULL;
+	solicitud->id = pipeline->proximo_id++;
+	solicitud->estado = SOLICITUD_PENDIENTE;
+	pipeline->pendientes++;
+	return solicitud;
+}
+
+/**
+ * @brief Reserva lugar en la salida para un frame, enviando antes lo encolado si no entra
+ */
+static uint8_t* reservar_salida(t_pipeline* pipeline, int bytes)
+{
+	if(pipeline->size_salida + bytes > pipeline->capacidad_salida && enviar_salida(pipeline) == -1)
+		return NULL;
+	if(bytes > pipeline->capacidad_salida) {
+		pipeline->capacidad_salida = bytes;
+		pipeline->salida = realloc(pipeline->salida, pipeline->capacidad_salida);
+	}
+	uint8_t* destino = pipeline->salida + pipeline->size_salida;
+	pipeline->size_salida += bytes;
+	return destino;
+}
+
+/**
+ * @brief Reserva la solicitud y el lugar de su frame, y codifica el encabezado
+ * @return donde escribir el payload, o NULL si fallo la conexion
+ */
+static uint8_t* encolar(t_pipeline* pipeline, op_code cod_op, int size, uint32_t* id)
+{
+	t_solicitud* solicitud = tomar_lugar(pipeline);
+	if(solicitud == NULL)
+		return NULL;
+	uint8_t* destino = reservar_salida(pipeline, PROTOCOLO_ENCABEZADO_MAXIMO + size);
+	if(destino == NULL)
+		return NULL;
+	int encabezado = protocolo_codificar_encabezado_id(pipeline->version, destino, cod_op, 0, size, solicitud->id);
+	pipeline->size_salida -= PROTOCOLO_ENCABEZADO_MAXIMO - encabezado; // se reservo el encabezado mas largo posible
+	*id = solicitud->id;
+	return destino + encabezado;
+}
+
+int pipeline_enviar(t_pipeline* pipeline, op_code cod_op, const void* payload, int size, uint32_t* id)
+{
+	uint8_t* destino = encolar(pipeline, cod_op, size, id);
+	if(destino == NULL)
+		return -1;
+	memcpy(destino, payload, size);
+	if(pipeline->size_salida >= PIPELINE_LOTE)
+		return enviar_salida(pipeline);
+	return 0;
+}
+
+int pipeline_put(t_pipeline* pipeline, const char* clave, const char* valor, uint32_t* id)
+{
+	int largo_clave = strlen(clave);
+	int largo_valor = strlen(valor);
+	int size = varint_tamanio(largo_clave) + largo_clave + varint_tamanio(largo_valor) + largo_valor;
+	uint8_t* destino = encolar(pipeline, PUT, size, id);
+	if(destino == NULL)
+		return -1;
+	// | clave | valor | con el formato de elementos v2 de PAQUETE
+	destino += protocolo_codificar_elemento(pipeline->version, destino, largo_clave);
+	memcpy(destino, clave, largo_clave);
+	destino += largo_clave;
+	destino += protocolo_codificar_elemento(pipeline->version, destino, largo_valor);
+	memcpy(destino, valor, largo_valor);
+	if(pipeline->size_salida >= PIPELINE_LOTE)
+		return enviar_salida(pipeline);
+	return 0;
+}
+
+int pipeline_esperar(t_pipeline* pipeline, uint32_t id, t_respuesta* respuesta)
+{
+	t_solicitud* solicitud = &pipeline->solicitudes[id & pipeline->mascara];
+	if(solicitud->id != id || solicitud->estado == SOLICITUD_LIBRE)
+		return -1; // nunca se envio, o su lugar ya se reutilizo
+	while(solicitud->estado == SOLICITUD_PENDIENTE)
+		if(recibir(pipeline) == -1)
+			return -1;
+
+	respuesta->cod_op = solicitud->cod_op;
+	respuesta->estado = solicitud->datos[0];
+	respuesta->valor = solicitud->size > 1 ? (char*) solicitud->datos + 1 : NULL;
+	respuesta->largo = solicitud->size - 1;
+	solicitud->estado = SOLICITUD_LIBRE;
+	return 0;
+}
+
+int pipeline_esperar_todas(t_pipeline* pipeline)
+{
+	while(pipeline->pendientes > 0) // lo encolado cuenta como pendiente: recibir() lo envia primero
+		if(recibir(pipeline) == -1)
+			return -1;
+
+	// Los ACK ya quedan informados aca; las RESPUESTA se guardan para pipeline_esperar()
+	int errores = 0;
+	for(uint32_t i = 0; i <= pipeline->mascara; i++) {
+		t_solicitud* solicitud = &pipeline->solicitudes[i];
+		if(solicitud->estado == SOLICITUD_COMPLETA && solicitud->cod_op == ACK) {
+			errores += solicitud->datos[0] == PROTOCOLO_ACK_ERROR;
+			solicitud->estado = SOLICITUD_LIBRE;
+		}
+	}
+	return errores;
+}
+
+void pipeline_destruir(t_pipeline* pipeline)
+{
+	for(uint32_t i = 0; i <= pipeline->mascara; i++)
+		free(pipeline->solicitudes[i].datos);
+	free(pipeline->solicitudes);
+	free(pipeline->salida);
+	free(pipeline->entrada);
+	free(pipeline);
+}
@@ -0,0 +1,136 @@
+/**
+ * @file pipeline.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de las solicitudes con id del cliente (pipelining)
+ *
+ * Con PROTOCOLO_CAPACIDAD_IDS cada frame lleva un id y el servidor contesta cada uno con ese id:
+ * una RESPUESTA (GET, EXISTS) o un ACK (MENSAJE, PAQUETE, PUT). Asi el cliente sabe que el servidor proceso
+ * cada frame sin esperar un ida y vuelta por mensaje: se envian muchas solicitudes seguidas por la misma conexion
+ * y despues se espera la contestacion de cada una, que se empareja por id aunque lleguen en otro orden.
+ *
+ * Las solicitudes en vuelo ocupan un lugar de una ventana circular (posicion = id & (ventana - 1)):
+ * si se envia con la ventana llena, primero se leen contestaciones hasta liberar el lugar.
+ * No es thread-safe: cada hilo usa su propio pipeline (y su propia conexion).
+ */
+
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint32_t
+#include<stdbool.h> // bool
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Solicitudes en vuelo por defecto (potencia de 2) */
+#define PIPELINE_VENTANA_DEFECTO 64
+
+/* Bytes que se acumulan antes de enviar las solicitudes (tambien se envian al esperar una contestacion) */
+#define PIPELINE_LOTE 16384
+
+/**
+ * @brief Estado de un lugar de la ventana
+ */
+typedef enum
+{
+	SOLICITUD_LIBRE, /**< sin usar, o su contestacion ya se entrego */
+	SOLICITUD_PENDIENTE, /**< enviada (o por enviar), sin contestacion todavia */
+	SOLICITUD_COMPLETA /**< llego la contestacion y nadie la pidio todavia */
+} t_estado_solicitud;
+
+/**
+ * @brief Una solicitud en vuelo y, cuando llega, su contestacion
+ */
+typedef struct
+{
+	uint32_t id; /**< id con el que se envio */
+	t_estado_solicitud estado;
+	int cod_op; /**< de la contestacion: RESPUESTA o ACK */
+	uint8_t* datos; /**< payload de la contestacion (se reutiliza entre solicitudes) */
+	int size; /**< bytes de la contestacion */
+	int capacidad; /**< bytes reservados en datos */
+} t_solicitud;
+
+/**
+ * @brief Contestacion del servidor a una solicitud
+ */
+typedef struct
+{
+	int cod_op; /**< RESPUESTA o ACK */
+	uint8_t estado; /**< PROTOCOLO_ENCONTRADO/PROTOCOLO_NO_ENCONTRADO (RESPUESTA) o PROTOCOLO_ACK_OK/PROTOCOLO_ACK_ERROR (ACK) */
+	const char* valor; /**< valor de un GET encontrado, terminado en '\0' (NULL si no hay) */
+	int largo; /**< bytes del valor */
+} t_respuesta;
+
+/**
+ * @brief Solicitudes con id sobre una conexion
+ */
+typedef struct
+{
+	int socket; /**< socket conectado, con PROTOCOLO_CAPACIDAD_IDS acordada */
+	int64_t* credito; /**< credito de la conexion: ahi se suman los CREDITO que lleguen entre las contestaciones (puede ser NULL) */
+	int version; /**< version de protocolo negociada (v2 o mayor) */
+	uint32_t proximo_id; /**< id de la proxima solicitud */
+	t_solicitud* solicitudes; /**< ventana de solicitudes en vuelo */
+	uint32_t mascara; /**< ventana - 1 */
+	int pendientes; /**< solicitudes enviadas sin contestacion */
+	uint8_t* salida; /**< solicitudes encoladas sin enviar */
+	int size_salida; /**< bytes en salida */
+	int capacidad_salida; /**< bytes reservados en salida */
+	uint8_t* entrada; /**< bytes recibidos que todavia no formaron una contestacion completa */
+	int inicio_entrada; /**< primer byte sin procesar */
+	int fin_entrada; /**< primer byte libre */
+	int capacidad_entrada; /**< bytes reservados en entrada */
+	int error; /**< 0, o -1 si fallo la conexion o el servidor mando algo invalido (el pipeline ya no sirve) */
+} t_pipeline;
+
+/**
+ * @brief Crea un pipeline para una conexion que acordo PROTOCOLO_CAPACIDAD_IDS
+ * @param socket fd conectado (no se cierra al destruir el pipeline)
+ * @param version version de protocolo negociada
+ * @param ventana solicitudes en vuelo como maximo (se redondea a potencia de 2)
+ * @param credito credito de la conexion, si acordo PROTOCOLO_CAPACIDAD_CREDITOS (si no, NULL)
+ * @return pipeline listo para enviar, o NULL si la version no admite ids
+ * @note Las solicitudes con id no consumen credito: las regula la ventana
+ */
+t_pipeline* pipeline_crear(int socket, int version, int ventana, int64_t* credito);
+
+/**
+ * @brief Encola una solicitud con su id
+ * @param cod_op MENSAJE, PAQUETE (payload en formato v2), PUT, GET o EXISTS
+ * @param id donde guardar el id asignado (para pipeline_esperar())
+ * @return 0 si se encolo, -1 si fallo la conexion
+ * @note Si la ventana esta llena se bloquea leyendo contestaciones hasta que se libere el lugar.
+ * Las contestaciones que nadie pidio con pipeline_esperar() se descartan al reutilizar su lugar
+ */
+int pipeline_enviar(t_pipeline* pipeline, op_code cod_op, const void* payload, int size, uint32_t* id);
+
+/**
+ * @brief Encola un PUT clave -> valor (sin '\0', como los guarda el servidor)
+ * @return 0 si se encolo, -1 si fallo la conexion
+ */
+int pipeline_put(t_pipeline* pipeline, const char* clave, const char* valor, uint32_t* id);
+
+/**
+ * @brief Envia lo encolado y espera la contestacion de una solicitud
+ * @param respuesta donde guardar la contestacion: valor es valido hasta el proximo pipeline_enviar()
+ * @return 0 si llego, -1 si fallo la conexion o @p id no esta en vuelo
+ * @note Las contestaciones de otras solicitudes que lleguen antes se guardan en su lugar de la ventana
+ */
+int pipeline_esperar(t_pipeline* pipeline, uint32_t id, t_respuesta* respuesta);
+
+/**
+ * @brief Envia lo encolado y espera todas las contestaciones pendientes
+ * @return cantidad de solicitudes confirmadas con PROTOCOLO_ACK_ERROR, o -1 si fallo la conexion
+ * @note Los ACK quedan informados en el resultado; las RESPUESTA siguen disponibles para pipeline_esperar()
+ */
+int pipeline_esperar_todas(t_pipeline* pipeline);
+
+/**
+ * @brief Libera el pipeline (las contestaciones que falten se pierden)
+ */
+void pipeline_destruir(t_pipeline* pipeline);
+
+#endif /* PIPELINE_H_ */
@@ -0,0 +1,276 @@
+/**
+ * @file pool_conexiones.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del pool de conexiones del cliente
+ *
+ * Cada destino tiene una pila de sockets libres (se reutiliza primero el ultimo devuelto, que es el que
+ * menos tiempo estuvo inactivo) y una copia de su resolucion DNS. El mutex solo protege esas estructuras:
+ * getaddrinfo(), connect() y el handshake se hacen sin tomarlo, para no frenar a los otros hilos.
+ */
+
+#include "pool_conexiones.h"
+
+/**
+ * @brief Estado del pool para un (ip, puerto)
+ */
+typedef struct
+{
+	char* ip;
+	char* puerto;
+	t_direccion direcciones[CONEXION_DIRECCIONES_MAXIMO]; /**< ultima resolucion DNS */
+	int cantidad_direcciones; /**< 0 si no hay resolucion guardada (o se descarto por un fallo) */
+	struct timespec resuelto; /**< cuando se resolvio */
+	t_conexion_pool* libres[POOL_CONEXIONES_MAXIMO]; /**< sockets devueltos sanos */
+	int cantidad_libres;
+	int fallos_seguidos; /**< intentos de conexion fallidos desde el ultimo exito */
+	struct timespec proximo_intento; /**< no se reintenta conectar antes de esto (backoff) */
+} t_destino;
+
+#define CONFIG_POOL_DEFECTO { \
+	.libres_por_destino = 4, \
+	.inactividad_maxima_s = 60, \
+	.dns_ttl_s = 60, \
+	.reintentos = 3, \
+	.timeout_ms = CONEXION_TIMEOUT_DEFECTO_MS, \
+	.backoff_inicial_ms = 100, \
+	.backoff_maximo_ms = 5000, \
+	.version = PROTOCOLO_VERSION_1, \
+	.capacidades = 0 \
+}
+
+static pthread_mutex_t mutex_pool = PTHREAD_MUTEX_INITIALIZER;
+static t_list* destinos = NULL;
+static t_config_pool config_pool = CONFIG_POOL_DEFECTO;
+static unsigned semilla_backoff = 1;
+
+t_config_pool pool_conexiones_config_defecto(void)
+{
+	t_config_pool config = CONFIG_POOL_DEFECTO;
+	return config;
+}
+
+void pool_conexiones_configurar(t_config_pool config)
+{
+	if(config.libres_por_destino > POOL_CONEXIONES_MAXIMO)
+		config.libres_por_destino = POOL_CONEXIONES_MAXIMO;
+	if(config.reintentos < 1)
+		config.reintentos = 1;
+	pthread_mutex_lock(&mutex_pool);
+	config_pool = config;
+	pthread_mutex_unlock(&mutex_pool);
+}
+
+static struct timespec ahora(void)
+{
+	struct timespec tiempo;
+	clock_gettime(CLOCK_MONOTONIC, &tiempo);
+	return tiempo;
+}
+
+static long segundos_desde(struct timespec desde)
+{
+	return ahora().tv_sec - desde.tv_sec;
+}
+
+/**
+ * @brief Busca el destino (ip, puerto), creandolo si es la primera vez (con el mutex tomado)
+ */
+static t_destino* buscar_destino(char* ip, char* puerto)
+{
+	if(destinos == NULL)
+		destinos = list_create();
+	for(int i = 0; i < list_size(destinos); i++) {
+		t_destino* destino = list_get(destinos, i);
+		if(strcmp(destino->ip, ip) == 0 && strcmp(destino->puerto, puerto) == 0)
+			return destino;
+	}
+
+	t_destino* destino = calloc(1, sizeof(t_destino));
+	destino->ip = strdup(ip);
+	destino->puerto = strdup(puerto);
+	list_add(destinos, destino);
+	return destino;
+}
+
+/**
+ * @brief Verifica que un socket libre se pueda seguir usando
+ * @note Sin nada pendiente de recibir, si hay algo para leer es un cierre (0) o basura.
+ * La excepcion son los CREDITO que llegaron despues de usarla: se suman a su credito
+ */
+static bool sigue_sana(t_conexion_pool* conexion)
+{
+	if(segundos_desde(conexion->devuelta) > config_pool.inactividad_maxima_s)
+		return false; // el servidor (o un firewall en el medio) puede haberla descartado sin avisar
+
+	if(conexion->capacidades & PROTOCOLO_CAPACIDAD_CREDITOS)
+		return absorber_creditos(conexion->socket, conexion->version, &conexion->credito) == 0;
+	char byte;
+	ssize_t leidos = recv(conexion->socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+	return leidos == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+static void cerrar(t_conexion_pool* conexion)
+{
+	liberar_conexion(conexion->socket);
+	free(conexion);
+}
+
+/**
+ * @brief Registra un fallo de conexion y calcula cuando se puede reintentar (con el mutex tomado)
+ */
+static void registrar_fallo(t_destino* destino)
+{
+	destino->fallos_seguidos++;
+	destino->cantidad_direcciones = 0; // puede haber cambiado la IP: se vuelve a resolver
+
+	// Espera exponencial con tope, y al azar entre la mitad y el total para que varios clientes no reintenten juntos
+	long espera_ms = config_pool.backoff_inicial_ms;
+	for(int i = 1; i < destino->fallos_seguidos && espera_ms < config_pool.backoff_maximo_ms; i++)
+		espera_ms *= 2;
+	if(espera_ms > config_pool.backoff_maximo_ms)
+		espera_ms = config_pool.backoff_maximo_ms;
+	espera_ms = espera_ms / 2 + rand_r(&semilla_backoff) % (espera_ms / 2 + 1);
+
+	destino->proximo_intento = ahora();
+	destino->proximo_intento.tv_sec += espera_ms / 1000;
+	destino->proximo_intento.tv_nsec += (espera_ms % 1000) * 1000000L;
+	if(destino->proximo_intento.tv_nsec >= 1000000000L) {
+		destino->proximo_intento.tv_sec++;
+		destino->proximo_intento.tv_nsec -= 1000000000L;
+	}
+}
+
+/**
+ * @brief Pone (o saca, con 0) un tiempo maximo a los send()/recv() bloqueantes del socket
+ */
+static void limitar_espera(int socket_cliente, int timeout_ms)
+{
+	struct timeval limite = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000 };
+	setsockopt(socket_cliente, SOL_SOCKET, SO_RCVTIMEO, &limite, sizeof(limite));
+	setsockopt(socket_cliente, SOL_SOCKET, SO_SNDTIMEO, &limite, sizeof(limite));
+}
+
+/**
+ * @brief Conecta un socket nuevo y hace el handshake (sin el mutex tomado)
+ * @return la conexion, o NULL si fallo
+ */
+static t_conexion_pool* conectar(t_direccion* direcciones, int cantidad, t_config_pool* config)
+{
+	int socket_cliente = conectar_direcciones(direcciones, cantidad, config->timeout_ms);
+	if(socket_cliente == -1)
+		return NULL;
+
+	// Un servidor que acepta pero no contesta el handshake tampoco puede colgar el arranque
+	int acordada = PROTOCOLO_VERSION_1;
+	uint8_t capacidades = config->capacidades;
+	if(config->version > PROTOCOLO_VERSION_1) {
+		limitar_espera(socket_cliente, config->timeout_ms);
+		acordada = handshake_cliente(socket_cliente, &capacidades);
+		limitar_espera(socket_cliente, 0);
+		if(acordada == -1) {
+			liberar_conexion(socket_cliente);
+			return NULL;
+		}
+	}
+
+	t_conexion_pool* conexion = malloc(sizeof(t_conexion_pool));
+	conexion->socket = socket_cliente;
+	conexion->version = acordada;
+	conexion->capacidades = config->version > PROTOCOLO_VERSION_1 ? capacidades : 0;
+	conexion->credito = (conexion->capacidades & PROTOCOLO_CAPACIDAD_CREDITOS) ? PROTOCOLO_CREDITO_INICIAL : 0;
+	return conexion;
+}
+
+t_conexion_pool* pool_conexiones_tomar(char* ip, char* puerto)
+{
+	pthread_mutex_lock(&mutex_pool);
+	t_destino* destino = buscar_destino(ip, puerto);
+
+	// Primero se reutiliza un socket libre, descartando los que ya no sirven
+	while(destino->cantidad_libres > 0) {
+		t_conexion_pool* conexion = destino->libres[--destino->cantidad_libres];
+		if(sigue_sana(conexion)) {
+			pthread_mutex_unlock(&mutex_pool);
+			return conexion;
+		}
+		cerrar(conexion);
+	}
+
+	t_config_pool config = config_pool;
+	t_direccion direcciones[CONEXION_DIRECCIONES_MAXIMO];
+	int cantidad = 0;
+	if(destino->cantidad_direcciones > 0 && segundos_desde(destino->resuelto) < config.dns_ttl_s) {
+		cantidad = destino->cantidad_direcciones;
+		memcpy(direcciones, destino->direcciones, cantidad * sizeof(t_direccion));
+	}
+
+	for(int intento = 0; intento < config.reintentos; intento++) {
+		// Si el destino viene fallando, se espera a que termine su backoff
+		bool esperar = destino->fallos_seguidos > 0;
+		struct timespec proximo_intento = destino->proximo_intento;
+		pthread_mutex_unlock(&mutex_pool);
+		if(esperar)
+			while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &proximo_intento, NULL) == EINTR);
+
+		bool resuelto = false;
+		if(cantidad <= 0) {
+			cantidad = resolver_direcciones(ip, puerto, direcciones, CONEXION_DIRECCIONES_MAXIMO);
+			resuelto = cantidad > 0;
+		}
+		t_conexion_pool* conexion = cantidad > 0 ? conectar(direcciones, cantidad, &config) : NULL;
+
+		pthread_mutex_lock(&mutex_pool);
+		if(conexion != NULL) {
+			destino->fallos_seguidos = 0;
+			if(resuelto) { // resolucion nueva: se guarda para los proximos
+				memcpy(destino->direcciones, direcciones, cantidad * sizeof(t_direccion));
+				destino->cantidad_direcciones = cantidad;
+				destino->resuelto = ahora();
+			}
+			conexion->destino = destino;
+			pthread_mutex_unlock(&mutex_pool);
+			return conexion;
+		}
+		registrar_fallo(destino);
+		cantidad = 0;
+	}
+
+	pthread_mutex_unlock(&mutex_pool);
+	return NULL;
+}
+
+void pool_conexiones_devolver(t_conexion_pool* conexion, bool sana)
+{
+	pthread_mutex_lock(&mutex_pool);
+	t_destino* destino = conexion->destino;
+	if(sana && destino->cantidad_libres < config_pool.libres_por_destino) {
+		conexion->devuelta = ahora();
+		destino->libres[destino->cantidad_libres++] = conexion;
+		conexion = NULL;
+	}
+	pthread_mutex_unlock(&mutex_pool);
+
+	if(conexion != NULL)
+		cerrar(conexion); // con error o sin lugar en el pool
+}
+
+static void destruir_destino(void* elemento)
+{
+	t_destino* destino = elemento;
+	for(int i = 0; i < destino->cantidad_libres; i++)
+		cerrar(destino->libres[i]);
+	free(destino->ip);
+	free(destino->puerto);
+	free(destino);
+}
+
+void pool_conexiones_vaciar(void)
+{
+	pthread_mutex_lock(&mutex_pool);
+	if(destinos != NULL) {
+		list_destroy_and_destroy_elements(destinos, destruir_destino);
+		destinos = NULL;
+	}
+	pthread_mutex_unlock(&mutex_pool);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file pool_conexiones.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del pool de conexiones del cliente
+ *
+ * crear_conexion() resuelve el nombre y hace el handshake TCP (y el del protocolo) en cada llamada.
+ * El pool guarda, por cada destino (ip, puerto): la resolucion DNS (por un tiempo) y los sockets
+ * que se devolvieron sanos, para que el proximo pool_conexiones_tomar() los reutilice sin reconectar.
+ * Si conectar falla, se reintenta con espera exponencial (backoff) para no martillar a un servidor caido.
+ */
+
+#ifndef POOL_CONEXIONES_H_
+#define POOL_CONEXIONES_H_
+
+// Librerias standard de C
+#include<stdbool.h> // bool
+#include<time.h> // clock_gettime, nanosleep
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // pthread_mutex_t: el pool se puede usar desde varios hilos
+
+// Librerías de la biblioteca Commons
+#include<commons/collections/list.h> // destinos conocidos
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Sockets libres que se guardan como mucho por destino (los que sobran se cierran) */
+#define POOL_CONEXIONES_MAXIMO 64
+
+/**
+ * @brief Parametros del pool (ver pool_conexiones_configurar())
+ */
+typedef struct
+{
+	int libres_por_destino; /**< sockets libres a guardar por destino (hasta POOL_CONEXIONES_MAXIMO) */
+	int inactividad_maxima_s; /**< un socket libre por mas de esto se cierra en vez de reutilizarse */
+	int dns_ttl_s; /**< cuanto se reutiliza una resolucion de getaddrinfo() */
+	int reintentos; /**< intentos de conexion por cada pool_conexiones_tomar() */
+	int timeout_ms; /**< tiempo maximo de cada intento: connect() y handshake (0 = sin limite) */
+	int backoff_inicial_ms; /**< espera antes del primer reintento (se duplica en cada fallo) */
+	int backoff_maximo_ms; /**< tope de la espera entre reintentos */
+	int version; /**< version de protocolo a negociar en cada conexion nueva (1 = sin handshake) */
+	uint8_t capacidades; /**< PROTOCOLO_CAPACIDAD_* a pedir en el handshake */
+} t_config_pool;
+
+/**
+ * @brief Conexion tomada del pool
+ */
+typedef struct
+{
+	int socket; /**< socket conectado (y con el handshake ya hecho) */
+	int version; /**< version de protocolo acordada en el handshake */
+	uint8_t capacidades; /**< capacidades acordadas en el handshake */
+	int64_t credito; /**< bytes de frames sin id que se pueden enviar (con PROTOCOLO_CAPACIDAD_CREDITOS, ver emisor_activar_creditos()) */
+	struct timespec devuelta; /**< cuando volvio al pool por ultima vez */
+	void* destino; /**< destino al que pertenece (uso interno del pool) */
+} t_conexion_pool;
+
+/**
+ * @brief Valores por defecto: 4 libres por destino, 60 s de inactividad y de DNS, 3 intentos de 5 s, backoff 100 ms a 5 s, v1
+ */
+t_config_pool pool_conexiones_config_defecto(void);
+
+/**
+ * @brief Cambia los parametros del pool (afecta a las conexiones nuevas)
+ */
+void pool_conexiones_configurar(t_config_pool config);
+
+/**
+ * @brief Devuelve una conexion sana con (ip, puerto)
+ * @param ip IP o nombre del servidor
+ * @param puerto puerto del servidor
+ * @return una conexion reutilizada si hay alguna libre y sana, si no una nueva; NULL si no se pudo conectar
+ * despues de todos los reintentos (o si el destino sigue en backoff por fallos anteriores y se agotaron los intentos)
+ */
+t_conexion_pool* pool_conexiones_tomar(char* ip, char* puerto);
+
+/**
+ * @brief Devuelve una conexion al pool
+ * @param conexion conexion tomada con pool_conexiones_tomar()
+ * @param sana false si hubo algun error usandola (se cierra en vez de guardarse)
+ * @note Hay que devolverla sin frames a medio enviar (ej. despues de emisor_flush())
+ */
+void pool_conexiones_devolver(t_conexion_pool* conexion, bool sana);
+
+/**
+ * @brief Cierra todos los sockets libres y olvida los destinos
+ * @note Llamar al terminar el programa, despues de devolver todas las conexiones tomadas (ya no se pueden devolver)
+ */
+void pool_conexiones_vaciar(void);
+
+#endif /* POOL_CONEXIONES_H_ */
@@ -0,0 +1,82 @@
+/**
+ * @file pool_paquetes.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del pool de paquetes del cliente
+ *
+ * Dos pilas de tamanio fijo (paquetes y buffers) protegidas por un mutex.
+ * Se usan pilas para reutilizar primero lo ultimo que se libero, que es lo que mas probablemente siga en cache.
+ */
+
+#include "pool_paquetes.h"
+
+static pthread_mutex_t mutex_pool = PTHREAD_MUTEX_INITIALIZER;
+
+static t_paquete* paquetes_libres[POOL_MAXIMO];
+static int cantidad_paquetes = 0;
+
+static t_buffer* buffers_libres[POOL_MAXIMO];
+static int cantidad_buffers = 0;
+
+t_paquete* pool_tomar_paquete(void)
+{
+	t_paquete* paquete = NULL;
+	pthread_mutex_lock(&mutex_pool);
+	if(cantidad_paquetes > 0)
+		paquete = paquetes_libres[--cantidad_paquetes];
+	pthread_mutex_unlock(&mutex_pool);
+	return paquete;
+}
+
+t_buffer* pool_tomar_buffer(void)
+{
+	t_buffer* buffer = NULL;
+	pthread_mutex_lock(&mutex_pool);
+	if(cantidad_buffers > 0)
+		buffer = buffers_libres[--cantidad_buffers];
+	pthread_mutex_unlock(&mutex_pool);
+
+	if(buffer != NULL)
+		buffer->size = 0; // el contenido anterior ya no importa, la capacidad se conserva
+	return buffer;
+}
+
+bool pool_devolver_paquete(t_paquete* paquete)
+{
+	bool guardado = false;
+	pthread_mutex_lock(&mutex_pool);
+	if(cantidad_paquetes < POOL_MAXIMO) {
+		paquetes_libres[cantidad_paquetes++] = paquete;
+		guardado = true;
+	}
+	pthread_mutex_unlock(&mutex_pool);
+	return guardado;
+}
+
+bool pool_devolver_buffer(t_buffer* buffer)
+{
+	if(buffer->capacidad > POOL_CAPACIDAD_MAXIMA)
+		return false;
+
+	bool guardado = false;
+	pthread_mutex_lock(&mutex_pool);
+	if(cantidad_buffers < POOL_MAXIMO) {
+		buffers_libres[cantidad_buffers++] = buffer;
+		guardado = true;
+	}
+	pthread_mutex_unlock(&mutex_pool);
+	return guardado;
+}
+
+void pool_vaciar(void)
+{
+	pthread_mutex_lock(&mutex_pool);
+	while(cantidad_paquetes > 0)
+		free(paquetes_libres[--cantidad_paquetes]);
+	while(cantidad_buffers > 0) {
+		t_buffer* buffer = buffers_libres[--cantidad_buffers];
+		free(buffer->stream);
+		free(buffer);
+	}
+	pthread_mutex_unlock(&mutex_pool);
+}
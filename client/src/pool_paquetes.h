@@ -0,0 +1,60 @@
+/**
+ * @file pool_paquetes.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del pool de paquetes del cliente
+ *
+ * eliminar_paquete() no devuelve el paquete ni su buffer a malloc: los guarda aca (con el stream
+ * y su capacidad intactos) para que el proximo crear_paquete()/crear_buffer() los reutilice.
+ * Asi, armar y enviar paquetes en bucle deja de pasar por el allocator despues del primero.
+ */
+
+#ifndef POOL_PAQUETES_H_
+#define POOL_PAQUETES_H_
+
+// Librerias standard de C
+#include<stdbool.h> // bool
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // pthread_mutex_t: el pool se puede usar desde varios hilos
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Cantidad maxima de paquetes (y de buffers) que guarda el pool */
+#define POOL_MAXIMO 64
+
+/* Los streams con mas capacidad que esta se liberan en vez de guardarse, para no retener memoria de mas */
+#define POOL_CAPACIDAD_MAXIMA (1024 * 1024)
+
+/**
+ * @brief Saca un t_paquete del pool
+ * @return un paquete (sin buffer), o NULL si el pool esta vacio
+ */
+t_paquete* pool_tomar_paquete(void);
+
+/**
+ * @brief Saca un t_buffer del pool
+ * @return un buffer con size 0 (puede conservar stream y capacidad de un uso anterior), o NULL si el pool esta vacio
+ */
+t_buffer* pool_tomar_buffer(void);
+
+/**
+ * @brief Guarda un t_paquete (sin su buffer) en el pool
+ * @return true si se guardo, false si el pool esta lleno (quien llama lo libera)
+ */
+bool pool_devolver_paquete(t_paquete* paquete);
+
+/**
+ * @brief Guarda un t_buffer (con su stream) en el pool
+ * @return true si se guardo, false si el pool esta lleno o el stream es muy grande (quien llama lo libera)
+ */
+bool pool_devolver_buffer(t_buffer* buffer);
+
+/**
+ * @brief Libera todo lo que haya en el pool
+ * @note Llamar al terminar el programa para que valgrind no lo reporte como memoria retenida
+ */
+void pool_vaciar(void);
+
+#endif /* POOL_PAQUETES_H_ */
@@ -17,11 +17,15 @@
  */
 
 #include "utils.h"
+#include "pool_paquetes.h"
 
 void* serializar_paquete(t_paquete* paquete, int bytes)
 {
 	// Reservo un bloque de memoria del tamaño total calculado (bytes), para guardar todo el contenido serializado.
+	TRAZA_INICIO(tramo_malloc);
 	void * magic = malloc(bytes);
+	TRAZA_FIN(tramo_malloc, "serializar_paquete:malloc");
+	TRAZA_INICIO(tramo_copia);
 	// contador que indica cuántos bytes ya hemos copiado, para ir armando el bloque paso a paso.
 	int desplazamiento = 0;
 
@@ -36,11 +40,12 @@ void* serializar_paquete(t_paquete* paquete, int bytes)
 	// Copiar el contenido real
 	memcpy(magic + desplazamiento, paquete->buffer->stream, paquete->buffer->size);
 	desplazamiento+= paquete->buffer->size;
+	TRAZA_FIN(tramo_copia, "serializar_paquete:memcpy");
 
 	return magic;
 }
 
-int crear_conexion(char *ip, char* puerto)
+int resolver_direcciones(char* ip, char* puerto, t_direccion* direcciones, int maximo)
 {
 	// addrinfo es utilizada para almacenar información sobre direcciones de red y parámetros relacionados con la conexión. 
 	
@@ -51,118 +56,305 @@ int crear_conexion(char *ip, char* puerto)
 
 	// Configurar hints
 	memset(&hints, 0, sizeof(hints)); // pongo en 0 todos lo bytes de hints (memset llena un bloque de memoria con un valor específico)
-	hints.ai_family = AF_INET; // familia de direcciones = IPv4
+	hints.ai_family = AF_UNSPEC; // familia de direcciones = IPv4 o IPv6 (la que tenga el server)
 	hints.ai_socktype = SOCK_STREAM; // tipo de socket = TCP (conexión orientada)
 
 	// Resuelve la IP y el puerto en un addrinfo (server_info) para crear o conectar un socket o enlazarse (bindear) a un IP 
-	getaddrinfo(ip, puerto, &hints, &server_info); // llena server_info con hint
-	// Podria hacer:
-	// err = getaddrinfo(...) para tener un placeholder
-	// Si err == 0 -> salio todo bien y server_info contiene una lista de posibles direcciones listas para usar
-	// Si err != 0 -> algo falló (host inválido, puerto inválido, etc.)
-
-	// Ahora vamos a crear el socket.
-	// crea un socket y te devuelve un fd (un int >= 0) que se usa para operar ese socket.
-	// si algo sale mal devuelve -1
-	int socket_cliente = socket(server_info->ai_family, // dominio
-								server_info->ai_socktype, // tipo
-								server_info->ai_protocol); // protocolo
-
-	// Ahora que tenemos el socket, vamos a conectarlo
-	// connect: Le dice al socket del cliente que se conecte a una dirección de servidor.
-	// socket_cliente: socket previamente creado con socket()
-	// ai_addr: Dirección del servidor a la que querés conectarte (IP + puerto)
-	// ai_addrlen: Tamaño de la dirección.
-	connect(socket_cliente, server_info->ai_addr, server_info->ai_addrlen);
-	/* connect intenta establecer una conexión TCP con el servidor en la IP y puerto indicados.
-	- Si todo va bien, connect devuelve 0.
-	- Si falla, devuelve -1 y errno indica qué salió mal (por ejemplo, servidor no encontrado, conexión rechazada, etc).*/
-	// connect es bloqueante por defecto: el programa se queda esperando hasta que la conexión se logra o falla.
+	// Si devuelve 0 -> salio todo bien y server_info contiene una lista de posibles direcciones listas para usar
+	// Si no -> algo falló (host inválido, puerto inválido, etc.)
+	TRAZA_INICIO(tramo);
+	int error = getaddrinfo(ip, puerto, &hints, &server_info);
+	TRAZA_FIN(tramo, "resolver_direcciones:getaddrinfo");
+	if(error != 0)
+		return -1;
+
+	// Se copian las direcciones: asi se pueden guardar (ej. en el pool de conexiones) sin depender de server_info
+	int cantidad = 0;
+	for(struct addrinfo* actual = server_info; actual != NULL && cantidad < maximo; actual = actual->ai_next) {
+		direcciones[cantidad].familia = actual->ai_family;
+		direcciones[cantidad].tipo = actual->ai_socktype;
+		direcciones[cantidad].protocolo = actual->ai_protocol;
+		direcciones[cantidad].largo = actual->ai_addrlen;
+		memcpy(&direcciones[cantidad].direccion, actual->ai_addr, actual->ai_addrlen);
+		cantidad++;
+	}
 
 	// Libero la memoria reservada anteriormente por getaddrinfo
 	freeaddrinfo(server_info);
+	return cantidad;
+}
 
-	return socket_cliente; // devuelvo el socket conectado
+/**
+ * @brief Ordena las direcciones alternando familias (IPv6, IPv4, IPv6, ...) a partir de la preferida por getaddrinfo()
+ * @note Asi, si una familia entera no anda (ej. IPv6 sin ruta), el segundo intento ya es de la otra (RFC 8305)
+ */
+static void intercalar_familias(t_direccion* direcciones, int cantidad, t_direccion* ordenadas)
+{
+	int primera = direcciones[0].familia;
+	int proxima_primera = 0, proxima_otra = 0, escritas = 0;
+	bool toca_primera = true;
+
+	while(escritas < cantidad) {
+		// Se busca la proxima direccion de la familia que toca; si no quedan, de la otra
+		int* proxima = toca_primera ? &proxima_primera : &proxima_otra;
+		while(*proxima < cantidad && (direcciones[*proxima].familia == primera) != toca_primera)
+			(*proxima)++;
+		if(*proxima < cantidad)
+			ordenadas[escritas++] = direcciones[(*proxima)++];
+		toca_primera = !toca_primera;
+	}
 }
 
-/*
-int handshake_cliente(int socket_cliente)
+static long long milisegundos_ahora(void)
 {
-	size_t bytes;
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return ahora.tv_sec * 1000LL + ahora.tv_nsec / 1000000;
+}
 
-	int32_t handshake = 1; // Se define un valor fijo (1) que el cliente usará para iniciar el handshake
-	int32_t result; // int32_t: entero signado de 32 bits
+/**
+ * @brief Crea un socket no bloqueante y arranca su connect()
+ * @param conectado se pone en true si connect() termino en el momento (ej. localhost)
+ * @return fd del socket con la conexion en curso (o ya conectado), o -1 si fallo en el momento
+ */
+static int iniciar_intento(t_direccion* direccion, bool* conectado)
+{
+	int socket_cliente = socket(direccion->familia, direccion->tipo | SOCK_NONBLOCK, direccion->protocolo);
+	if(socket_cliente == -1)
+		return -1;
+
+	// connect() no bloqueante: devuelve -1 con EINPROGRESS y el resultado se sabe cuando el socket queda escribible
+	*conectado = connect(socket_cliente, (struct sockaddr*) &direccion->direccion, direccion->largo) == 0;
+	if(!*conectado && errno != EINPROGRESS) {
+		int error = errno;
+		close(socket_cliente);
+		errno = error;
+		return -1;
+	}
+	return socket_cliente;
+}
 
-	send: envia una estructura al servidor
-	socket_cliente: es el socket ya conectado al servidor.
-	&handshak: Se envía el entero handshake al servidor.
-	sizeof(int32_t): se asegura de que se envíen exactamente 4 bytes.
-	0: sin flags especiales. *
-	bytes = send(socket_cliente, &handshake, sizeof(int32_t), 0);
-	// Esto manda un mensaje inicial al servidor, como diciendo: "Quiero comunicarme".
-	
-	 recv: espera una respuesta del servidor y la guarda
-	&result: variable donde se guarda la respuesta
-	MSG_WAITALL: flag que fuerza a que se reciban exactamente esos sizeof(int32_t) bytes antes de continuar (importante para datos binarios).
-	
-	bytes = recv(socket_cliente, &result, sizeof(int32_t), MSG_WAITALL);
-	// Está esperando que el servidor responda con un código de estado.
+int conectar_direcciones(t_direccion* direcciones, int cantidad, int timeout_ms)
+{
+	if(cantidad <= 0)
+		return -1;
+	if(cantidad > CONEXION_DIRECCIONES_MAXIMO)
+		cantidad = CONEXION_DIRECCIONES_MAXIMO;
+
+	t_direccion ordenadas[CONEXION_DIRECCIONES_MAXIMO];
+	intercalar_familias(direcciones, cantidad, ordenadas);
+
+	// Un pollfd por candidato arrancado (fd -1 = fallo, poll() lo ignora)
+	struct pollfd intentos[CONEXION_DIRECCIONES_MAXIMO];
+	int arrancados = 0, en_curso = 0, ganador = -1;
+	int error = ETIMEDOUT;
+	long long limite = milisegundos_ahora() + timeout_ms;
+	long long proximo_arranque = milisegundos_ahora();
+
+	TRAZA_INICIO(tramo);
+	while(ganador == -1) {
+		long long ahora = milisegundos_ahora();
+		if(timeout_ms > 0 && ahora >= limite) {
+			error = ETIMEDOUT;
+			break;
+		}
+
+		// Se arranca el siguiente candidato si el anterior lleva CONEXION_DEMORA_INTENTO_MS sin conectar,
+		// o si ya no queda ninguno en curso (los anteriores fallaron)
+		if(arrancados < cantidad && (ahora >= proximo_arranque || en_curso == 0)) {
+			bool conectado = false;
+			int socket_cliente = iniciar_intento(&ordenadas[arrancados], &conectado);
+			intentos[arrancados].fd = socket_cliente;
+			intentos[arrancados].events = POLLOUT;
+			intentos[arrancados].revents = 0;
+			if(conectado)
+				ganador = arrancados;
+			arrancados++;
+			if(socket_cliente == -1) {
+				error = errno; // fallo en el momento (ej. familia sin soporte): se pasa al siguiente sin esperar
+				continue;
+			}
+			en_curso++;
+			proximo_arranque = ahora + CONEXION_DEMORA_INTENTO_MS;
+			continue;
+		}
+		if(en_curso == 0)
+			break; // fallaron todos
+
+		// Se espera hasta que algun intento termine, toque arrancar otro o venza el timeout
+		long long espera = -1;
+		if(arrancados < cantidad)
+			espera = proximo_arranque - ahora;
+		if(timeout_ms > 0 && (espera == -1 || limite - ahora < espera))
+			espera = limite - ahora;
+		if(poll(intentos, arrancados, espera) == -1 && errno != EINTR) {
+			error = errno;
+			break;
+		}
+
+		for(int i = 0; i < arrancados; i++) {
+			if(intentos[i].fd == -1 || intentos[i].revents == 0)
+				continue;
+			int resultado = 0;
+			socklen_t largo = sizeof(resultado);
+			if(getsockopt(intentos[i].fd, SOL_SOCKET, SO_ERROR, &resultado, &largo) == -1)
+				resultado = errno;
+			if(resultado == 0) {
+				ganador = i;
+				break;
+			}
+			// Este candidato fallo (ej. conexion rechazada): se cierra y se arranca el siguiente sin esperar
+			error = resultado;
+			close(intentos[i].fd);
+			intentos[i].fd = -1;
+			en_curso--;
+			proximo_arranque = ahora;
+		}
+	}
+
+	TRAZA_FIN(tramo, "conectar_direcciones:connect");
 
-	if (result == 0) {
-    	return 0; // Handshake OK
-	} else {
-    	return -1;// Handshake ERROR
+	// Se cierran los que perdieron la carrera
+	for(int i = 0; i < arrancados; i++)
+		if(i != ganador && intentos[i].fd != -1)
+			close(intentos[i].fd);
+	if(ganador == -1) {
+		errno = error;
+		return -1;
 	}
+
+	// El resto del cliente usa el socket en modo bloqueante
+	int socket_cliente = intentos[ganador].fd;
+	fcntl(socket_cliente, F_SETFL, fcntl(socket_cliente, F_GETFL) & ~O_NONBLOCK);
+	return socket_cliente;
 }
-*/
 
-void enviar_mensaje(char* mensaje, int socket_cliente)
+int crear_conexion(char *ip, char* puerto)
 {
-	// Se crea una estructura dinamica en memoria que representa un mensaje para enviar.
-	t_paquete* paquete = malloc(sizeof(t_paquete));
-
-	// Se setea y configura el paquete a enviar
-	paquete->codigo_operacion = MENSAJE; // tipo de paquete: MESNAJE ( indica que el contenido es un mensaje de texto)
-	paquete->buffer = malloc(sizeof(t_buffer)); // Se crea un buffer dentro del paquete (t_buffer es otra estructura que almacena el tamaño y los datos reales) 
-	paquete->buffer->size = strlen(mensaje) + 1; // Se calcula el tamaño del mensaje, incluyendo el \0 de fin de cadena
-	paquete->buffer->stream = malloc(paquete->buffer->size); // Se reserva memoria para el contenido
-	memcpy(paquete->buffer->stream, mensaje, paquete->buffer->size); // Se copia el mensaje dentro del buffer (stream) del paquete.
+	return crear_conexion_con_timeout(ip, puerto, CONEXION_TIMEOUT_DEFECTO_MS);
+}
 
-	// Se calcula el tamaño total del paquete serializado:
-	int bytes = paquete->buffer->size + 2*sizeof(int); // los bytes del msj + (1 int para buffer->size + 1 int cod_op)
+int crear_conexion_con_timeout(char* ip, char* puerto, int timeout_ms)
+{
+	t_direccion direcciones[CONEXION_DIRECCIONES_MAXIMO];
+	int cantidad = resolver_direcciones(ip, puerto, direcciones, CONEXION_DIRECCIONES_MAXIMO);
+	if(cantidad <= 0)
+		return -1;
+	return conectar_direcciones(direcciones, cantidad, timeout_ms);
+}
 
-	// Se convierte el t_paquete en una secuencia lineal de bytes (en formato raw) lista para enviarse por socket.
-	void* a_enviar = serializar_paquete(paquete, bytes);
+int handshake_cliente(int socket_cliente, uint8_t* capacidades)
+{
+	// Se ofrece la version mas nueva que se entiende; el servidor contesta con la que eligio
+	uint8_t handshake[PROTOCOLO_TAMANIO_HANDSHAKE];
+	protocolo_codificar_handshake(handshake, PROTOCOLO_VERSION_MAXIMA, *capacidades);
+	TRAZA_INICIO(tramo);
+	ssize_t enviados = send(socket_cliente, handshake, sizeof(handshake), MSG_NOSIGNAL);
+	if(enviados != sizeof(handshake))
+		return -1;
+
+	// MSG_WAITALL: la respuesta tiene tamanio fijo, se espera a tenerla entera
+	uint8_t respuesta[PROTOCOLO_TAMANIO_HANDSHAKE];
+	ssize_t recibidos = recv(socket_cliente, respuesta, sizeof(respuesta), MSG_WAITALL);
+	TRAZA_FIN(tramo, "handshake_cliente:ida y vuelta");
+	if(recibidos != sizeof(respuesta))
+		return -1;
+
+	uint8_t pedidas = *capacidades;
+	int version = protocolo_decodificar_handshake(respuesta, capacidades);
+	if(version < PROTOCOLO_VERSION_1 || version > PROTOCOLO_VERSION_MAXIMA)
+		return -1; // 0 = el servidor rechazo el handshake
+	*capacidades &= pedidas; // el servidor no puede activar algo que no se pidio
+	return version;
+}
 
-	// Se envía el bloque completo de datos al socket.
-	send(socket_cliente, a_enviar, bytes, 0); // lo que el servidor recibe y debe deserializar
+int enviar_iovecs(int socket_cliente, struct iovec* iov, int cantidad)
+{
+	struct msghdr mensaje;
+	memset(&mensaje, 0, sizeof(mensaje));
+
+	while(cantidad > 0) {
+		mensaje.msg_iov = iov;
+		mensaje.msg_iovlen = cantidad;
+		TRAZA_INICIO(tramo);
+		ssize_t enviados = sendmsg(socket_cliente, &mensaje, MSG_NOSIGNAL);
+		TRAZA_FIN(tramo, "enviar_iovecs:sendmsg");
+		if(enviados == -1) {
+			if(errno == EINTR)
+				continue; // una señal interrumpio el envio antes de mandar nada: se reintenta
+			return -1;
+		}
+
+		// Envio parcial: se saltean los bloques ya enviados y se recorta el que quedo por la mitad
+		while(cantidad > 0 && enviados >= (ssize_t) iov->iov_len) {
+			enviados -= iov->iov_len;
+			iov++;
+			cantidad--;
+		}
+		if(cantidad > 0) {
+			iov->iov_base = (char*) iov->iov_base + enviados;
+			iov->iov_len -= enviados;
+		}
+	}
+	return 0;
+}
 
-	// Se libera la memoria asignada
-	free(a_enviar); // el paquete serializado
-	eliminar_paquete(paquete); // el paquete en si y sus componentes 
+int enviar_mensaje(char* mensaje, int socket_cliente)
+{
+	// Encabezado del frame: | cod_op | size | (el size incluye el \0 de fin de cadena)
+	int encabezado[2] = { MENSAJE, strlen(mensaje) + 1 };
+
+	// El string se envia desde donde esta: no hace falta armar un t_paquete ni serializarlo
+	struct iovec iov[2] = {
+		{ .iov_base = encabezado, .iov_len = sizeof(encabezado) },
+		{ .iov_base = mensaje, .iov_len = encabezado[1] }
+	};
+	return enviar_iovecs(socket_cliente, iov, 2);
 }
 
 void crear_buffer(t_paquete* paquete)
 {
-	paquete->buffer = malloc(sizeof(t_buffer)); // Reserva memoria dinámica para un t_buffer, para guardar datos a enviar
-	paquete->buffer->size = 0; // Inicializa el tamaño del buffer en 0 porque todavía no se ha agregado ningún dato
-	paquete->buffer->stream = NULL; // Inicializa el puntero a NULL, lo cual indica que aún no hay contenido cargado
+	paquete->buffer = pool_tomar_buffer(); // primero se intenta reutilizar uno (con su stream ya reservado)
+	if(paquete->buffer == NULL) {
+		paquete->buffer = malloc(sizeof(t_buffer)); // Reserva memoria dinámica para un t_buffer, para guardar datos a enviar
+		paquete->buffer->size = 0; // Inicializa el tamaño del buffer en 0 porque todavía no se ha agregado ningún dato
+		paquete->buffer->capacidad = 0; // Todavia no hay nada reservado
+		paquete->buffer->stream = NULL; // Inicializa el puntero a NULL, lo cual indica que aún no hay contenido cargado
+	}
 }
 
 t_paquete* crear_paquete(void)
 {
-	t_paquete* paquete = malloc(sizeof(t_paquete)); // Reserva memoria en el heap para un nuevo paquete.
+	t_paquete* paquete = pool_tomar_paquete();
+	if(paquete == NULL)
+		paquete = malloc(sizeof(t_paquete)); // Reserva memoria en el heap para un nuevo paquete.
 	paquete->codigo_operacion = PAQUETE; //  le dice a quien reciba este paquete que es un "paquete"
 	crear_buffer(paquete); // inicializar el buffer del paquete con tamaño 0 y sin datos aún
 	return paquete; // Devuelve el puntero al paquete creado, ya listo para usarse
 }
 
+void reservar_en_paquete(t_paquete* paquete, int bytes)
+{
+	int necesaria = paquete->buffer->size + bytes;
+	if(necesaria <= paquete->buffer->capacidad)
+		return; // ya entra
+
+	// Crecimiento geometrico: duplicar la capacidad hace que agregar N elementos cueste O(N) copias en total
+	int capacidad = paquete->buffer->capacidad > 0 ? paquete->buffer->capacidad : 64;
+	while(capacidad < necesaria)
+		capacidad *= 2;
+
+	TRAZA_INICIO(tramo);
+	paquete->buffer->stream = realloc(paquete->buffer->stream, capacidad);
+	TRAZA_FIN(tramo, "reservar_en_paquete:realloc");
+	paquete->buffer->capacidad = capacidad;
+}
+
 void agregar_a_paquete(t_paquete* paquete, void* valor, int tamanio)
 {
-	//Expandir el stream
-	// realloc amplía el bloque de memoria existente para que quepa el nuevo dato
-	// Suma sizeof(int) porque además del contenido, guarda también su tamaño.
-	paquete->buffer->stream = realloc(paquete->buffer->stream, paquete->buffer->size + tamanio + sizeof(int));
+	// Se asegura lugar para el contenido mas su tamaño (un int adelante)
+	// Solo hace realloc si no entra: la capacidad crece al doble cada vez
+	reservar_en_paquete(paquete, tamanio + sizeof(int));
 
 	// Copia el tamaño del nuevo dato al final del stream
 	memcpy(paquete->buffer->stream + paquete->buffer->size, &tamanio, sizeof(int));
@@ -174,39 +366,131 @@ void agregar_a_paquete(t_paquete* paquete, void* valor, int tamanio)
 	paquete->buffer->size += tamanio + sizeof(int); //Suma el nuevo tamaño agregado al total del paquete
 }
 
-void enviar_paquete(t_paquete* paquete, int socket_cliente)
+int enviar_paquete(t_paquete* paquete, int socket_cliente)
 {
-	/** Calcular la cantidad de bytes a enviar
-	 * El msj serializado contiene: 
+	/** El frame enviado contiene:
 	 * sizeof(int) para codigo_operacion
 	 * sizeof(int) para buffer->size
 	 * buffer->size bytes de datos reales (stream)
-	 * TOTAL = 2 * sizeof(int) + buffer->size
+	 * El encabezado va en el stack y el stream se envia desde el propio paquete: no hay copia intermedia.
 	 */
-	int bytes = paquete->buffer->size + 2*sizeof(int);
+	int encabezado[2] = { paquete->codigo_operacion, paquete->buffer->size };
 
-	/** Serializar el paquete
-	 * Convierte la estructura t_paquete (que tiene campos dispersos en memoria) 
-	 * a un bloque contiguo (void*) apto para enviar por red.
-	 */
-	void* a_enviar = serializar_paquete(paquete, bytes);
+	struct iovec iov[2] = {
+		{ .iov_base = encabezado, .iov_len = sizeof(encabezado) },
+		{ .iov_base = paquete->buffer->stream, .iov_len = paquete->buffer->size }
+	};
+	return enviar_iovecs(socket_cliente, iov, 2);
+}
 
-	// Enviar los datos por el socket
-	send(socket_cliente, a_enviar, bytes, 0);
+int recibir_encabezado(int socket_cliente, int version, t_encabezado* encabezado)
+{
+	uint8_t bytes[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int recibidos = 0, estado = 0;
+	while(estado == 0 && recibidos < PROTOCOLO_ENCABEZADO_MAXIMO) {
+		int faltan = version == PROTOCOLO_VERSION_1 ? (int) PROTOCOLO_ENCABEZADO_V1 - recibidos : 1;
+		TRAZA_INICIO(tramo);
+		ssize_t leidos = recv(socket_cliente, bytes + recibidos, faltan, MSG_WAITALL);
+		TRAZA_FIN(tramo, "recibir_encabezado:recv");
+		if(leidos != faltan)
+			return -1;
+		recibidos += faltan;
+		estado = protocolo_decodificar_encabezado(version, bytes, recibidos, encabezado);
+	}
+	return estado == 1 ? 0 : -1;
+}
+
+int recibir_credito(int socket_cliente, t_encabezado* encabezado, int64_t* credito)
+{
+	uint8_t payload[VARINT_MAXIMO];
+	uint32_t bytes;
+	if(encabezado->size < 1 || encabezado->size > VARINT_MAXIMO
+		|| recv(socket_cliente, payload, encabezado->size, MSG_WAITALL) != (ssize_t) encabezado->size
+		|| varint_decodificar(payload, encabezado->size, &bytes) <= 0)
+		return -1;
+	if(credito != NULL)
+		*credito += bytes;
+	return 0;
+}
+
+int absorber_creditos(int socket_cliente, int version, int64_t* credito)
+{
+	// Un CREDITO ocupa a lo sumo 9 bytes: se miran sin consumir y se consumen solo los completos
+	uint8_t pendientes[256];
+	while(1) {
+		ssize_t leidos = recv(socket_cliente, pendientes, sizeof(pendientes), MSG_PEEK | MSG_DONTWAIT);
+		if(leidos == -1)
+			return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+		if(leidos == 0)
+			return -1; // el servidor cerro
+
+		int consumidos = 0;
+		t_encabezado encabezado;
+		uint32_t bytes;
+		while(protocolo_decodificar_encabezado(version, pendientes + consumidos, leidos - consumidos, &encabezado) == 1
+			&& encabezado.cod_op == CREDITO && encabezado.size <= leidos - consumidos - encabezado.encabezado
+			&& varint_decodificar(pendientes + consumidos + encabezado.encabezado, encabezado.size, &bytes) > 0) {
+			*credito += bytes;
+			consumidos += encabezado.encabezado + encabezado.size;
+		}
+		if(consumidos == 0)
+			return -1;
+		recv(socket_cliente, pendientes, consumidos, MSG_DONTWAIT); // ya estan en el socket: no bloquea
+	}
+}
 
-	// Se libera el bloque temporal a_enviar porque ya fue enviado y no se necesita más
-	free(a_enviar);
+int consultar(int socket_cliente, int version, int64_t* credito, op_code cod_op, char* clave, char** valor)
+{
+	uint8_t encabezado[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int largo_clave = strlen(clave);
+	struct iovec iov[2] = {
+		{ .iov_base = encabezado, .iov_len = protocolo_codificar_encabezado(version, encabezado, cod_op, 0, largo_clave) },
+		{ .iov_base = clave, .iov_len = largo_clave }
+	};
+	if(enviar_iovecs(socket_cliente, iov, 2) == -1)
+		return -1;
+
+	// Antes de la RESPUESTA puede llegar credito por lo que se envio con el emisor
+	t_encabezado respuesta;
+	do {
+		if(recibir_encabezado(socket_cliente, version, &respuesta) == -1
+			|| (respuesta.cod_op == CREDITO && recibir_credito(socket_cliente, &respuesta, credito) == -1))
+			return -1;
+	} while(respuesta.cod_op == CREDITO);
+	if(respuesta.cod_op != RESPUESTA || respuesta.size < 1 || respuesta.size > PROTOCOLO_FRAME_MAXIMO)
+		return -1; // ademas de no ser lo esperado, un size enorme solo puede ser basura: no se reserva
+
+	// | estado | valor |: el valor se recibe con lugar para el '\0'
+	TRAZA_INICIO(tramo_malloc);
+	char* datos = malloc(respuesta.size + 1);
+	TRAZA_FIN(tramo_malloc, "consultar:malloc");
+	TRAZA_INICIO(tramo_recv);
+	ssize_t recibidos = recv(socket_cliente, datos, respuesta.size, MSG_WAITALL);
+	TRAZA_FIN(tramo_recv, "consultar:recv");
+	if(recibidos != (ssize_t) respuesta.size) {
+		free(datos);
+		return -1;
+	}
+	int encontrada = datos[0] == PROTOCOLO_ENCONTRADO;
+	if(encontrada && valor != NULL) {
+		datos[respuesta.size] = '\0';
+		*valor = strdup(datos + 1);
+	}
+	free(datos);
+	return encontrada;
 }
 
-// Toda la memoria reservada con malloc debe ser liberada manualmente.
+// Toda la memoria reservada con malloc debe ser liberada manualmente (o devuelta al pool).
 void eliminar_paquete(t_paquete* paquete)
 {
-	// Libera la memoria asignada al campo stream, que contiene los datos enviados o recibidos.
-	free(paquete->buffer->stream);
-	// Libera la memoria del buffer completo (t_buffer)
-	free(paquete->buffer);
-	// Libera el propio t_paquete, que es la estructura principal
-	free(paquete);
+	// El buffer vuelve al pool con su stream; si no hay lugar, se libera el stream y el buffer
+	if(!pool_devolver_buffer(paquete->buffer)) {
+		free(paquete->buffer->stream);
+		free(paquete->buffer);
+	}
+	// Lo mismo con el propio t_paquete, que es la estructura principal
+	if(!pool_devolver_paquete(paquete))
+		free(paquete);
 }
 
 void liberar_conexion(int socket_cliente)
@@ -22,26 +22,25 @@
 #include<stdio.h> // Entrada/salida (por ejemplo, printf, perror, etc.).
 #include<stdlib.h> // Utilidades como malloc, free, exit.
 #include<string.h> // manipulación de cadenas de caracteres y memoria
+#include<stdbool.h> // bool
+#include<time.h> // clock_gettime para los timeouts de conexion
 
 // Librerias standard de POSIX/Linux
 #include<signal.h> // Permite manejar señales del sistema (como SIGINT, SIGTERM, etc.)
 #include<unistd.h> // Contiene funciones POSIX básicas (read, write, close, etc.) Syscalls al SO
+#include<sys/uio.h> // struct iovec: enviar varios bloques de memoria en una sola syscall (scatter-gather)
+#include<errno.h> // Variable errno para distinguir EINTR de errores reales
 #include<sys/socket.h> // Proporciona la interfaz principal para trabajar con sockets (socket, bind, listen, etc.) (struct sockaddr)
 #include<netdb.h> // Para trabajar con resolución de nombres de host y puertos (getaddrinfo(), freeaddrinfo()) (struct addrinfo)
+#include<poll.h> // poll(): esperar varios connect() no bloqueantes a la vez
+#include<fcntl.h> // fcntl(): volver el socket conectado a modo bloqueante
 
 // Librerías de la biblioteca Commons (de so-unix/utn)
 #include<commons/log.h> // Para crear logs fácilmente (t_log* logger, log_info, etc.).
 
-/**
- * @brief Define los tipos de operación que pueden ser enviados a través del socket
- * 
- * Permite saber qué tipo de contenido está llegando en una conexión, y así tomar decisiones distintas según el valor.
- */
-typedef enum
-{
-	MENSAJE, /**< mensajes simples (string) [por defecto es 0]*/
-	PAQUETE /**< otro tipo de contenido más complejo [por defecto 1]*/
-} op_code;
+// Protocolo compartido con el servidor (op_code, formato de los frames, handshake)
+#include<protocolo.h>
+#include<traza.h> // marcas de cada etapa del camino caliente (solo en debug)
 
 /**
  * @brief Representa un bloque de datos en memoria
@@ -49,6 +48,7 @@ typedef enum
 typedef struct
 {
 	int size; /**< tamaño del contenido (en bytes) */
+	int capacidad; /**< bytes reservados en stream (>= size); crece al doble para no hacer un realloc por elemento */
 	void* stream; /**< un puntero genérico (void*) a la zona de memoria donde está el contenido (el mensaje real, datos binarios, etc.) */
 } t_buffer;
 
@@ -63,34 +63,98 @@ typedef struct
 	t_buffer* buffer; /**< contiene el contenido real del paquete (y su tamaño) */
 } t_paquete;
 
+/**
+ * @brief Una direccion resuelta por getaddrinfo(), copiada para poder guardarla
+ */
+typedef struct
+{
+	int familia; /**< ai_family (AF_INET, AF_INET6) */
+	int tipo; /**< ai_socktype (SOCK_STREAM) */
+	int protocolo; /**< ai_protocol */
+	socklen_t largo; /**< bytes validos de direccion */
+	struct sockaddr_storage direccion; /**< IP + puerto (entra cualquier familia) */
+} t_direccion;
+
+/* Direcciones que se prueban como mucho por cada nombre resuelto */
+#define CONEXION_DIRECCIONES_MAXIMO 8
+
+/* Cuanto se le da a un candidato antes de arrancar el siguiente en paralelo (RFC 8305 recomienda 250 ms) */
+#define CONEXION_DEMORA_INTENTO_MS 250
+
+/* Timeout de crear_conexion() */
+#define CONEXION_TIMEOUT_DEFECTO_MS 5000
+
+/**
+ * @brief Resuelve (ip, puerto) con getaddrinfo(), IPv4 e IPv6
+ * @param ip IP o nombre del server
+ * @param puerto Numero de puerto del server
+ * @param direcciones donde copiar las direcciones, en el orden que las devolvio getaddrinfo()
+ * @param maximo capacidad de @p direcciones
+ * @return cantidad de direcciones copiadas, o -1 si no se pudo resolver
+ */
+int resolver_direcciones(char* ip, char* puerto, t_direccion* direcciones, int maximo);
+
+/**
+ * @brief Conecta un socket a la primera direccion que acepte la conexion ("happy eyeballs", RFC 8305)
+ * @param direcciones candidatos, en el orden de preferencia de getaddrinfo()
+ * @param cantidad cantidad de candidatos
+ * @param timeout_ms tiempo maximo total (0 = sin limite, lo que tarde el kernel en rendirse)
+ * @return fd del socket conectado (bloqueante), o -1 si ninguna direccion conecto a tiempo (errno: ETIMEDOUT o el error del ultimo intento)
+ * @note Los connect() son no bloqueantes: si un candidato no contesta en CONEXION_DEMORA_INTENTO_MS se arranca
+ * el siguiente (alternando IPv6/IPv4) sin cancelar el anterior, y gana el primero que conecte.
+ * Asi una direccion que descarta paquetes no demora el arranque mas que esa demora.
+ */
+int conectar_direcciones(t_direccion* direcciones, int cantidad, int timeout_ms);
+
 /**
  * @brief Crea nu socket de conexion cliente y lo conecta a un server
  * @param ip IP del server ("000.0.0.0") [char*]
  * @param puerto Numero de puerto del server ("4444") [char*]
+ * @return fd del socket conectado, o -1 si no se pudo resolver o conectar
+ * @note Resuelve y conecta en cada llamada: para reutilizar conexiones ver pool_conexiones.h.
+ * Usa CONEXION_TIMEOUT_DEFECTO_MS (ver crear_conexion_con_timeout())
  */
 int crear_conexion(char* ip, char* puerto);
 
-int handshake_cliente(int socket_cliente);
+/**
+ * @brief Igual que crear_conexion(), con un tiempo maximo para conectar
+ * @param timeout_ms tiempo maximo en milisegundos (0 = sin limite)
+ */
+int crear_conexion_con_timeout(char* ip, char* puerto, int timeout_ms);
+
+/**
+ * @brief Negocia con el servidor la version del protocolo (ver protocolo.h)
+ * @param socket_cliente fd del socket recien conectado, antes de enviar cualquier frame
+ * @param capacidades PROTOCOLO_CAPACIDAD_* que se quieren usar; a la vuelta quedan las que acepto el servidor
+ * @return version elegida por el servidor, o -1 si no contesto un handshake valido o lo rechazo
+ * @note Si no se llama, el servidor atiende la conexion como v1 (enviar_mensaje() y enviar_paquete() envian v1)
+ */
+int handshake_cliente(int socket_cliente, uint8_t* capacidades);
 
 /**
  * @brief Envia un mensaje string al servidor por socket
  * @param mensaje el string char* que vamos a enviar
  * @param socket_cliente fd del socket a través del cual lo vamos a enviar.
  * 
- * Envia un mensaje por socket a un servidor, empaquetando los datos con una estructura más robusta y organizada.
+ * @return 0 si se envio el frame completo, -1 si fallo el envio
+ *
+ * Envia un mensaje por socket a un servidor: el encabezado y el string salen en una sola syscall, sin copiarlos a un buffer intermedio.
+ * El frame sale en protocolo v1: para v2 usar el emisor (ver emisor.h) con la version negociada.
  */
-void enviar_mensaje(char* mensaje, int socket_cliente);
+int enviar_mensaje(char* mensaje, int socket_cliente);
 
 /**
  * @brief Crea el paquete que vamos a enviar
  * @return paquete: devuelve el puntero al paquete creado, ya listo para usarse
- * @note Función de inicialización que se encarga de crear un nuevo t_paquete, configurarlo y dejarlo listo para ser usado 
+ * @note Función de inicialización que se encarga de crear un nuevo t_paquete, configurarlo y dejarlo listo para ser usado.
+ * Si hay paquetes en el pool (ver pool_paquetes.h) reutiliza uno en lugar de reservar memoria
  */
 t_paquete* crear_paquete(void);
 
 /**
  * @brief Inicializar el campo buffer dentro de un t_paquete
  * @param paquete t_paquete* ya creado
+ * @note Reutiliza un buffer del pool si hay (conserva la capacidad de su stream)
  */
 void crear_buffer(t_paquete* paquete);
 
@@ -104,6 +168,14 @@ void crear_buffer(t_paquete* paquete);
  */
 void agregar_a_paquete(t_paquete* paquete, void* valor, int tamanio);
 
+/**
+ * @brief Reserva lugar en el paquete para @p bytes mas, sin agregar nada todavia
+ * @param paquete (t_paquete*) paquete ya creado
+ * @param bytes cantidad de bytes que se van a agregar (contando el int de tamanio de cada elemento)
+ * @note Si se sabe cuanto va a ocupar el paquete, reservarlo de una evita que agregar_a_paquete() tenga que agrandarlo
+ */
+void reservar_en_paquete(t_paquete* paquete, int bytes);
+
 /**
  * @brief Toma un t_paquete (estructura compleja) y lo convierte en un bloque de memoria contiguo (void*) listo para ser enviado por un socket con send()
  * @param paquete t_paquete* que quiero serializar
@@ -111,17 +183,67 @@ void agregar_a_paquete(t_paquete* paquete, void* valor, int tamanio);
  * @return void* magic: puntero a una estructura de este tipo
  * @note
  * | 4 bytes (codigo_operacion) | 4 bytes (size) | size bytes (stream) |
+ * enviar_mensaje() y enviar_paquete() ya no la usan (envian con enviar_iovecs()), se mantiene por compatibilidad
  */
 void* serializar_paquete(t_paquete* paquete, int bytes);
 
+/**
+ * @brief Envia varios bloques de memoria como un unico flujo de bytes, reintentando los envios parciales
+ * @param socket_cliente fd del socket conectado
+ * @param iov bloques a enviar, en orden (se modifica a medida que se envia)
+ * @param cantidad cantidad de bloques
+ * @return 0 si se envio todo, -1 si fallo (ej. el servidor cerro la conexion)
+ * @note Usa sendmsg() con MSG_NOSIGNAL: si el servidor se cae devuelve -1 en lugar de matar al cliente con SIGPIPE
+ */
+int enviar_iovecs(int socket_cliente, struct iovec* iov, int cantidad);
+
 /**
  * @brief Dada una conexión y un paquete, lo envía a través de ella.
  * @param paquete (t_paquete*) paquete ya creado y listo
  * @param socket_cliente (int) fd del socket de conexion
  * 
+ * @return 0 si se envio el frame completo, -1 si fallo el envio
+ *
  * Se encarga de enviar un paquete estructurado a través de un socket ya conectado.
+ * El encabezado y paquete->buffer->stream salen como bloques separados de un mismo sendmsg(), sin serializar_paquete().
+ * El frame sale en protocolo v1 (igual que enviar_mensaje()).
+ */
+int enviar_paquete(t_paquete* paquete, int socket_cliente);
+
+/**
+ * @brief Recibe el encabezado del proximo frame que mande el servidor (bloquea hasta tenerlo completo)
+ * @return 0 si llego, -1 si fallo la conexion o el encabezado es invalido
+ * @note El encabezado v2 tiene largo variable: se lee de a un byte hasta que este completo (son pocos bytes)
+ */
+int recibir_encabezado(int socket_cliente, int version, t_encabezado* encabezado);
+
+/**
+ * @brief Recibe el payload de un CREDITO cuyo encabezado ya se leyo y lo suma al credito de la conexion
+ * @param credito credito de la conexion (NULL: se descarta)
+ * @return 0 si todo bien, -1 si fallo la conexion o el payload es invalido
+ */
+int recibir_credito(int socket_cliente, t_encabezado* encabezado, int64_t* credito);
+
+/**
+ * @brief Recibe, sin bloquear, los CREDITO que el servidor mando mientras nadie leia la conexion
+ * @param credito credito de la conexion
+ * @return 0 si el socket quedo vacio, -1 si hay otra cosa (o un frame a medias) o el servidor cerro
+ */
+int absorber_creditos(int socket_cliente, int version, int64_t* credito);
+
+/**
+ * @brief Envia un GET o un EXISTS y espera la RESPUESTA del servidor
+ * @param socket_cliente fd del socket conectado
+ * @param version version negociada en la conexion
+ * @param credito credito de la conexion: los CREDITO que lleguen antes de la RESPUESTA se suman aca (puede ser NULL)
+ * @param cod_op GET o EXISTS
+ * @param clave string a buscar (se envia sin el '\0')
+ * @param valor si no es NULL y se encontro la clave, ahi queda una copia del valor como string (la libera quien llama)
+ * @return 1 si la clave existe, 0 si no, -1 si fallo la conexion o la respuesta es invalida
+ * @note Bloquea hasta la respuesta. Si antes se envio algo con el emisor, hay que vaciarlo (emisor_flush())
+ * para que el servidor ya lo haya recibido: el servidor procesa los frames de una conexion en orden
  */
-void enviar_paquete(t_paquete* paquete, int socket_cliente);
+int consultar(int socket_cliente, int version, int64_t* credito, op_code cod_op, char* clave, char** valor);
 
 /**
  * @brief Termina la conexión y libera los recursos que se usaron para gestionar la misma.
@@ -136,6 +258,7 @@ void liberar_conexion(int socket_cliente);
  * @note Escencial para evitar memory leaks
  * 
  * Se encarga de liberar toda la memoria reservada para un paquete (t_paquete), incluyendo su contenido.
+ * El paquete y su buffer vuelven al pool para el proximo crear_paquete(); solo se liberan si el pool esta lleno.
  */
 void eliminar_paquete(t_paquete* paquete);
 
@@ -0,0 +1,13 @@
+# Libraries
+LIBS=protocolo commons pthread m z
+
+# Custom libraries' paths
+SHARED_LIBPATHS=
+STATIC_LIBPATHS=../protocolo
+
+# Fuentes del servidor que se prueban (se compilan aca, sin el resto del servidor)
+SERVER_SRCS=lector.c paquete_vista.c metricas.c utils.c
+
+# Compiler flags (los sanitizers marcan cualquier lectura fuera de lo reservado)
+CDEBUG=-g -Wall -D_GNU_SOURCE -DDEBUG -fdiagnostics-color=always -fsanitize=address,undefined -fno-sanitize-recover=all
+CRELEASE=-O2 -g -Wall -D_GNU_SOURCE -DNDEBUG -fsanitize=address,undefined -fno-sanitize-recover=all
@@ -0,0 +1,257 @@
+/**
+ * @file fuzz.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del driver de fuzzing del decodificador de frames
+ *
+ * Sin archivos, cada iteracion arma una semilla valida del objetivo y le aplica algunas mutaciones al azar
+ * (bits, bytes "interesantes", tamanios enormes, pedazos insertados, borrados o cortados). Con archivos,
+ * pasa cada uno tal cual por el objetivo: sirve para reproducir un fallo-<objetivo>.bin.
+ * Cada entrada se copia a un bloque de su tamanio justo, asi ASan marca hasta un byte leido de mas.
+ */
+
+#include "fuzz.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#include<sanitizer/common_interface_defs.h> // __sanitizer_set_death_callback
+#endif
+
+/* Estado del xorshift (nunca 0) */
+static uint64_t estado_aleatorio = 0x9E3779B97F4A7C15ULL;
+
+/* Entrada que se esta probando, para guardarla si algo falla */
+static const uint8_t* entrada_actual = NULL;
+static size_t size_actual = 0;
+static const char* objetivo_actual = "";
+
+uint32_t fuzz_aleatorio(void)
+{
+	estado_aleatorio ^= estado_aleatorio << 13;
+	estado_aleatorio ^= estado_aleatorio >> 7;
+	estado_aleatorio ^= estado_aleatorio << 17;
+	return estado_aleatorio >> 32;
+}
+
+/**
+ * @brief Guarda la entrada actual en fallo-<objetivo>.bin (para reproducirla con bin/fuzz -o objetivo archivo)
+ */
+static void guardar_entrada(void)
+{
+	if(entrada_actual == NULL)
+		return;
+	char nombre[64];
+	snprintf(nombre, sizeof(nombre), "fallo-%s.bin", objetivo_actual);
+	FILE* archivo = fopen(nombre, "wb");
+	if(archivo != NULL) {
+		fwrite(entrada_actual, 1, size_actual, archivo);
+		fclose(archivo);
+		fprintf(stderr, "Entrada guardada en %s (%zu bytes)\n", nombre, size_actual);
+	}
+}
+
+void fuzz_fallar(const char* motivo)
+{
+	fprintf(stderr, "Fallo el objetivo %s: %s\n", objetivo_actual, motivo);
+	guardar_entrada();
+	abort();
+}
+
+/**
+ * @brief Prueba una entrada en un bloque de su tamanio justo
+ */
+static int probar(t_objetivo* objetivo, const uint8_t* datos, size_t size)
+{
+	uint8_t* copia = malloc(size > 0 ? size : 1);
+	memcpy(copia, datos, size);
+	entrada_actual = copia;
+	size_actual = size;
+	objetivo_actual = objetivo->nombre;
+	int aceptada = objetivo->probar(copia, size);
+	entrada_actual = NULL;
+	free(copia);
+	return aceptada;
+}
+
+/**
+ * @brief Aplica una mutacion al azar
+ * @return el tamanio nuevo de la entrada (hasta FUZZ_ENTRADA_MAXIMA)
+ */
+static size_t mutar(uint8_t* datos, size_t size)
+{
+	static const uint8_t interesantes[] = { 0x00, 0x01, 0x7E, 0x7F, 0x80, 0xFF };
+	static const uint32_t enteros[] = { 0, 1, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, FUZZ_FRAME_MAXIMO, FUZZ_FRAME_MAXIMO + 1 };
+	if(size == 0) {
+		datos[0] = fuzz_aleatorio();
+		return 1;
+	}
+	size_t posicion = fuzz_aleatorio() % size;
+	size_t largo = 1 + fuzz_aleatorio() % (size - posicion);
+	uint32_t entero;
+
+	switch(fuzz_aleatorio() % 8) {
+	case 0: // un bit
+		datos[posicion] ^= 1 << (fuzz_aleatorio() % 8);
+		break;
+	case 1: // un byte cualquiera
+		datos[posicion] = fuzz_aleatorio();
+		break;
+	case 2: // un byte que cambia el sentido de un encabezado o varint (magia, bit de continuacion, signo)
+		datos[posicion] = interesantes[fuzz_aleatorio() % sizeof(interesantes)];
+		break;
+	case 3: // un varint enorme (un size o tamanio de elemento de 4 GB)
+		if(size - posicion >= VARINT_MAXIMO)
+			memcpy(datos + posicion, "\xFF\xFF\xFF\xFF\x0F", VARINT_MAXIMO);
+		break;
+	case 4: // un int de limite (sizes v1)
+		entero = enteros[fuzz_aleatorio() % (sizeof(enteros) / sizeof(enteros[0]))];
+		if(size - posicion >= sizeof(entero))
+			memcpy(datos + posicion, &entero, sizeof(entero));
+		break;
+	case 5: // se repite un pedazo (frames o elementos duplicados)
+		if(size + largo <= FUZZ_ENTRADA_MAXIMA) {
+			memmove(datos + posicion + largo, datos + posicion, size - posicion);
+			size += largo;
+		}
+		break;
+	case 6: // se borra un pedazo
+		memmove(datos + posicion, datos + posicion + largo, size - posicion - largo);
+		size -= largo;
+		break;
+	default: // se corta (frame a medias)
+		size = posicion;
+		break;
+	}
+	return size;
+}
+
+static void uso(char* programa)
+{
+	fprintf(stderr, "Uso: %s [-o objetivo] [-n iteraciones] [-s semilla] [entrada ...]\n"
+		"       objetivos:", programa);
+	for(t_objetivo* objetivo = objetivos; objetivo->nombre != NULL; objetivo++)
+		fprintf(stderr, " %s", objetivo->nombre);
+	fprintf(stderr, " (por defecto todos)\n");
+}
+
+/**
+ * @brief Lee un archivo entero a memoria
+ * @return los bytes (liberar con free()), o NULL si no se pudo leer
+ */
+static uint8_t* leer_archivo(const char* ruta, size_t* size)
+{
+	FILE* archivo = fopen(ruta, "rb");
+	if(archivo == NULL)
+		return NULL;
+	fseek(archivo, 0, SEEK_END);
+	long largo = ftell(archivo);
+	rewind(archivo);
+	uint8_t* datos = malloc(largo > 0 ? largo : 1);
+	*size = fread(datos, 1, largo, archivo);
+	fclose(archivo);
+	return datos;
+}
+
+/**
+ * @brief Genera y prueba @p iteraciones entradas mutadas del objetivo
+ */
+static void fuzzear(t_objetivo* objetivo, long iteraciones)
+{
+	uint8_t* entrada = malloc(FUZZ_ENTRADA_MAXIMA);
+	long aceptadas = 0;
+	struct timespec inicio, fin;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for(long i = 0; i < iteraciones; i++) {
+		size_t size = objetivo->semilla(entrada);
+		int mutaciones = fuzz_aleatorio() % 8; // 0: la semilla tal cual (tiene que aceptarse)
+		for(int j = 0; j < mutaciones; j++)
+			size = mutar(entrada, size);
+		aceptadas += probar(objetivo, entrada, size);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &fin);
+	double segundos = (fin.tv_sec - inicio.tv_sec) + (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+	printf("%-13s entradas: %ld  aceptadas: %ld  rechazadas: %ld  (%.0f entradas/s)\n", objetivo->nombre,
+		iteraciones, aceptadas, iteraciones - aceptadas, iteraciones / segundos);
+	free(entrada);
+}
+
+/**
+ * @brief Deja los limites del servidor en los de la prueba
+ */
+static void iniciar(void)
+{
+	limites.frame_maximo = FUZZ_FRAME_MAXIMO;
+	limites.elementos_maximo = FUZZ_ELEMENTOS_MAXIMO;
+	logger = log_create("fuzz.log", "Fuzz", 0, LOG_LEVEL_ERROR);
+#if defined(__SANITIZE_ADDRESS__)
+	__sanitizer_set_death_callback(guardar_entrada); // un error de ASan/UBSan tambien deja la entrada
+#endif
+}
+
+#ifdef FUZZ_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t* datos, size_t size)
+{
+	static t_objetivo* objetivo = NULL;
+	if(objetivo == NULL) {
+		iniciar();
+		char* nombre = getenv("FUZZ_OBJETIVO");
+		if((objetivo = buscar_objetivo(nombre != NULL ? nombre : "lector")) == NULL)
+			abort();
+	}
+	probar(objetivo, datos, size);
+	return 0;
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+	t_objetivo* elegido = NULL;
+	long iteraciones = 100000;
+	uint64_t semilla = time(NULL);
+
+	int opcion;
+	while((opcion = getopt(argc, argv, "o:n:s:")) != -1) {
+		switch(opcion) {
+		case 'o':
+			if((elegido = buscar_objetivo(optarg)) == NULL) {
+				uso(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'n': iteraciones = atol(optarg); break;
+		case 's': semilla = strtoull(optarg, NULL, 10); break;
+		default:
+			uso(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	iniciar();
+
+	// Con archivos: cada uno tal cual, por el objetivo elegido (o por todos)
+	if(optind < argc) {
+		for(int i = optind; i < argc; i++) {
+			size_t size;
+			uint8_t* datos = leer_archivo(argv[i], &size);
+			if(datos == NULL) {
+				fprintf(stderr, "No se pudo leer %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+			for(t_objetivo* objetivo = objetivos; objetivo->nombre != NULL; objetivo++)
+				if(elegido == NULL || elegido == objetivo)
+					printf("%s: %-13s %s\n", argv[i], objetivo->nombre, probar(objetivo, datos, size) ? "aceptada" : "rechazada");
+			free(datos);
+		}
+		return EXIT_SUCCESS;
+	}
+
+	// Sin archivos: entradas generadas (la misma semilla repite exactamente las mismas)
+	estado_aleatorio = semilla != 0 ? semilla : 1;
+	printf("semilla: %lu\n", semilla);
+	for(t_objetivo* objetivo = objetivos; objetivo->nombre != NULL; objetivo++)
+		if(elegido == NULL || elegido == objetivo)
+			fuzzear(objetivo, iteraciones);
+	return EXIT_SUCCESS;
+}
+
+#endif /* FUZZ_LIBFUZZER */
@@ -0,0 +1,80 @@
+/**
+ * @file fuzz.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de los objetivos de fuzzing del decodificador de frames
+ *
+ * Cada objetivo recibe bytes arbitrarios (como si los mandara un cliente roto o malicioso) y los pasa por una parte
+ * del decodificador: encabezados, elementos de PAQUETE, payloads comprimidos y el lector del servidor (separar frames
+ * de un flujo que llega de a pedazos). Ademas de que nada se lea fuera de lo reservado (lo marcan los sanitizers,
+ * con los que se compila), cada objetivo verifica que la memoria quede acotada por t_limites_protocolo y no por lo que
+ * diga el frame; si algo no se cumple guarda la entrada en fallo-<objetivo>.bin y aborta.
+ * - bin/fuzz genera entradas mutando frames validos, sin dependencias (alcanza con gcc);
+ * - con -DFUZZ_LIBFUZZER solo queda LLVMFuzzerTestOneInput(), para compilarlo con clang -fsanitize=fuzzer
+ *   (el objetivo se elige con la variable de entorno FUZZ_OBJETIVO).
+ * Uso: bin/fuzz [-o objetivo] [-n iteraciones] [-s semilla] [entrada ...]
+ * @see https://llvm.org/docs/LibFuzzer.html
+ */
+
+#ifndef FUZZ_H_
+#define FUZZ_H_
+
+// Librerias standard de C
+#include<stdio.h> // printf, fprintf, fopen
+#include<stdlib.h> // malloc, free, abort
+#include<string.h> // memcpy, strcmp
+#include<stdint.h> // uint8_t, uint32_t
+#include<time.h> // time, clock_gettime
+
+// Librerias standard de POSIX/Linux
+#include<unistd.h> // getopt
+
+// Protocolo compartido (encabezados, elementos, compresion)
+#include<protocolo.h>
+#include<compresion.h>
+
+// Partes del servidor que se prueban: limites, lector y vistas de PAQUETE
+#include "lector.h"
+#include "paquete_vista.h"
+
+/* Limites con los que se prueba: chicos, para que las entradas los alcancen seguido */
+#define FUZZ_FRAME_MAXIMO (64 * 1024)
+#define FUZZ_ELEMENTOS_MAXIMO 256
+
+/* Bytes mas grandes de una entrada generada */
+#define FUZZ_ENTRADA_MAXIMA (256 * 1024)
+
+/* Pedazo mas grande en que se parte el flujo del objetivo lector (como llegaria en varios recv()) */
+#define FUZZ_PEDAZO_MAXIMO 512
+
+/**
+ * @brief Un objetivo de fuzzing
+ */
+typedef struct
+{
+	const char* nombre; /**< para -o y FUZZ_OBJETIVO */
+	int (*probar)(const uint8_t* datos, size_t size); /**< 1 si la entrada se acepto (se decodifico algo), 0 si se rechazo */
+	size_t (*semilla)(uint8_t* destino); /**< arma una entrada valida al azar (hasta FUZZ_ENTRADA_MAXIMA bytes) */
+} t_objetivo;
+
+// Declaracion de variable global
+extern t_objetivo objetivos[];
+
+/**
+ * @brief Numero pseudoaleatorio (xorshift, reproducible con la semilla de -s)
+ */
+uint32_t fuzz_aleatorio(void);
+
+/**
+ * @brief Informa que un objetivo no cumplio lo esperado: guarda la entrada actual y aborta
+ * @param motivo que no se cumplio
+ */
+void fuzz_fallar(const char* motivo);
+
+/**
+ * @brief Busca un objetivo por nombre
+ * @return el objetivo, o NULL si no existe
+ */
+t_objetivo* buscar_objetivo(const char* nombre);
+
+#endif /* FUZZ_H_ */
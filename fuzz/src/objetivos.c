@@ -0,0 +1,287 @@
+/**
+ * @file objetivos.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de los objetivos de fuzzing del decodificador de frames
+ *
+ * El primer byte de cada entrada elige la version de protocolo (bit bajo: 0 = v1, 1 = v2); el resto es lo que
+ * llegaria por el cable. Las semillas arman entradas validas: el driver las muta antes de probarlas.
+ */
+
+#include "fuzz.h"
+
+/* Los bytes que se leen van aca, asi el compilador no puede saltear la lectura */
+static volatile uint8_t sumidero;
+
+static int version_de(uint8_t selector)
+{
+	return selector & 1 ? PROTOCOLO_VERSION_2 : PROTOCOLO_VERSION_1;
+}
+
+/**
+ * @brief Lee todos los bytes de un bloque: si alguno esta fuera de lo reservado, lo marca ASan
+ */
+static void tocar(const void* datos, int size)
+{
+	uint8_t suma = 0;
+	for(int i = 0; i < size; i++)
+		suma ^= ((const uint8_t*) datos)[i];
+	sumidero = suma;
+}
+
+static void tocar_elemento(void* valor, int tamanio)
+{
+	tocar(valor, tamanio);
+}
+
+/**
+ * @brief Tamanio al azar, casi siempre chico pero a veces de cualquier magnitud (hasta 32 bits)
+ */
+static uint32_t tamanio_al_azar(void)
+{
+	uint32_t bits = fuzz_aleatorio() % 33;
+	return bits == 0 ? 0 : fuzz_aleatorio() >> (32 - bits);
+}
+
+/**
+ * @brief Escribe un payload de PAQUETE valido con elementos al azar
+ * @return bytes escritos
+ */
+static size_t paquete_al_azar(int version, uint8_t* destino, size_t disponibles)
+{
+	size_t escritos = 0;
+	int elementos = fuzz_aleatorio() % 20;
+	for(int i = 0; i < elementos; i++) {
+		uint32_t tamanio = fuzz_aleatorio() % 40;
+		if(escritos + sizeof(int) + tamanio > disponibles)
+			break;
+		escritos += protocolo_codificar_elemento(version, destino + escritos, tamanio);
+		for(uint32_t j = 0; j < tamanio; j++)
+			destino[escritos++] = 'a' + fuzz_aleatorio() % 26;
+	}
+	return escritos;
+}
+
+static int probar_encabezado(const uint8_t* datos, size_t size)
+{
+	if(size < 1)
+		return 0;
+	int version = version_de(datos[0]);
+	t_encabezado encabezado;
+	if(protocolo_decodificar_encabezado(version, datos + 1, size - 1, &encabezado) != 1)
+		return 0;
+	if(encabezado.encabezado <= 0 || encabezado.encabezado > PROTOCOLO_ENCABEZADO_MAXIMO || (size_t) encabezado.encabezado > size - 1)
+		fuzz_fallar("el encabezado dice ocupar mas de lo que se leyo");
+
+	// Volver a codificarlo tiene que dar los mismos campos (aunque no los mismos bytes: un varint puede venir con ceros de mas)
+	uint8_t bytes[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int tamanio = (encabezado.flags & PROTOCOLO_FLAG_ID)
+		? protocolo_codificar_encabezado_id(version, bytes, encabezado.cod_op, encabezado.flags, encabezado.size, encabezado.id)
+		: protocolo_codificar_encabezado(version, bytes, encabezado.cod_op, encabezado.flags, encabezado.size);
+	t_encabezado copia;
+	if(protocolo_decodificar_encabezado(version, bytes, tamanio, &copia) != 1 || copia.cod_op != encabezado.cod_op
+		|| copia.flags != encabezado.flags || copia.size != encabezado.size || copia.id != encabezado.id)
+		fuzz_fallar("el encabezado no sobrevive a codificarlo de nuevo");
+	return 1;
+}
+
+static size_t semilla_encabezado(uint8_t* destino)
+{
+	destino[0] = fuzz_aleatorio();
+	int version = version_de(destino[0]);
+	uint8_t flags = fuzz_aleatorio() & (PROTOCOLO_FLAG_COMPRIMIDO | PROTOCOLO_FLAG_ID);
+	int cod_op = fuzz_aleatorio() % (PUBLICACION + 1);
+	if(version == PROTOCOLO_VERSION_1)
+		return 1 + protocolo_codificar_encabezado(version, destino + 1, cod_op, 0, tamanio_al_azar() & INT32_MAX);
+	if(flags & PROTOCOLO_FLAG_ID)
+		return 1 + protocolo_codificar_encabezado_id(version, destino + 1, cod_op, flags, tamanio_al_azar(), fuzz_aleatorio());
+	return 1 + protocolo_codificar_encabezado(version, destino + 1, cod_op, flags, tamanio_al_azar());
+}
+
+static int probar_elementos(const uint8_t* datos, size_t size)
+{
+	if(size < 1)
+		return 0;
+	int version = version_de(datos[0]);
+	// Se copia a un bloque del tamanio justo: un byte leido de mas cae fuera de lo reservado
+	int largo = size - 1;
+	uint8_t* payload = malloc(largo > 0 ? largo : 1);
+	memcpy(payload, datos + 1, largo);
+
+	t_paquete_vista* vista = paquete_vista_crear(payload, largo, version, false);
+	if(vista == NULL) {
+		free(payload);
+		return 0;
+	}
+	if((uint32_t) vista->cantidad > limites.elementos_maximo)
+		fuzz_fallar("el paquete tiene mas elementos que el limite");
+	for(int i = 0; i < vista->cantidad; i++) {
+		int tamanio;
+		void* elemento = paquete_vista_elemento(vista, i, &tamanio);
+		tocar(elemento, tamanio);
+	}
+
+	// Un paquete v1 valido se tiene que poder pasar a v2 con los mismos elementos
+	if(version == PROTOCOLO_VERSION_1) {
+		int tamanio_v2 = protocolo_tamanio_paquete_v2(payload, largo);
+		if(tamanio_v2 == -1)
+			fuzz_fallar("paquete v1 valido que no se puede pasar a v2");
+		uint8_t* v2 = malloc(tamanio_v2 > 0 ? tamanio_v2 : 1);
+		if(protocolo_paquete_v1_a_v2(payload, largo, v2) != tamanio_v2
+			|| protocolo_contar_elementos(PROTOCOLO_VERSION_2, v2, tamanio_v2, limites.elementos_maximo) != vista->cantidad)
+			fuzz_fallar("el paquete pasado a v2 no tiene los mismos elementos");
+		free(v2);
+	}
+	paquete_vista_destruir(vista);
+	free(payload);
+	return 1;
+}
+
+static size_t semilla_elementos(uint8_t* destino)
+{
+	destino[0] = fuzz_aleatorio();
+	return 1 + paquete_al_azar(version_de(destino[0]), destino + 1, FUZZ_ENTRADA_MAXIMA - 1);
+}
+
+static int probar_descompresor(const uint8_t* datos, size_t size)
+{
+	// Se reutilizan entre entradas, igual que en una conexion
+	static t_descompresor* descompresor = NULL;
+	static t_compresor* compresor = NULL;
+	if(descompresor == NULL) {
+		descompresor = descompresor_crear(limites.frame_maximo);
+		compresor = compresor_crear(COMPRESION_NIVEL_DEFECTO);
+	}
+
+	void* salida;
+	int original = descompresor_descomprimir(descompresor, datos, size, &salida);
+	if(original > (int) limites.frame_maximo)
+		fuzz_fallar("se descomprimio mas que el limite");
+	if(original >= 0)
+		tocar(salida, original);
+
+	// Ida y vuelta: lo que se comprime se tiene que descomprimir igual
+	if(size > 0 && size <= limites.frame_maximo) {
+		void* comprimido;
+		int tamanio = compresor_comprimir(compresor, datos, size, &comprimido);
+		void* vuelta;
+		if(tamanio >= 0 && (descompresor_descomprimir(descompresor, comprimido, tamanio, &vuelta) != (int) size
+			|| memcmp(vuelta, datos, size) != 0))
+			fuzz_fallar("lo comprimido no se descomprime igual");
+	}
+	return original >= 0;
+}
+
+static size_t semilla_descompresor(uint8_t* destino)
+{
+	// Texto repetitivo (comprime bien): asi el compresor casi siempre achica
+	static t_compresor* compresor = NULL;
+	if(compresor == NULL)
+		compresor = compresor_crear(COMPRESION_NIVEL_DEFECTO);
+	uint8_t texto[4096];
+	int largo = fuzz_aleatorio() % sizeof(texto);
+	for(int i = 0; i < largo; i++)
+		texto[i] = "hola mundo "[fuzz_aleatorio() % 4 == 0 ? fuzz_aleatorio() % 11 : i % 11];
+
+	void* comprimido;
+	int tamanio = compresor_comprimir(compresor, texto, largo, &comprimido);
+	if(tamanio == -1) { // no achico: se prueba el texto tal cual
+		memcpy(destino, texto, largo);
+		return largo;
+	}
+	memcpy(destino, comprimido, tamanio);
+	return tamanio;
+}
+
+static int probar_lector(const uint8_t* datos, size_t size)
+{
+	if(size < 2)
+		return 0;
+	// Chico: que tenga que crecer durante la prueba
+	t_lector* lector = lector_crear(64);
+	lector->version = version_de(datos[0]);
+	int frames = 0;
+	int estado = 0;
+
+	// El flujo llega de a pedazos de distinto tamanio (el segundo byte los varia), como en varios recv()
+	size_t desplazamiento = 2;
+	while(desplazamiento < size && estado != -1) {
+		size_t pedazo = 1 + (datos[1] * (desplazamiento + 1)) % FUZZ_PEDAZO_MAXIMO;
+		if(pedazo > size - desplazamiento)
+			pedazo = size - desplazamiento;
+		lector_agregar(lector, datos + desplazamiento, pedazo);
+		desplazamiento += pedazo;
+
+		t_encabezado encabezado;
+		void* payload;
+		while((estado = lector_siguiente_frame(lector, &encabezado, &payload)) == 1 || estado == LECTOR_FRAME_DESCARTADO) {
+			if(estado == LECTOR_FRAME_DESCARTADO) {
+				if(encabezado.size <= limites.frame_maximo)
+					fuzz_fallar("se descarto un frame que entraba en el limite");
+				continue;
+			}
+			if(encabezado.size > limites.frame_maximo)
+				fuzz_fallar("se entrego un frame mas grande que el limite");
+			tocar(payload, encabezado.size);
+			if(encabezado.cod_op == PAQUETE || encabezado.cod_op == PUT) {
+				t_paquete_vista* vista = paquete_vista_crear(payload, encabezado.size, lector->version, false);
+				if(vista != NULL) {
+					paquete_vista_iterar(vista, tocar_elemento);
+					paquete_vista_destruir(vista);
+				}
+			}
+			frames++;
+		}
+		// La memoria del lector la acotan los limites, no el size que diga un encabezado
+		if((size_t) lector->capacidad > 4 * ((size_t) limites.frame_maximo + PROTOCOLO_ENCABEZADO_MAXIMO + FUZZ_PEDAZO_MAXIMO))
+			fuzz_fallar("el lector crecio mas que el limite de frame");
+	}
+	lector_destruir(lector);
+	return estado != -1 && frames > 0;
+}
+
+static size_t semilla_lector(uint8_t* destino)
+{
+	destino[0] = fuzz_aleatorio();
+	destino[1] = fuzz_aleatorio();
+	int version = version_de(destino[0]);
+	size_t escritos = 2;
+	int frames = 1 + fuzz_aleatorio() % 16;
+	uint8_t payload[1024];
+	for(int i = 0; i < frames; i++) {
+		int cod_op = fuzz_aleatorio() % (PUBLICACION + 1);
+		size_t size;
+		if(cod_op == PAQUETE || cod_op == PUT)
+			size = paquete_al_azar(version, payload, sizeof(payload));
+		else {
+			size = fuzz_aleatorio() % sizeof(payload);
+			for(size_t j = 0; j < size; j++)
+				payload[j] = fuzz_aleatorio();
+		}
+		if(escritos + PROTOCOLO_ENCABEZADO_MAXIMO + size > FUZZ_ENTRADA_MAXIMA)
+			break;
+		if(version == PROTOCOLO_VERSION_2 && fuzz_aleatorio() % 2)
+			escritos += protocolo_codificar_encabezado_id(version, destino + escritos, cod_op, 0, size, fuzz_aleatorio());
+		else
+			escritos += protocolo_codificar_encabezado(version, destino + escritos, cod_op, 0, size);
+		memcpy(destino + escritos, payload, size);
+		escritos += size;
+	}
+	return escritos;
+}
+
+t_objetivo objetivos[] = {
+	{ "encabezado", probar_encabezado, semilla_encabezado },
+	{ "elementos", probar_elementos, semilla_elementos },
+	{ "descompresor", probar_descompresor, semilla_descompresor },
+	{ "lector", probar_lector, semilla_lector },
+	{ NULL, NULL, NULL }
+};
+
+t_objetivo* buscar_objetivo(const char* nombre)
+{
+	for(t_objetivo* objetivo = objetivos; objetivo->nombre != NULL; objetivo++)
+		if(strcmp(objetivo->nombre, nombre) == 0)
+			return objetivo;
+	return NULL;
+}
@@ -0,0 +1,10 @@
+# Libraries
+LIBS=
+
+# Custom libraries' paths
+SHARED_LIBPATHS=
+STATIC_LIBPATHS=
+
+# Compiler flags
+CDEBUG=-g -Wall -D_GNU_SOURCE -DDEBUG -fdiagnostics-color=always
+CRELEASE=-O3 -Wall -D_GNU_SOURCE -DNDEBUG
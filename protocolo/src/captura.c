@@ -0,0 +1,90 @@
+/**
+ * @file captura.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del formato de los archivos de captura de trafico
+ *
+ * El archivo se mapea de solo lectura y con MADV_SEQUENTIAL: el kernel lee por adelantado
+ * y el replay va a la velocidad del disco sin pasar cada frame por read() y un buffer propio.
+ */
+
+#include "captura.h"
+
+void captura_codificar_cabecera(uint8_t* destino, uint64_t inicio)
+{
+	memcpy(destino, CAPTURA_MAGIA, 4);
+	escribir_u32_le(destino + 4, CAPTURA_FORMATO);
+	escribir_u64_le(destino + 8, inicio);
+}
+
+void captura_codificar_registro(uint8_t* destino, int cod_op, int version, uint64_t instante, uint32_t size)
+{
+	escribir_u32_le(destino, size);
+	destino[4] = cod_op;
+	destino[5] = version;
+	destino[6] = 0;
+	destino[7] = 0;
+	escribir_u64_le(destino + 8, instante);
+}
+
+t_captura* captura_abrir(const char* ruta)
+{
+	int fd = open(ruta, O_RDONLY);
+	if(fd == -1)
+		return NULL;
+	struct stat estado;
+	if(fstat(fd, &estado) == -1 || estado.st_size < CAPTURA_CABECERA) {
+		close(fd);
+		return NULL;
+	}
+
+	void* datos = mmap(NULL, estado.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // el mapeo sigue valido sin el fd
+	if(datos == MAP_FAILED)
+		return NULL;
+	if(memcmp(datos, CAPTURA_MAGIA, 4) != 0 || leer_u32_le((uint8_t*) datos + 4) != CAPTURA_FORMATO) {
+		munmap(datos, estado.st_size);
+		return NULL;
+	}
+	madvise(datos, estado.st_size, MADV_SEQUENTIAL);
+
+	t_captura* captura = malloc(sizeof(t_captura));
+	captura->datos = datos;
+	captura->tamanio = estado.st_size;
+	captura->posicion = CAPTURA_CABECERA;
+	captura->inicio = leer_u64_le(captura->datos + 8);
+	return captura;
+}
+
+int captura_siguiente(t_captura* captura, t_frame_capturado* frame)
+{
+	size_t restantes = captura->tamanio - captura->posicion;
+	if(restantes == 0)
+		return 0;
+	if(restantes < CAPTURA_ENCABEZADO)
+		return -1;
+
+	const uint8_t* registro = captura->datos + captura->posicion;
+	uint32_t size = leer_u32_le(registro);
+	if(size > restantes - CAPTURA_ENCABEZADO)
+		return -1;
+
+	frame->cod_op = registro[4];
+	frame->version = registro[5];
+	frame->instante = leer_u64_le(registro + 8);
+	frame->payload = registro + CAPTURA_ENCABEZADO;
+	frame->size = size;
+	captura->posicion += CAPTURA_ENCABEZADO + size;
+	return 1;
+}
+
+void captura_reiniciar(t_captura* captura)
+{
+	captura->posicion = CAPTURA_CABECERA;
+}
+
+void captura_cerrar(t_captura* captura)
+{
+	munmap((void*) captura->datos, captura->tamanio);
+	free(captura);
+}
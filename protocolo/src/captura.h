@@ -0,0 +1,105 @@
+/**
+ * @file captura.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del formato de los archivos de captura de trafico
+ *
+ * Una captura guarda los frames tal como los recibio el servidor (despues de separarlos y descomprimirlos),
+ * para poder reproducir trafico real con el replay. Formato (enteros little endian):
+ * - Cabecera del archivo: | 'T' 'P' 'C' 'A' | uint32 formato | uint64 inicio (ns desde 1970) |
+ * - Cada registro: | uint32 size | uint8 cod_op | uint8 version | uint16 reservado | uint64 instante (ns desde inicio) | payload |
+ * version es la de la conexion por la que llego: el payload de un PAQUETE v1 y uno v2 no tienen el mismo formato.
+ *
+ * El lector mapea el archivo completo con mmap(): cada frame que devuelve apunta dentro del mapeo, sin copias.
+ * @see https://man7.org/linux/man-pages/man2/mmap.2.html
+ */
+
+#ifndef CAPTURA_H_
+#define CAPTURA_H_
+
+// Librerias standard de C
+#include<stdlib.h> // malloc, free
+#include<stdint.h> // uint8_t, uint64_t
+#include<stddef.h> // size_t
+
+// Librerias standard de POSIX/Linux
+#include<fcntl.h> // open
+#include<unistd.h> // close
+#include<sys/mman.h> // mmap, madvise
+#include<sys/stat.h> // fstat
+
+// Inclusión del protocolo (enteros little endian)
+#include "protocolo.h"
+
+/* Primeros bytes de todo archivo de captura */
+#define CAPTURA_MAGIA "TPCA"
+
+/* Version del formato de archivo (no confundir con la version de protocolo de cada frame) */
+#define CAPTURA_FORMATO 1
+
+/* Bytes de la cabecera del archivo y del encabezado de cada registro */
+#define CAPTURA_CABECERA 16
+#define CAPTURA_ENCABEZADO 16
+
+/**
+ * @brief Un frame leido de una captura
+ */
+typedef struct
+{
+	int cod_op; /**< codigo de operacion */
+	int version; /**< version de protocolo de la conexion por la que llego */
+	uint64_t instante; /**< ns desde el inicio de la captura */
+	const void* payload; /**< apunta dentro del archivo mapeado (valido hasta captura_cerrar()) */
+	uint32_t size; /**< tamanio del payload */
+} t_frame_capturado;
+
+/**
+ * @brief Archivo de captura mapeado en memoria
+ */
+typedef struct
+{
+	const uint8_t* datos; /**< archivo completo */
+	size_t tamanio; /**< bytes del archivo */
+	size_t posicion; /**< proximo registro a leer */
+	uint64_t inicio; /**< ns desde 1970 en que empezo la captura */
+} t_captura;
+
+/**
+ * @brief Escribe la cabecera de un archivo de captura
+ * @param destino CAPTURA_CABECERA bytes
+ * @param inicio ns desde 1970 (CLOCK_REALTIME) en que empieza la captura
+ */
+void captura_codificar_cabecera(uint8_t* destino, uint64_t inicio);
+
+/**
+ * @brief Escribe el encabezado de un registro (el payload va a continuacion)
+ * @param destino CAPTURA_ENCABEZADO bytes
+ */
+void captura_codificar_registro(uint8_t* destino, int cod_op, int version, uint64_t instante, uint32_t size);
+
+/**
+ * @brief Mapea un archivo de captura para leerlo
+ * @param ruta archivo escrito con captura_codificar_cabecera() + registros
+ * @return la captura posicionada en el primer frame, o NULL si no se pudo abrir o no es una captura
+ */
+t_captura* captura_abrir(const char* ruta);
+
+/**
+ * @brief Devuelve el siguiente frame, sin copiarlo
+ * @param captura captura abierta
+ * @param frame donde guardar el frame (su payload apunta dentro del mapeo)
+ * @return 1 si habia un frame, 0 si se llego al final, -1 si el ultimo registro esta cortado (ej. el servidor murio escribiendolo)
+ */
+int captura_siguiente(t_captura* captura, t_frame_capturado* frame);
+
+/**
+ * @brief Vuelve al primer frame (para reproducir la captura varias veces)
+ */
+void captura_reiniciar(t_captura* captura);
+
+/**
+ * @brief Desmapea el archivo y libera la captura
+ */
+void captura_cerrar(t_captura* captura);
+
+#endif /* CAPTURA_H_ */
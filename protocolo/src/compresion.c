@@ -0,0 +1,102 @@
+/**
+ * @file compresion.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de la compresion de payloads del protocolo v2
+ *
+ * Cada payload se comprime o descomprime de una sola pasada (Z_FINISH) sobre un buffer de salida
+ * que ya tiene el tamanio justo: deflateBound() al comprimir y el tamanio original al descomprimir.
+ */
+
+#include "compresion.h"
+
+/**
+ * @brief Deja al menos @p necesarios bytes en el buffer de salida
+ */
+static void asegurar_salida(uint8_t** salida, int* capacidad, int necesarios)
+{
+	if(*capacidad >= necesarios)
+		return;
+	*salida = realloc(*salida, necesarios);
+	*capacidad = necesarios;
+}
+
+t_compresor* compresor_crear(int nivel)
+{
+	t_compresor* compresor = calloc(1, sizeof(t_compresor));
+	// windowBits negativo: deflate crudo, sin los 6 bytes de encabezado y adler32 de zlib
+	if(deflateInit2(&compresor->flujo, nivel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		free(compresor);
+		return NULL;
+	}
+	return compresor;
+}
+
+int compresor_comprimir(t_compresor* compresor, const void* datos, int size, void** salida)
+{
+	int prefijo = varint_tamanio(size);
+	int maximo = prefijo + deflateBound(&compresor->flujo, size);
+	asegurar_salida(&compresor->salida, &compresor->capacidad, maximo);
+
+	varint_codificar(size, compresor->salida);
+	deflateReset(&compresor->flujo);
+	compresor->flujo.next_in = (Bytef*) datos;
+	compresor->flujo.avail_in = size;
+	compresor->flujo.next_out = compresor->salida + prefijo;
+	compresor->flujo.avail_out = maximo - prefijo;
+	if(deflate(&compresor->flujo, Z_FINISH) != Z_STREAM_END)
+		return -1;
+
+	int comprimido = prefijo + compresor->flujo.total_out;
+	if(comprimido >= size)
+		return -1; // no achico (ej. datos al azar): mejor enviarlo tal cual
+	*salida = compresor->salida;
+	return comprimido;
+}
+
+void compresor_destruir(t_compresor* compresor)
+{
+	deflateEnd(&compresor->flujo);
+	free(compresor->salida);
+	free(compresor);
+}
+
+t_descompresor* descompresor_crear(uint32_t maximo)
+{
+	t_descompresor* descompresor = calloc(1, sizeof(t_descompresor));
+	if(inflateInit2(&descompresor->flujo, -MAX_WBITS) != Z_OK) {
+		free(descompresor);
+		return NULL;
+	}
+	descompresor->maximo = maximo < COMPRESION_TAMANIO_MAXIMO ? maximo : COMPRESION_TAMANIO_MAXIMO;
+	return descompresor;
+}
+
+int descompresor_descomprimir(t_descompresor* descompresor, const void* datos, int size, void** salida)
+{
+	uint32_t original;
+	int prefijo = varint_decodificar(datos, size, &original);
+	if(prefijo <= 0 || original > descompresor->maximo)
+		return -1;
+	asegurar_salida(&descompresor->salida, &descompresor->capacidad, original > 0 ? original : 1);
+
+	inflateReset(&descompresor->flujo);
+	descompresor->flujo.next_in = (Bytef*) datos + prefijo;
+	descompresor->flujo.avail_in = size - prefijo;
+	descompresor->flujo.next_out = descompresor->salida;
+	descompresor->flujo.avail_out = original;
+	// Tiene que terminar justo al llenar el tamanio anunciado: ni mas (se cortaria) ni menos
+	if(inflate(&descompresor->flujo, Z_FINISH) != Z_STREAM_END || descompresor->flujo.total_out != original
+		|| descompresor->flujo.avail_in != 0)
+		return -1;
+
+	*salida = descompresor->salida;
+	return original;
+}
+
+void descompresor_destruir(t_descompresor* descompresor)
+{
+	inflateEnd(&descompresor->flujo);
+	free(descompresor->salida);
+	free(descompresor);
+}
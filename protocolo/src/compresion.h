@@ -0,0 +1,98 @@
+/**
+ * @file compresion.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de la compresion de payloads del protocolo v2
+ *
+ * Un frame con PROTOCOLO_FLAG_COMPRIMIDO lleva como payload | varint tamanio original | deflate crudo |.
+ * Se usa deflate (zlib) sin encabezado ni checksum propios: TCP ya verifica los datos.
+ * Compresor y descompresor guardan su z_stream y su buffer de salida entre frames,
+ * asi comprimir un frame no reserva memoria (salvo que llegue uno mas grande que todos los anteriores).
+ * @see https://www.zlib.net/manual.html
+ */
+
+#ifndef COMPRESION_H_
+#define COMPRESION_H_
+
+// Librerias standard de C
+#include<stdlib.h> // malloc, realloc, free
+#include<stdbool.h> // bool
+
+// zlib (deflate/inflate)
+#include<zlib.h>
+
+// Inclusión del protocolo (flags, varints)
+#include "protocolo.h"
+
+/* Tamanio original maximo que se acepta descomprimir (un frame chico no puede pedir gigas de memoria) */
+#define COMPRESION_TAMANIO_MAXIMO (64 * 1024 * 1024)
+
+/* Nivel por defecto: el mas rapido (las lineas de texto repetidas ya comprimen bien asi) */
+#define COMPRESION_NIVEL_DEFECTO 1
+
+/**
+ * @brief Estado reutilizable para comprimir payloads
+ */
+typedef struct
+{
+	z_stream flujo; /**< estado de deflate (se reinicia en cada frame) */
+	uint8_t* salida; /**< payload comprimido del ultimo frame */
+	int capacidad; /**< bytes reservados en salida */
+} t_compresor;
+
+/**
+ * @brief Estado reutilizable para descomprimir payloads
+ */
+typedef struct
+{
+	z_stream flujo; /**< estado de inflate (se reinicia en cada frame) */
+	uint8_t* salida; /**< payload descomprimido del ultimo frame */
+	int capacidad; /**< bytes reservados en salida */
+	uint32_t maximo; /**< tamanio original mas grande que se acepta */
+} t_descompresor;
+
+/**
+ * @brief Crea un compresor
+ * @param nivel nivel de deflate (1 = mas rapido ... 9 = mas chico)
+ * @return el compresor, o NULL si zlib no pudo inicializarse
+ */
+t_compresor* compresor_crear(int nivel);
+
+/**
+ * @brief Comprime un payload
+ * @param compresor compresor de la conexion
+ * @param datos payload original
+ * @param size tamanio del payload
+ * @param salida donde guardar el puntero al payload comprimido (apunta dentro del compresor, valido hasta el proximo uso)
+ * @return tamanio del payload comprimido, o -1 si no achica (conviene enviarlo sin comprimir)
+ */
+int compresor_comprimir(t_compresor* compresor, const void* datos, int size, void** salida);
+
+/**
+ * @brief Libera el compresor
+ */
+void compresor_destruir(t_compresor* compresor);
+
+/**
+ * @brief Crea un descompresor
+ * @param maximo tamanio original mas grande que se acepta (ej. t_limites_protocolo.frame_maximo), hasta COMPRESION_TAMANIO_MAXIMO
+ * @return el descompresor, o NULL si zlib no pudo inicializarse
+ */
+t_descompresor* descompresor_crear(uint32_t maximo);
+
+/**
+ * @brief Descomprime un payload con PROTOCOLO_FLAG_COMPRIMIDO
+ * @param descompresor descompresor de la conexion
+ * @param datos payload recibido (| varint tamanio original | deflate |)
+ * @param size tamanio del payload recibido
+ * @param salida donde guardar el puntero al payload original (apunta dentro del descompresor, valido hasta el proximo uso)
+ * @return tamanio del payload original, o -1 si el payload es invalido o supera el maximo del descompresor
+ */
+int descompresor_descomprimir(t_descompresor* descompresor, const void* datos, int size, void** salida);
+
+/**
+ * @brief Libera el descompresor
+ */
+void descompresor_destruir(t_descompresor* descompresor);
+
+#endif /* COMPRESION_H_ */
@@ -0,0 +1,269 @@
+/**
+ * @file protocolo.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del protocolo compartido entre cliente y servidor
+ *
+ * Solo codifica y decodifica bytes: no hace I/O, asi lo pueden usar el cliente, el servidor
+ * (epoll, io_uring o bloqueante) y el bench por igual. La excepcion es protocolo_conectar(), que comparten
+ * las herramientas que se conectan al servidor.
+ */
+
+#include "protocolo.h"
+
+int varint_codificar(uint32_t valor, uint8_t* destino)
+{
+	int escritos = 0;
+	while(valor >= 0x80) {
+		destino[escritos++] = (valor & 0x7F) | 0x80; // 7 bits + "sigue otro byte"
+		valor >>= 7;
+	}
+	destino[escritos++] = valor;
+	return escritos;
+}
+
+int varint_tamanio(uint32_t valor)
+{
+	int tamanio = 1;
+	while(valor >= 0x80) {
+		valor >>= 7;
+		tamanio++;
+	}
+	return tamanio;
+}
+
+int varint_decodificar(const uint8_t* origen, int disponibles, uint32_t* valor)
+{
+	uint32_t resultado = 0;
+	for(int i = 0; i < VARINT_MAXIMO; i++) {
+		if(i >= disponibles)
+			return 0;
+		resultado |= (uint32_t) (origen[i] & 0x7F) << (7 * i);
+		if(!(origen[i] & 0x80)) {
+			*valor = resultado;
+			return i + 1;
+		}
+	}
+	return -1; // 5 bytes y todavia dice que sigue: no es un uint32
+}
+
+void escribir_u32_le(uint8_t* destino, uint32_t valor)
+{
+	destino[0] = valor;
+	destino[1] = valor >> 8;
+	destino[2] = valor >> 16;
+	destino[3] = valor >> 24;
+}
+
+uint32_t leer_u32_le(const uint8_t* origen)
+{
+	return (uint32_t) origen[0] | (uint32_t) origen[1] << 8 | (uint32_t) origen[2] << 16 | (uint32_t) origen[3] << 24;
+}
+
+void escribir_u64_le(uint8_t* destino, uint64_t valor)
+{
+	escribir_u32_le(destino, valor);
+	escribir_u32_le(destino + 4, valor >> 32);
+}
+
+uint64_t leer_u64_le(const uint8_t* origen)
+{
+	return (uint64_t) leer_u32_le(origen) | (uint64_t) leer_u32_le(origen + 4) << 32;
+}
+
+void protocolo_codificar_handshake(uint8_t* destino, uint8_t version, uint8_t capacidades)
+{
+	destino[0] = PROTOCOLO_MAGIA;
+	destino[1] = 'T';
+	destino[2] = 'P';
+	destino[3] = (capacidades << 4) | (version & 0x0F);
+}
+
+int protocolo_decodificar_handshake(const uint8_t* origen, uint8_t* capacidades)
+{
+	if(origen[0] != PROTOCOLO_MAGIA || origen[1] != 'T' || origen[2] != 'P')
+		return -1;
+	if(capacidades != NULL)
+		*capacidades = origen[3] >> 4;
+	return origen[3] & 0x0F;
+}
+
+int protocolo_conectar(char* ip, char* puerto, int version, uint8_t capacidades)
+{
+	struct addrinfo hints;
+	struct addrinfo* server_info;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if(getaddrinfo(ip, puerto, &hints, &server_info) != 0)
+		return -1;
+
+	int socket_cliente = socket(server_info->ai_family, server_info->ai_socktype, server_info->ai_protocol);
+	if(socket_cliente != -1 && connect(socket_cliente, server_info->ai_addr, server_info->ai_addrlen) == -1) {
+		close(socket_cliente);
+		socket_cliente = -1;
+	}
+	freeaddrinfo(server_info);
+	if(socket_cliente == -1 || version == PROTOCOLO_VERSION_1)
+		return socket_cliente;
+
+	uint8_t handshake[PROTOCOLO_TAMANIO_HANDSHAKE];
+	uint8_t aceptadas = 0;
+	protocolo_codificar_handshake(handshake, version, capacidades);
+	if(send(socket_cliente, handshake, sizeof(handshake), MSG_NOSIGNAL) != sizeof(handshake)
+		|| recv(socket_cliente, handshake, sizeof(handshake), MSG_WAITALL) != sizeof(handshake)
+		|| protocolo_decodificar_handshake(handshake, &aceptadas) != version || (aceptadas & capacidades) != capacidades) {
+		close(socket_cliente);
+		return -1;
+	}
+	return socket_cliente;
+}
+
+int protocolo_codificar_encabezado(int version, uint8_t* destino, int cod_op, uint8_t flags, uint32_t size)
+{
+	if(version == PROTOCOLO_VERSION_1) {
+		int encabezado[2] = { cod_op, size };
+		memcpy(destino, encabezado, sizeof(encabezado));
+		return sizeof(encabezado);
+	}
+
+	destino[0] = PROTOCOLO_MAGIA;
+	destino[1] = (version << 4) | (flags & 0x0F & ~PROTOCOLO_FLAG_ID);
+	destino[2] = cod_op;
+	return 3 + varint_codificar(size, destino + 3);
+}
+
+int protocolo_codificar_encabezado_id(int version, uint8_t* destino, int cod_op, uint8_t flags, uint32_t size, uint32_t id)
+{
+	int bytes = protocolo_codificar_encabezado(version, destino, cod_op, flags, size);
+	destino[1] |= PROTOCOLO_FLAG_ID;
+	return bytes + varint_codificar(id, destino + bytes);
+}
+
+int protocolo_decodificar_encabezado(int version, const uint8_t* origen, int disponibles, t_encabezado* encabezado)
+{
+	encabezado->encabezado = 0;
+	if(version == PROTOCOLO_VERSION_1) {
+		if(disponibles < (int) PROTOCOLO_ENCABEZADO_V1)
+			return 0;
+		int campos[2];
+		memcpy(campos, origen, sizeof(campos));
+		if(campos[1] < 0)
+			return -1; // un tamanio negativo solo puede ser basura
+		encabezado->cod_op = campos[0];
+		encabezado->flags = 0;
+		encabezado->size = campos[1];
+		encabezado->id = 0;
+		encabezado->encabezado = PROTOCOLO_ENCABEZADO_V1;
+		return 1;
+	}
+
+	if(disponibles < 1)
+		return 0;
+	if(origen[0] != PROTOCOLO_MAGIA)
+		return -1; // se perdio la sincronizacion con el cliente
+	if(disponibles < 3)
+		return 0;
+	if((origen[1] >> 4) != version)
+		return -1;
+
+	uint32_t size;
+	int bytes_size = varint_decodificar(origen + 3, disponibles - 3, &size);
+	if(bytes_size <= 0)
+		return bytes_size;
+
+	encabezado->cod_op = origen[2];
+	encabezado->flags = origen[1] & 0x0F;
+	encabezado->size = size;
+	encabezado->id = 0;
+	int bytes_id = 0;
+	if(encabezado->flags & PROTOCOLO_FLAG_ID) {
+		bytes_id = varint_decodificar(origen + 3 + bytes_size, disponibles - 3 - bytes_size, &encabezado->id);
+		if(bytes_id <= 0)
+			return bytes_id;
+	}
+	encabezado->encabezado = 3 + bytes_size + bytes_id;
+	return 1;
+}
+
+int protocolo_codificar_elemento(int version, uint8_t* destino, uint32_t tamanio)
+{
+	if(version == PROTOCOLO_VERSION_1) {
+		int tamanio_v1 = tamanio;
+		memcpy(destino, &tamanio_v1, sizeof(int));
+		return sizeof(int);
+	}
+	return varint_codificar(tamanio, destino);
+}
+
+int protocolo_decodificar_elemento(int version, const uint8_t* origen, int disponibles, uint32_t* tamanio)
+{
+	if(version == PROTOCOLO_VERSION_1) {
+		if(disponibles < (int) sizeof(int))
+			return -1;
+		int tamanio_v1;
+		memcpy(&tamanio_v1, origen, sizeof(int));
+		if(tamanio_v1 < 0)
+			return -1;
+		*tamanio = tamanio_v1;
+		return sizeof(int);
+	}
+	int bytes = varint_decodificar(origen, disponibles, tamanio);
+	return bytes > 0 ? bytes : -1;
+}
+
+int protocolo_contar_elementos(int version, const void* payload, int size, uint32_t maximo)
+{
+	const uint8_t* cursor = payload;
+	int desplazamiento = 0;
+	uint32_t cantidad = 0;
+	uint32_t tamanio;
+
+	while(desplazamiento < size) {
+		if(cantidad == maximo)
+			return -1; // cada elemento vacio ocupa un byte en v2: sin tope, un frame grande serian millones
+		int prefijo = protocolo_decodificar_elemento(version, cursor + desplazamiento, size - desplazamiento, &tamanio);
+		if(prefijo == -1 || tamanio > (uint32_t) (size - desplazamiento - prefijo))
+			return -1; // el elemento dice ser mas grande que lo que queda
+		desplazamiento += prefijo + tamanio;
+		cantidad++;
+	}
+	return cantidad;
+}
+
+int protocolo_tamanio_paquete_v2(const void* stream_v1, int size)
+{
+	const uint8_t* cursor = stream_v1;
+	int desplazamiento = 0;
+	int total = 0;
+	uint32_t tamanio;
+
+	while(desplazamiento < size) {
+		int prefijo = protocolo_decodificar_elemento(PROTOCOLO_VERSION_1, cursor + desplazamiento, size - desplazamiento, &tamanio);
+		if(prefijo == -1 || tamanio > (uint32_t) (size - desplazamiento - prefijo))
+			return -1;
+		desplazamiento += prefijo + tamanio;
+		total += varint_tamanio(tamanio) + tamanio;
+	}
+	return total;
+}
+
+int protocolo_paquete_v1_a_v2(const void* stream_v1, int size, uint8_t* destino)
+{
+	const uint8_t* cursor = stream_v1;
+	int desplazamiento = 0;
+	int escritos = 0;
+	uint32_t tamanio;
+
+	while(desplazamiento < size) {
+		int prefijo = protocolo_decodificar_elemento(PROTOCOLO_VERSION_1, cursor + desplazamiento, size - desplazamiento, &tamanio);
+		if(prefijo <= 0 || tamanio > (uint32_t) (size - desplazamiento - prefijo))
+			return -1; // no se copia con un tamanio sin leer ni mas alla del payload
+		desplazamiento += prefijo;
+		escritos += varint_codificar(tamanio, destino + escritos);
+		memcpy(destino + escritos, cursor + desplazamiento, tamanio);
+		escritos += tamanio;
+		desplazamiento += tamanio;
+	}
+	return escritos;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file protocolo.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del protocolo compartido entre cliente y servidor
+ *
+ * Antes cada proyecto tenia su copia de op_code y el formato de los frames era implicito
+ * (ints en el endianness de cada maquina). Aca se definen, en un unico lugar:
+ * - v1 (legacy): | int cod_op | int size | payload |, elementos de PAQUETE: | int tamanio | datos |
+ * - v2: | magia | version<<4 | flags | cod_op | varint size | [varint id] | payload |, elementos de PAQUETE: | varint tamanio | datos |
+ *   El id (con PROTOCOLO_FLAG_ID) identifica la solicitud: el servidor contesta con el mismo id (RESPUESTA o ACK),
+ *   asi un cliente puede tener muchas solicitudes en vuelo en la misma conexion y emparejar cada respuesta por id,
+ *   sin depender del orden en que lleguen.
+ * Control de flujo (PROTOCOLO_CAPACIDAD_CREDITOS): el cliente arranca con PROTOCOLO_CREDITO_INICIAL bytes de credito
+ * para los frames sin id, y solo puede enviar un frame si su credito es positivo (cada frame resta lo que ocupa en el cable).
+ * El servidor devuelve credito con CREDITO a medida que procesa esos frames, asi que un cliente rapido
+ * espera al ritmo del servidor en lugar de llenar sus buffers (los frames con id ya se regulan con la ventana de solicitudes).
+ * Publicacion/suscripcion (solo v2): con SUSCRIBIR un cliente pasa a recibir, como PUBLICACION, cada MENSAJE o
+ * PAQUETE que otro cliente mande con PUBLICAR a ese topico. Un suscriptor lento pierde publicaciones en lugar de frenar
+ * al que publica ni a los demas suscriptores.
+ * La version se negocia con el handshake (handshake_cliente()/handshake_servidor()).
+ * Una conexion que no arranca con el handshake se atiende como v1, asi los clientes viejos siguen andando.
+ * @see https://protobuf.dev/programming-guides/encoding/#varints
+ */
+
+#ifndef PROTOCOLO_H_
+#define PROTOCOLO_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint8_t, uint32_t: tipos de tamanio fijo en el cable
+#include<string.h> // memcpy
+
+// Librerias standard de POSIX/Linux
+#include<unistd.h> // close
+#include<sys/socket.h> // socket, connect, send, recv
+#include<netdb.h> // getaddrinfo
+
+/* Primer byte del handshake y de cada frame v2. Un frame v1 empieza con el byte bajo de su cod_op (int little-endian):
+ * no hay ambiguedad mientras los cod_op que mandan los clientes v1 queden por debajo de 0x7E (ver op_code) */
+#define PROTOCOLO_MAGIA 0x7E
+
+#define PROTOCOLO_VERSION_1 1
+#define PROTOCOLO_VERSION_2 2
+/* Version mas nueva que entiende este codigo */
+#define PROTOCOLO_VERSION_MAXIMA PROTOCOLO_VERSION_2
+
+/* Handshake: | magia | 'T' | 'P' | capacidades<<4 | version |. El cliente manda la version maxima que entiende y las
+ * capacidades que quiere usar; el servidor contesta la version elegida (0 = rechazado) y las capacidades que acepta */
+#define PROTOCOLO_TAMANIO_HANDSHAKE 4
+
+/* Capacidades opcionales (nibble alto del ultimo byte del handshake) */
+#define PROTOCOLO_CAPACIDAD_COMPRESION 0x01 /**< frames con PROTOCOLO_FLAG_COMPRIMIDO (ver compresion.h) */
+#define PROTOCOLO_CAPACIDAD_IDS 0x02 /**< frames con PROTOCOLO_FLAG_ID, confirmados con ACK o RESPUESTA */
+#define PROTOCOLO_CAPACIDAD_CREDITOS 0x04 /**< control de flujo de los frames sin id con CREDITO */
+/* Capacidades que implementa este codigo */
+#define PROTOCOLO_CAPACIDADES_SOPORTADAS (PROTOCOLO_CAPACIDAD_COMPRESION | PROTOCOLO_CAPACIDAD_IDS | PROTOCOLO_CAPACIDAD_CREDITOS)
+
+/* Credito con el que arranca una conexion con PROTOCOLO_CAPACIDAD_CREDITOS (bytes de frames sin id en el cable) */
+#define PROTOCOLO_CREDITO_INICIAL (256 * 1024)
+
+/* Flags de frame (v2, nibble bajo del segundo byte del encabezado) */
+#define PROTOCOLO_FLAG_COMPRIMIDO 0x01 /**< el payload es | varint tamanio original | deflate | */
+#define PROTOCOLO_FLAG_ID 0x02 /**< despues del size viene el varint id de la solicitud */
+
+/* Encabezado v1: dos int. Encabezado v2: magia + version/flags + cod_op + varint size + varint id (hasta 5 bytes cada uno) */
+#define PROTOCOLO_ENCABEZADO_V1 (2 * sizeof(int))
+#define PROTOCOLO_ENCABEZADO_MAXIMO 13
+
+/* Un varint de 32 bits ocupa como mucho 5 bytes (7 bits utiles por byte) */
+#define VARINT_MAXIMO 5
+
+/* Limites por defecto de lo que se acepta decodificar de un par (ver t_limites_protocolo) */
+#define PROTOCOLO_FRAME_MAXIMO (16 * 1024 * 1024)
+#define PROTOCOLO_ELEMENTOS_MAXIMO 65536
+
+/**
+ * @brief Define los tipos de operación que pueden ser enviados a través del socket
+ * 
+ * Permite saber qué tipo de contenido está llegando en una conexión, y así tomar decisiones distintas según el valor.
+ * En v2 viaja en un byte: no puede superar 255. Los que puede mandar un cliente v1 tienen que quedar por debajo de
+ * PROTOCOLO_MAGIA: un primer frame v1 con 0x7E en el byte bajo del cod_op (126, 382...) se tomaria como handshake.
+ */
+typedef enum
+{
+	MENSAJE, /**< mensajes simples (string) [por defecto es 0]*/
+	PAQUETE, /**< otro tipo de contenido más complejo [por defecto 1]*/
+	PUT, /**< guarda clave -> valor en el servidor: payload con dos elementos como los de PAQUETE, | clave | valor | */
+	GET, /**< pide el valor de una clave: payload = la clave. El servidor contesta RESPUESTA */
+	EXISTS, /**< pregunta si una clave existe: payload = la clave. El servidor contesta RESPUESTA */
+	RESPUESTA, /**< servidor -> cliente: | uint8 estado (PROTOCOLO_ENCONTRADO o PROTOCOLO_NO_ENCONTRADO) | valor (solo en GET) | */
+	ACK, /**< servidor -> cliente: confirma una solicitud con id que no tiene RESPUESTA. Payload: | uint8 (PROTOCOLO_ACK_OK o PROTOCOLO_ACK_ERROR) | */
+	CREDITO, /**< servidor -> cliente, sin id: | varint bytes | que se suman al credito del cliente */
+	SUSCRIBIR, /**< recibir lo que se publique en un topico: payload = el topico */
+	DESUSCRIBIR, /**< dejar de recibir un topico: payload = el topico */
+	PUBLICAR, /**< | varint largo topico | topico | uint8 cod_op (MENSAJE o PAQUETE) | payload de ese frame | */
+	PUBLICACION /**< servidor -> suscriptores, sin id: el mismo payload del PUBLICAR que la origino */
+} op_code;
+
+/* Primer byte del payload de una RESPUESTA */
+#define PROTOCOLO_NO_ENCONTRADO 0
+#define PROTOCOLO_ENCONTRADO 1
+
+/* Payload de un ACK */
+#define PROTOCOLO_ACK_OK 0
+#define PROTOCOLO_ACK_ERROR 1 /**< el frame estaba mal formado o el cod_op es desconocido */
+
+/**
+ * @brief Encabezado de un frame ya decodificado (cualquier version)
+ */
+typedef struct
+{
+	int cod_op; /**< codigo de operacion */
+	uint8_t flags; /**< flags del frame (siempre 0 en v1) */
+	uint32_t size; /**< tamanio del payload */
+	uint32_t id; /**< id de la solicitud (solo si flags tiene PROTOCOLO_FLAG_ID) */
+	int encabezado; /**< bytes que ocupa el encabezado en el cable (0 si todavia no llego completo) */
+} t_encabezado;
+
+/**
+ * @brief Limites de lo que se acepta de un par: un frame corrupto (o malicioso) no puede pedir mas memoria que esto
+ */
+typedef struct
+{
+	uint32_t frame_maximo; /**< bytes de payload de un frame (y de su payload descomprimido) */
+	uint32_t elementos_maximo; /**< elementos de un PAQUETE (o PUT) */
+} t_limites_protocolo;
+
+/**
+ * @brief Escribe un entero sin signo en formato varint (7 bits por byte, el bit alto indica que sigue otro byte)
+ * @param valor entero a codificar
+ * @param destino donde escribir (al menos VARINT_MAXIMO bytes)
+ * @return cantidad de bytes escritos (1 a 5)
+ */
+int varint_codificar(uint32_t valor, uint8_t* destino);
+
+/**
+ * @brief Cantidad de bytes que ocuparia @p valor como varint
+ */
+int varint_tamanio(uint32_t valor);
+
+/**
+ * @brief Lee un varint
+ * @param origen bytes recibidos
+ * @param disponibles cantidad de bytes que se pueden leer
+ * @param valor donde guardar el entero
+ * @return bytes consumidos, 0 si faltan bytes, -1 si es invalido (mas de 5 bytes)
+ */
+int varint_decodificar(const uint8_t* origen, int disponibles, uint32_t* valor);
+
+/**
+ * @brief Escribe/lee enteros de 32 bits en little-endian, sin importar el endianness de la maquina
+ */
+void escribir_u32_le(uint8_t* destino, uint32_t valor);
+uint32_t leer_u32_le(const uint8_t* origen);
+
+/**
+ * @brief Escribe/lee enteros de 64 bits en little-endian (ej. instantes en ns de las capturas)
+ */
+void escribir_u64_le(uint8_t* destino, uint64_t valor);
+uint64_t leer_u64_le(const uint8_t* origen);
+
+/**
+ * @brief Arma el handshake (o su respuesta) con la version indicada
+ * @param destino PROTOCOLO_TAMANIO_HANDSHAKE bytes
+ * @param version version ofrecida (cliente) o elegida (servidor, 0 = rechazado), hasta 15
+ * @param capacidades PROTOCOLO_CAPACIDAD_* pedidas (cliente) o aceptadas (servidor)
+ */
+void protocolo_codificar_handshake(uint8_t* destino, uint8_t version, uint8_t capacidades);
+
+/**
+ * @brief Valida un handshake (o su respuesta)
+ * @param origen PROTOCOLO_TAMANIO_HANDSHAKE bytes recibidos
+ * @param capacidades si no es NULL, donde guardar las capacidades que trae
+ * @return la version que trae, o -1 si no es un handshake
+ */
+int protocolo_decodificar_handshake(const uint8_t* origen, uint8_t* capacidades);
+
+/**
+ * @brief Abre una conexion TCP bloqueante y, si @p version es mayor a 1, hace el handshake pidiendo esa version
+ * @param capacidades PROTOCOLO_CAPACIDAD_* que se piden (el servidor tiene que aceptarlas todas)
+ * @return fd del socket conectado, o -1 si fallo la conexion, el servidor eligio otra version o no acepto las capacidades
+ * @note Para las herramientas (bench, replay) que necesitan justo esa version; el cliente negocia con handshake_cliente()
+ */
+int protocolo_conectar(char* ip, char* puerto, int version, uint8_t capacidades);
+
+/**
+ * @brief Escribe el encabezado de un frame
+ * @param version PROTOCOLO_VERSION_1 o PROTOCOLO_VERSION_2
+ * @param destino al menos PROTOCOLO_ENCABEZADO_MAXIMO bytes
+ * @param cod_op codigo de operacion
+ * @param flags flags del frame (se ignoran en v1)
+ * @param size tamanio del payload que sigue
+ * @return bytes escritos
+ */
+int protocolo_codificar_encabezado(int version, uint8_t* destino, int cod_op, uint8_t flags, uint32_t size);
+
+/**
+ * @brief Igual que protocolo_codificar_encabezado(), pero con el id de la solicitud (agrega PROTOCOLO_FLAG_ID)
+ * @pre version >= PROTOCOLO_VERSION_2 y PROTOCOLO_CAPACIDAD_IDS acordada en el handshake
+ */
+int protocolo_codificar_encabezado_id(int version, uint8_t* destino, int cod_op, uint8_t flags, uint32_t size, uint32_t id);
+
+/**
+ * @brief Lee el encabezado de un frame
+ * @param version version negociada en la conexion
+ * @param origen bytes recibidos
+ * @param disponibles cantidad de bytes recibidos
+ * @param encabezado donde guardar el resultado
+ * @return 1 si el encabezado esta completo, 0 si faltan bytes, -1 si es invalido (magia o version incorrecta)
+ * @note Con 1 no implica que el payload haya llegado: eso es encabezado->encabezado + encabezado->size <= disponibles
+ */
+int protocolo_decodificar_encabezado(int version, const uint8_t* origen, int disponibles, t_encabezado* encabezado);
+
+/**
+ * @brief Escribe el prefijo de tamanio de un elemento de PAQUETE
+ * @return bytes escritos (sizeof(int) en v1, 1 a 5 en v2)
+ */
+int protocolo_codificar_elemento(int version, uint8_t* destino, uint32_t tamanio);
+
+/**
+ * @brief Lee el prefijo de tamanio de un elemento de PAQUETE
+ * @param version version del paquete
+ * @param origen bytes del payload desde el elemento
+ * @param disponibles bytes que quedan en el payload
+ * @param tamanio donde guardar el tamanio del elemento
+ * @return bytes del prefijo, o -1 si esta cortado o es invalido
+ */
+int protocolo_decodificar_elemento(int version, const uint8_t* origen, int disponibles, uint32_t* tamanio);
+
+/**
+ * @brief Cuenta los elementos de un payload de PAQUETE verificando cada prefijo de tamanio
+ * @param version version del paquete
+ * @param payload payload recibido (| tamanio | datos | ...)
+ * @param size bytes del payload
+ * @param maximo elementos que se aceptan como mucho (ej. t_limites_protocolo.elementos_maximo)
+ * @return cantidad de elementos, o -1 si algun elemento se sale del payload o hay mas de @p maximo
+ * @note Es la unica validacion que hace falta antes de recorrer los elementos: despues ningun tamanio puede salirse
+ */
+int protocolo_contar_elementos(int version, const void* payload, int size, uint32_t maximo);
+
+/**
+ * @brief Tamanio que tendria en v2 un payload de PAQUETE armado en v1 (como lo arma agregar_a_paquete())
+ * @return bytes, o -1 si el payload v1 esta mal formado
+ */
+int protocolo_tamanio_paquete_v2(const void* stream_v1, int size);
+
+/**
+ * @brief Copia un payload de PAQUETE v1 a v2, cambiando cada int de tamanio por un varint
+ * @param destino al menos protocolo_tamanio_paquete_v2() bytes
+ * @return bytes escritos, o -1 si el payload v1 esta mal formado
+ * @pre protocolo_tamanio_paquete_v2() ya valido el payload (no devolvio -1)
+ */
+int protocolo_paquete_v1_a_v2(const void* stream_v1, int size, uint8_t* destino);
+
+#endif /* PROTOCOLO_H_ */
@@ -0,0 +1,171 @@
+/**
+ * @file traza.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de las trazas del camino caliente
+ *
+ * Cada anillo lo escribe un solo hilo: primero el evento y despues, con un store release, la cantidad de escritos.
+ * El que vuelca copia el anillo y vuelve a leer la cantidad: los eventos que se pudieron pisar mientras copiaba
+ * (los mas viejos) se descartan en lugar de escribirse a medias.
+ */
+
+#include "traza.h"
+
+/**
+ * @brief Anillo de eventos de un hilo
+ */
+typedef struct
+{
+	t_evento_traza eventos[TRAZA_EVENTOS]; /**< el evento i va en eventos[i % TRAZA_EVENTOS] */
+	uint64_t escritos; /**< eventos registrados desde que se creo (solo crece) */
+	int tid; /**< id del hilo en el sistema (el tid de Chrome trace) */
+	char nombre[16]; /**< nombre del hilo (pthread_getname_np) */
+} t_anillo_traza;
+
+bool traza_activa = false;
+
+/* Anillos de cada hilo que registro algo (se recorren al volcar) */
+static t_anillo_traza* anillos[TRAZA_HILOS_MAXIMO];
+static int cantidad_anillos = 0;
+
+/* Anillo del hilo actual (NULL hasta su primer evento) */
+static __thread t_anillo_traza* anillo_hilo = NULL;
+
+static char* archivo = NULL;
+
+/* Un solo volcado a la vez (la señal puede llegar mientras el cliente vuelca al terminar) */
+static pthread_mutex_t volcando = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Reserva y registra el anillo del hilo actual
+ * @return el anillo, o NULL si ya hay TRAZA_HILOS_MAXIMO hilos
+ */
+static t_anillo_traza* registrar_hilo(void)
+{
+	int indice = __atomic_fetch_add(&cantidad_anillos, 1, __ATOMIC_RELAXED);
+	if(indice >= TRAZA_HILOS_MAXIMO)
+		return NULL;
+	t_anillo_traza* anillo = malloc(sizeof(t_anillo_traza));
+	anillo->escritos = 0;
+	anillo->tid = syscall(SYS_gettid);
+	if(pthread_getname_np(pthread_self(), anillo->nombre, sizeof(anillo->nombre)) != 0)
+		anillo->nombre[0] = '\0';
+	__atomic_store_n(&anillos[indice], anillo, __ATOMIC_RELEASE);
+	return anillo;
+}
+
+void traza_registrar(uint64_t inicio, const char* nombre)
+{
+	if(inicio == 0)
+		return;
+	t_anillo_traza* anillo = anillo_hilo;
+	if(anillo == NULL && (anillo = anillo_hilo = registrar_hilo()) == NULL)
+		return;
+	t_evento_traza* evento = &anillo->eventos[anillo->escritos & (TRAZA_EVENTOS - 1)];
+	evento->nombre = nombre;
+	evento->inicio = inicio;
+	evento->duracion = traza_instante() - inicio;
+	__atomic_store_n(&anillo->escritos, anillo->escritos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Escribe los eventos que siguen en el anillo de un hilo
+ * @return eventos escritos
+ */
+static int volcar_anillo(FILE* salida, t_anillo_traza* anillo, t_evento_traza* copia, bool* primero)
+{
+	uint64_t hasta = __atomic_load_n(&anillo->escritos, __ATOMIC_ACQUIRE);
+	uint64_t desde = hasta > TRAZA_EVENTOS ? hasta - TRAZA_EVENTOS : 0;
+	for(uint64_t i = desde; i < hasta; i++)
+		copia[i - desde] = anillo->eventos[i & (TRAZA_EVENTOS - 1)];
+	// Lo que el hilo escribio mientras se copiaba piso a los mas viejos: esos pueden estar a medias.
+	// Tambien el lugar del evento numero despues, que el hilo puede estar escribiendo justo ahora
+	uint64_t despues = __atomic_load_n(&anillo->escritos, __ATOMIC_ACQUIRE);
+	uint64_t validos = despues + 1 > TRAZA_EVENTOS ? despues + 1 - TRAZA_EVENTOS : 0;
+
+	fprintf(salida, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+		*primero ? "" : ",", getpid(), anillo->tid, anillo->nombre);
+	*primero = false;
+	int escritos = 0;
+	for(uint64_t i = desde > validos ? desde : validos; i < hasta; i++) {
+		t_evento_traza* evento = &copia[i - desde];
+		// ts y dur van en microsegundos: con 3 decimales no se pierden los ns
+		fprintf(salida, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%lu.%03lu,\"dur\":%lu.%03lu}",
+			evento->nombre, getpid(), anillo->tid, evento->inicio / 1000, evento->inicio % 1000,
+			evento->duracion / 1000, evento->duracion % 1000);
+		escritos++;
+	}
+	return escritos;
+}
+
+int traza_volcar(void)
+{
+	if(archivo == NULL)
+		return -1;
+	pthread_mutex_lock(&volcando);
+	FILE* salida = fopen(archivo, "w");
+	if(salida == NULL) {
+		pthread_mutex_unlock(&volcando);
+		return -1;
+	}
+	t_evento_traza* copia = malloc(TRAZA_EVENTOS * sizeof(t_evento_traza));
+	int cantidad = __atomic_load_n(&cantidad_anillos, __ATOMIC_RELAXED);
+	if(cantidad > TRAZA_HILOS_MAXIMO)
+		cantidad = TRAZA_HILOS_MAXIMO;
+
+	int escritos = 0;
+	bool primero = true;
+	fprintf(salida, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	for(int i = 0; i < cantidad; i++) {
+		t_anillo_traza* anillo = __atomic_load_n(&anillos[i], __ATOMIC_ACQUIRE);
+		if(anillo != NULL) // registrado pero todavia sin publicar: no tiene eventos
+			escritos += volcar_anillo(salida, anillo, copia, &primero);
+	}
+	fprintf(salida, "\n]}\n");
+
+	free(copia);
+	int error = fclose(salida);
+	pthread_mutex_unlock(&volcando);
+	return error == 0 ? escritos : -1;
+}
+
+/**
+ * @brief Hilo que vuelca las trazas cada vez que llega la señal de traza_iniciar()
+ */
+static void* esperar_senial(void* arg)
+{
+	sigset_t seniales = *(sigset_t*) arg;
+	free(arg);
+	int senial;
+	while(sigwait(&seniales, &senial) == 0) {
+		int escritos = traza_volcar();
+		if(escritos == -1)
+			fprintf(stderr, "No se pudieron volcar las trazas en %s\n", archivo);
+		else
+			fprintf(stderr, "%d eventos de traza volcados en %s\n", escritos, archivo);
+	}
+	return NULL;
+}
+
+bool traza_iniciar(const char* ruta, int senial)
+{
+	if(archivo != NULL)
+		return false;
+	archivo = strdup(ruta);
+	if(senial != 0) {
+		sigset_t* seniales = malloc(sizeof(sigset_t));
+		sigemptyset(seniales);
+		sigaddset(seniales, senial);
+		pthread_sigmask(SIG_BLOCK, seniales, NULL); // la heredan los hilos que se creen despues: solo la atiende sigwait()
+		pthread_t hilo;
+		if(pthread_create(&hilo, NULL, esperar_senial, seniales) != 0) {
+			free(seniales);
+			free(archivo);
+			archivo = NULL;
+			return false;
+		}
+		pthread_detach(hilo);
+	}
+	traza_activa = true;
+	return true;
+}
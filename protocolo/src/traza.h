@@ -0,0 +1,102 @@
+/**
+ * @file traza.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de las trazas del camino caliente (servidor y cliente)
+ *
+ * Cada tramo (recv, malloc del buffer, list_add, log, send...) se marca con TRAZA_INICIO()/TRAZA_FIN() y queda
+ * como un evento | nombre | inicio | duracion | en un anillo del hilo que lo ejecuto: sin locks, y cuando el anillo
+ * se llena se pisan los mas viejos. traza_volcar() escribe lo que haya en formato JSON de Chrome trace
+ * (se abre con chrome://tracing o https://ui.perfetto.dev), un hilo por fila.
+ *
+ * Las marcas solo existen si se compila con -DTRAZAS (el target debug de los makefile): en release las macros
+ * no generan ni una instruccion. Compiladas, igual no miden nada hasta traza_iniciar() (clave TRAZA_ARCHIVO
+ * de servidor.config y cliente.config); mientras tanto cada marca es leer un bool.
+ * @see https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU (Trace Event Format)
+ */
+
+#ifndef TRAZA_H_
+#define TRAZA_H_
+
+// Librerias standard de C
+#include<stdio.h> // fopen, fprintf
+#include<stdlib.h> // malloc, free
+#include<string.h> // strdup, memcpy
+#include<stdint.h> // uint64_t
+#include<stdbool.h> // bool
+#include<time.h> // clock_gettime
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilo que vuelca con una señal, nombre de cada hilo
+#include<signal.h> // sigwait
+#include<unistd.h> // getpid
+#include<sys/syscall.h> // SYS_gettid
+
+/* Eventos del anillo de cada hilo (potencia de 2): 64K eventos son 1.5 MB por hilo que traza */
+#define TRAZA_EVENTOS (64 * 1024)
+
+/* Hilos que pueden trazar como mucho (los demas no registran nada) */
+#define TRAZA_HILOS_MAXIMO 256
+
+#ifdef TRAZAS
+/* Empieza un tramo: declara la variable @p tramo con el instante actual */
+#define TRAZA_INICIO(tramo) uint64_t tramo = traza_instante()
+/* Termina el tramo empezado con TRAZA_INICIO(@p tramo) y lo registra como @p nombre (un literal: se guarda el puntero) */
+#define TRAZA_FIN(tramo, nombre) traza_registrar(tramo, nombre)
+#else
+#define TRAZA_INICIO(tramo)
+#define TRAZA_FIN(tramo, nombre) ((void) 0)
+#endif
+
+/**
+ * @brief Un tramo medido
+ */
+typedef struct
+{
+	const char* nombre; /**< literal con el nombre del tramo */
+	uint64_t inicio; /**< ns de CLOCK_MONOTONIC */
+	uint64_t duracion; /**< ns */
+} t_evento_traza;
+
+// Declaracion de variable global
+extern bool traza_activa;
+
+/**
+ * @brief Activa las trazas
+ * @param ruta archivo donde traza_volcar() escribe el JSON
+ * @param senial si no es 0, un hilo propio vuelca cada vez que llega esta señal (ej. SIGUSR1, para el servidor
+ * que no termina); la señal queda bloqueada en el hilo que llama y en los que cree despues
+ * @return true si se activaron
+ * @note Hay que llamarla antes de crear los demas hilos, para que hereden la señal bloqueada
+ */
+bool traza_iniciar(const char* ruta, int senial);
+
+/**
+ * @brief Instante actual en ns
+ * @return el instante, o 0 si las trazas no estan activas (asi no se paga el clock_gettime())
+ */
+static inline uint64_t traza_instante(void)
+{
+	if(!traza_activa)
+		return 0;
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+}
+
+/**
+ * @brief Registra en el anillo del hilo el tramo que empezo en @p inicio y termina ahora
+ * @param inicio traza_instante() del comienzo (0: no se registra)
+ * @param nombre literal con el nombre del tramo
+ * @note La primera vez que un hilo registra se le reserva su anillo
+ */
+void traza_registrar(uint64_t inicio, const char* nombre);
+
+/**
+ * @brief Escribe los eventos de todos los hilos en el archivo de traza_iniciar(), en formato JSON de Chrome trace
+ * @return eventos escritos, o -1 si no se pudo escribir el archivo
+ * @note Los hilos siguen registrando mientras tanto: se descartan los eventos que se pisaron durante la copia
+ */
+int traza_volcar(void);
+
+#endif /* TRAZA_H_ */
@@ -0,0 +1,275 @@
+/**
+ * @file replay.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del replay de capturas de trafico
+ *
+ * Los frames se leen del archivo mapeado y se envian tal cual, solo se vuelve a codificar el encabezado
+ * del protocolo (la captura guarda el payload ya separado y descomprimido).
+ * Uso: bin/replay [-i ip] [-p puerto] [-l] [-r] [-n vueltas] captura.cap [captura.cap ...]
+ */
+
+#include "replay.h"
+
+static uint64_t ahora_ns(void)
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+}
+
+static void uso(char* programa)
+{
+	fprintf(stderr, "Uso: %s [-i ip] [-p puerto] [-l] [-r] [-n vueltas] captura.cap [captura.cap ...]\n"
+		"       -l: solo parsear los frames, sin enviarlos\n"
+		"       -r: respetar los tiempos entre frames de la captura\n", programa);
+}
+
+int leer_parametros(int argc, char** argv, t_parametros* parametros)
+{
+	// Valores por defecto: el servidor local de server/src/utils.h
+	parametros->ip = "127.0.0.1";
+	parametros->puerto = "4444";
+	parametros->local = false;
+	parametros->ritmo = false;
+	parametros->vueltas = 1;
+
+	int opcion;
+	while((opcion = getopt(argc, argv, "i:p:lrn:")) != -1) {
+		switch(opcion) {
+		case 'i': parametros->ip = optarg; break;
+		case 'p': parametros->puerto = optarg; break;
+		case 'l': parametros->local = true; break;
+		case 'r': parametros->ritmo = true; break;
+		case 'n': parametros->vueltas = atoi(optarg); break;
+		default: return -1;
+		}
+	}
+
+	parametros->archivos = argv + optind;
+	parametros->cantidad_archivos = argc - optind;
+	if(parametros->cantidad_archivos < 1 || parametros->vueltas < 1)
+		return -1;
+	return 0;
+}
+
+int parsear_frame(t_frame_capturado* frame, t_resultado* resultado)
+{
+	// Encabezado: se codifica como llego por el cable y se vuelve a leer como lo hace el lector del servidor
+	uint8_t bytes[PROTOCOLO_ENCABEZADO_MAXIMO];
+	int tamanio = protocolo_codificar_encabezado(frame->version, bytes, frame->cod_op, 0, frame->size);
+	t_encabezado encabezado;
+	if(protocolo_decodificar_encabezado(frame->version, bytes, tamanio, &encabezado) != 1
+		|| encabezado.cod_op != frame->cod_op || encabezado.size != frame->size)
+		return -1;
+	resultado->bytes += tamanio + frame->size;
+
+	if(frame->size > PROTOCOLO_FRAME_MAXIMO)
+		return -1; // el servidor lo descartaria sin procesarlo
+
+	if(frame->cod_op != PAQUETE)
+		return 0;
+	// Misma validacion que paquete_vista_crear() en el servidor, con los limites por defecto
+	int elementos = protocolo_contar_elementos(frame->version, frame->payload, frame->size, PROTOCOLO_ELEMENTOS_MAXIMO);
+	if(elementos == -1)
+		return -1;
+	resultado->elementos += elementos;
+	return 0;
+}
+
+/**
+ * @brief Lee y descarta todo lo que ya haya mandado el servidor, sin bloquear
+ * @return 0 si no queda nada para leer, -1 si fallo la conexion o el servidor la cerro
+ */
+static int descartar_respuestas(t_destino* destino)
+{
+	uint8_t descarte[65536];
+	while(1) {
+		ssize_t leidos = recv(destino->socket, descarte, sizeof(descarte), 0);
+		if(leidos > 0)
+			destino->respuestas += leidos;
+		else if(leidos == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return 0;
+		else if(leidos == 0 || errno != EINTR)
+			return -1;
+	}
+}
+
+int enviar_lote(t_destino* destino)
+{
+	struct msghdr mensaje;
+	memset(&mensaje, 0, sizeof(mensaje));
+	mensaje.msg_iov = destino->iov;
+	mensaje.msg_iovlen = 2 * destino->frames;
+
+	while(mensaje.msg_iovlen > 0) {
+		ssize_t enviados = sendmsg(destino->socket, &mensaje, MSG_NOSIGNAL);
+		if(enviados == -1) {
+			if(errno == EINTR)
+				continue;
+			if(errno != EAGAIN && errno != EWOULDBLOCK)
+				return -1;
+			// Socket lleno: puede ser que el servidor este esperando que se lean sus respuestas para seguir leyendo
+			struct pollfd espera = { .fd = destino->socket, .events = POLLIN | POLLOUT };
+			if((poll(&espera, 1, -1) == -1 && errno != EINTR) || descartar_respuestas(destino) == -1)
+				return -1;
+			continue;
+		}
+		// Envio parcial: se saltean los iovec completos y se ajusta el primero que quedo a medias
+		while(mensaje.msg_iovlen > 0 && (size_t) enviados >= mensaje.msg_iov->iov_len) {
+			enviados -= mensaje.msg_iov->iov_len;
+			mensaje.msg_iov++;
+			mensaje.msg_iovlen--;
+		}
+		if(mensaje.msg_iovlen > 0) {
+			mensaje.msg_iov->iov_base = (char*) mensaje.msg_iov->iov_base + enviados;
+			mensaje.msg_iov->iov_len -= enviados;
+		}
+	}
+	destino->frames = 0;
+	return descartar_respuestas(destino);
+}
+
+int encolar_frame(t_destino* destino, t_frame_capturado* frame, t_resultado* resultado)
+{
+	uint8_t* encabezado = destino->encabezados[destino->frames];
+	int tamanio = protocolo_codificar_encabezado(destino->version, encabezado, frame->cod_op, 0, frame->size);
+	destino->iov[2 * destino->frames].iov_base = encabezado;
+	destino->iov[2 * destino->frames].iov_len = tamanio;
+	destino->iov[2 * destino->frames + 1].iov_base = (void*) frame->payload; // apunta al archivo mapeado
+	destino->iov[2 * destino->frames + 1].iov_len = frame->size;
+	destino->frames++;
+	resultado->bytes += tamanio + frame->size;
+
+	if(destino->frames == REPLAY_LOTE)
+		return enviar_lote(destino);
+	return 0;
+}
+
+/**
+ * @brief Cierra el lado de envio de @p destino y descarta respuestas hasta que el servidor cierre el suyo
+ * @note Asi la duracion incluye procesar todo lo enviado: cerrar con datos sin leer haria que el servidor los descarte
+ */
+static void terminar(t_destino* destino)
+{
+	shutdown(destino->socket, SHUT_WR);
+	struct pollfd espera = { .fd = destino->socket, .events = POLLIN };
+	while((poll(&espera, 1, -1) != -1 || errno == EINTR) && descartar_respuestas(destino) == 0);
+	close(destino->socket);
+}
+
+/**
+ * @brief Espera hasta que, contando desde @p comienzo, pase el @p instante del frame
+ */
+static void esperar_instante(uint64_t comienzo, uint64_t instante)
+{
+	uint64_t objetivo = comienzo + instante;
+	struct timespec hasta = { .tv_sec = objetivo / 1000000000ULL, .tv_nsec = objetivo % 1000000000ULL };
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &hasta, NULL) == EINTR);
+}
+
+/**
+ * @brief Reproduce una vuelta completa de @p captura
+ * @param destinos una conexion por version de protocolo (indice = version), se abren a medida que hacen falta
+ * @return 0 si todo bien, -1 si fallo una conexion con el servidor
+ */
+static int reproducir(t_parametros* parametros, t_captura* captura, t_destino* destinos, t_resultado* resultado)
+{
+	uint64_t comienzo = ahora_ns();
+	uint64_t primer_instante = 0; // los tiempos se cuentan desde el primer frame, no desde que arranco el servidor
+	bool primero = true;
+	t_frame_capturado frame;
+	int leido;
+	while((leido = captura_siguiente(captura, &frame)) == 1) {
+		if(frame.version < PROTOCOLO_VERSION_1 || frame.version > PROTOCOLO_VERSION_MAXIMA) {
+			resultado->invalidos++;
+			continue;
+		}
+		resultado->frames++;
+		if(primero) {
+			primer_instante = frame.instante;
+			primero = false;
+		}
+
+		if(parametros->local) {
+			if(parsear_frame(&frame, resultado) == -1)
+				resultado->invalidos++;
+			continue;
+		}
+
+		t_destino* destino = &destinos[frame.version];
+		if(destino->socket == -1) {
+			if((destino->socket = protocolo_conectar(parametros->ip, parametros->puerto, frame.version, 0)) == -1) {
+				fprintf(stderr, "No se pudo conectar a %s:%s con protocolo v%d\n", parametros->ip, parametros->puerto, frame.version);
+				return -1;
+			}
+			fcntl(destino->socket, F_SETFL, fcntl(destino->socket, F_GETFL) | O_NONBLOCK); // ver enviar_lote()
+		}
+		if(parametros->ritmo) {
+			// Lo ya encolado sale antes de dormir: si no, el ritmo se mediria por lotes y no por frame
+			for(int version = PROTOCOLO_VERSION_1; version <= PROTOCOLO_VERSION_MAXIMA; version++)
+				if(destinos[version].frames > 0 && enviar_lote(&destinos[version]) == -1)
+					return -1;
+			esperar_instante(comienzo, frame.instante - primer_instante);
+		}
+		if(encolar_frame(destino, &frame, resultado) == -1)
+			return -1;
+	}
+	if(leido == -1)
+		fprintf(stderr, "La captura termina con un registro cortado: se ignora\n");
+
+	for(int version = PROTOCOLO_VERSION_1; version <= PROTOCOLO_VERSION_MAXIMA; version++)
+		if(destinos[version].frames > 0 && enviar_lote(&destinos[version]) == -1)
+			return -1;
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	t_parametros parametros;
+	if(leer_parametros(argc, argv, &parametros) == -1) {
+		uso(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	t_destino* destinos = calloc(PROTOCOLO_VERSION_MAXIMA + 1, sizeof(t_destino));
+	for(int version = 0; version <= PROTOCOLO_VERSION_MAXIMA; version++) {
+		destinos[version].socket = -1;
+		destinos[version].version = version;
+	}
+
+	t_resultado resultado;
+	memset(&resultado, 0, sizeof(resultado));
+	int estado = EXIT_SUCCESS;
+	uint64_t inicio = ahora_ns();
+	for(int i = 0; i < parametros.cantidad_archivos && estado == EXIT_SUCCESS; i++) {
+		t_captura* captura = captura_abrir(parametros.archivos[i]);
+		if(captura == NULL) {
+			fprintf(stderr, "%s no es una captura valida\n", parametros.archivos[i]);
+			estado = EXIT_FAILURE;
+			break;
+		}
+		for(int vuelta = 0; vuelta < parametros.vueltas && estado == EXIT_SUCCESS; vuelta++) {
+			captura_reiniciar(captura);
+			if(reproducir(&parametros, captura, destinos, &resultado) == -1)
+				estado = EXIT_FAILURE;
+		}
+		captura_cerrar(captura);
+	}
+	uint64_t respuestas = 0;
+	for(int version = 0; version <= PROTOCOLO_VERSION_MAXIMA; version++) {
+		if(destinos[version].socket != -1)
+			terminar(&destinos[version]);
+		respuestas += destinos[version].respuestas;
+	}
+	free(destinos);
+	double segundos = (ahora_ns() - inicio) / 1e9;
+
+	printf("modo: %s  capturas: %d  vueltas: %d  duracion: %.2f s\n", parametros.local ? "local" : "socket",
+		parametros.cantidad_archivos, parametros.vueltas, segundos);
+	printf("frames: %lu  invalidos: %lu  elementos de PAQUETE: %lu\n", resultado.frames, resultado.invalidos, resultado.elementos);
+	printf("throughput: %.0f frames/s  %.2f MB/s\n", resultado.frames / segundos, resultado.bytes / segundos / (1024 * 1024));
+	if(!parametros.local)
+		printf("respuestas del servidor (descartadas): %lu bytes\n", respuestas);
+	return estado;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file replay.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del replay de capturas de trafico
+ *
+ * Reproduce los frames de una o varias capturas (grabadas por el servidor con CAPTURA_ARCHIVO, ver captura.h):
+ * - contra un servidor: abre una conexion por version de protocolo que aparezca en la captura y
+ *   le envia los frames con sendmsg() (scatter-gather), apuntando directo al archivo mapeado (sin copiar los payloads).
+ *   Las respuestas (RESPUESTA de GET y EXISTS) se leen y se descartan: si se acumulan, el servidor pausa la conexion;
+ * - en modo local (-l): pasa cada frame por el mismo parseo que recibir_operacion()/recibir_paquete(),
+ *   sin sockets, para medir el parseo o verificar que una captura sigue siendo valida.
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+// Librerias standard de C
+#include<stdio.h> // printf, fprintf
+#include<stdlib.h> // malloc, free, atoi
+#include<string.h> // memset
+#include<stdbool.h> // bool
+#include<stdint.h> // uint64_t
+#include<time.h> // clock_gettime, clock_nanosleep
+#include<errno.h> // errno
+
+// Librerias standard de POSIX/Linux
+#include<unistd.h> // getopt, close
+#include<sys/socket.h> // sendmsg, recv, shutdown
+#include<sys/uio.h> // struct iovec
+#include<fcntl.h> // O_NONBLOCK
+#include<poll.h> // esperar a poder enviar o a que lleguen respuestas
+
+// Protocolo compartido con el cliente y el servidor (encabezados, handshake, capturas)
+#include<protocolo.h>
+#include<captura.h>
+
+/* Frames que se juntan como mucho en un sendmsg() (dos iovec por frame: encabezado y payload) */
+#define REPLAY_LOTE 512
+
+/**
+ * @brief Parametros del replay (ver uso() en replay.c)
+ */
+typedef struct
+{
+	char* ip; /**< IP del servidor */
+	char* puerto; /**< puerto del servidor */
+	bool local; /**< solo parsear, sin enviar */
+	bool ritmo; /**< respetar los tiempos entre frames de la captura (si no, a toda velocidad) */
+	int vueltas; /**< veces que se reproduce cada captura */
+	char** archivos; /**< capturas a reproducir */
+	int cantidad_archivos; /**< cantidad de capturas */
+} t_parametros;
+
+/**
+ * @brief Conexion con el servidor para los frames de una version de protocolo, con su lote pendiente
+ */
+typedef struct
+{
+	int socket; /**< fd conectado (-1 si todavia no se abrio o fallo) */
+	int version; /**< version negociada */
+	struct iovec iov[2 * REPLAY_LOTE]; /**< encabezado y payload de cada frame del lote */
+	uint8_t encabezados[REPLAY_LOTE][PROTOCOLO_ENCABEZADO_MAXIMO]; /**< encabezados ya codificados */
+	int frames; /**< frames en el lote */
+	uint64_t respuestas; /**< bytes que mando el servidor (se descartan) */
+} t_destino;
+
+/**
+ * @brief Resultados del replay
+ */
+typedef struct
+{
+	uint64_t frames; /**< frames reproducidos */
+	uint64_t bytes; /**< bytes de los frames (encabezado del protocolo + payload) */
+	uint64_t elementos; /**< elementos de PAQUETE recorridos (modo local) */
+	uint64_t invalidos; /**< frames que no se pudieron parsear o de una version desconocida */
+} t_resultado;
+
+/**
+ * @brief Lee los parametros de la linea de comandos
+ * @return 0 si son validos, -1 si hay que mostrar el uso
+ */
+int leer_parametros(int argc, char** argv, t_parametros* parametros);
+
+/**
+ * @brief Parsea un frame igual que el servidor: encabezado y, si es PAQUETE, cada elemento
+ * @return 0 si es valido, -1 si no
+ */
+int parsear_frame(t_frame_capturado* frame, t_resultado* resultado);
+
+/**
+ * @brief Agrega un frame al lote de @p destino, enviando el lote si se lleno
+ * @return 0 si todo bien, -1 si fallo la conexion
+ */
+int encolar_frame(t_destino* destino, t_frame_capturado* frame, t_resultado* resultado);
+
+/**
+ * @brief Envia todo el lote pendiente de @p destino con sendmsg(), reintentando envios parciales
+ * @return 0 si se envio, -1 si fallo la conexion
+ * @note El socket es no bloqueante: mientras no haya lugar para enviar se descartan las respuestas que lleguen,
+ * porque el servidor deja de leer a un cliente que no lee lo que le contesta (CONEXION_SALIDA_ALTA)
+ */
+int enviar_lote(t_destino* destino);
+
+#endif /* REPLAY_H_ */
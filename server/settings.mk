@@ -1,10 +1,10 @@
 # Libraries
-LIBS=commons pthread readline m
+LIBS=protocolo commons pthread readline m z dl
 
 # Custom libraries' paths
 SHARED_LIBPATHS=
-STATIC_LIBPATHS=
+STATIC_LIBPATHS=../protocolo
 
 # Compiler flags
-CDEBUG=-g -Wall -DDEBUG -fdiagnostics-color=always
-CRELEASE=-O3 -Wall -DNDEBUG
+CDEBUG=-g -Wall -D_GNU_SOURCE -DDEBUG -DTRAZAS -fdiagnostics-color=always -rdynamic
+CRELEASE=-O3 -Wall -D_GNU_SOURCE -DNDEBUG -rdynamic
@@ -0,0 +1,250 @@
+/**
+ * @file almacen.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del almacen clave/valor en memoria del servidor
+ *
+ * Los bits altos del hash eligen la parte y los bajos la posicion dentro de su indice,
+ * asi las claves de una misma parte siguen bien repartidas en su tabla.
+ */
+
+#include "almacen.h"
+
+t_almacen* almacen;
+
+/* Bytes del encabezado de cada registro de la arena: | largo clave | largo valor | capacidad valor | */
+#define ALMACEN_ENCABEZADO (3 * sizeof(uint32_t))
+
+/**
+ * @brief FNV-1a de 64 bits con una mezcla final (los bits altos de FNV solos reparten mal entre las partes)
+ * @return hash distinto de 0 (0 marca las entradas libres)
+ */
+static uint64_t calcular_hash(const uint8_t* clave, int largo)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(int i = 0; i < largo; i++) {
+		hash ^= clave[i];
+		hash *= 0x100000001b3ULL;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return hash != 0 ? hash : 1;
+}
+
+static uint32_t leer_campo(const uint8_t* registro, int campo)
+{
+	uint32_t valor;
+	memcpy(&valor, registro + campo * sizeof(uint32_t), sizeof(uint32_t));
+	return valor;
+}
+
+static void escribir_campo(uint8_t* registro, int campo, uint32_t valor)
+{
+	memcpy(registro + campo * sizeof(uint32_t), &valor, sizeof(uint32_t));
+}
+
+/**
+ * @brief Bytes que ocupa en la arena un registro de @p largo_clave con lugar para @p capacidad_valor
+ */
+static size_t tamanio_registro(uint32_t largo_clave, uint32_t capacidad_valor)
+{
+	return (ALMACEN_ENCABEZADO + largo_clave + capacidad_valor + 7) & ~(size_t) 7; // registros alineados a 8 bytes
+}
+
+/**
+ * @brief Reserva @p bytes (ya alineados, ver tamanio_registro()) en la arena de la parte, abriendo un bloque nuevo si no entran
+ */
+static uint8_t* reservar_en_arena(t_parte_almacen* parte, size_t bytes)
+{
+	if(parte->bloque == NULL || parte->bloque->usado + bytes > parte->bloque->capacidad) {
+		size_t capacidad = bytes > ALMACEN_BLOQUE ? bytes : ALMACEN_BLOQUE;
+		t_bloque_almacen* bloque = malloc(sizeof(t_bloque_almacen) + capacidad);
+		bloque->anterior = parte->bloque;
+		bloque->usado = 0;
+		bloque->capacidad = capacidad;
+		parte->bloque = bloque;
+	}
+	uint8_t* reservado = parte->bloque->datos + parte->bloque->usado;
+	parte->bloque->usado += bytes;
+	parte->arena += bytes;
+	return reservado;
+}
+
+static void liberar_bloques(t_bloque_almacen* bloque)
+{
+	while(bloque != NULL) {
+		t_bloque_almacen* anterior = bloque->anterior;
+		free(bloque);
+		bloque = anterior;
+	}
+}
+
+/**
+ * @brief Copia los registros vivos a bloques nuevos y libera los viejos, con lo desperdiciado
+ * @note Con el lock de escritura tomado: los punteros que da almacen_obtener() solo valen con el lock de lectura
+ */
+static void compactar(t_parte_almacen* parte)
+{
+	t_bloque_almacen* viejos = parte->bloque;
+	size_t recuperado = parte->desperdicio;
+	parte->bloque = NULL;
+	parte->arena = 0;
+	parte->desperdicio = 0;
+	for(size_t i = 0; i < parte->capacidad; i++) {
+		t_entrada_almacen* entrada = &parte->entradas[i];
+		if(entrada->hash == 0)
+			continue;
+		size_t bytes = tamanio_registro(leer_campo(entrada->registro, 0), leer_campo(entrada->registro, 2));
+		uint8_t* registro = reservar_en_arena(parte, bytes);
+		memcpy(registro, entrada->registro, bytes);
+		entrada->registro = registro;
+	}
+	liberar_bloques(viejos);
+	metricas_compactacion(recuperado);
+}
+
+/**
+ * @brief Busca la posicion de una clave, o la primera libre donde iria
+ * @return indice en parte->entradas (la entrada tiene hash 0 si la clave no esta)
+ */
+static size_t buscar_posicion(t_parte_almacen* parte, uint64_t hash, const void* clave, int largo)
+{
+	size_t mascara = parte->capacidad - 1;
+	size_t posicion = hash & mascara;
+	while(1) {
+		t_entrada_almacen* entrada = &parte->entradas[posicion];
+		if(entrada->hash == 0)
+			return posicion;
+		// Solo se toca la arena si coincide el hash completo
+		if(entrada->hash == hash && leer_campo(entrada->registro, 0) == (uint32_t) largo
+			&& memcmp(entrada->registro + ALMACEN_ENCABEZADO, clave, largo) == 0)
+			return posicion;
+		posicion = (posicion + 1) & mascara;
+	}
+}
+
+/**
+ * @brief Duplica el indice y reubica las entradas (la arena no se mueve: solo se copian hash y puntero)
+ */
+static void agrandar(t_parte_almacen* parte)
+{
+	t_entrada_almacen* viejas = parte->entradas;
+	size_t capacidad_vieja = parte->capacidad;
+	parte->capacidad *= 2;
+	parte->entradas = calloc(parte->capacidad, sizeof(t_entrada_almacen));
+
+	size_t mascara = parte->capacidad - 1;
+	for(size_t i = 0; i < capacidad_vieja; i++) {
+		if(viejas[i].hash == 0)
+			continue;
+		size_t posicion = viejas[i].hash & mascara;
+		while(parte->entradas[posicion].hash != 0)
+			posicion = (posicion + 1) & mascara;
+		parte->entradas[posicion] = viejas[i];
+	}
+	free(viejas);
+}
+
+static t_parte_almacen* elegir_parte(t_almacen* almacen, uint64_t hash)
+{
+	return &almacen->partes[hash >> (64 - __builtin_ctz(ALMACEN_PARTES))];
+}
+
+t_almacen* almacen_crear(void)
+{
+	t_almacen* almacen = malloc(sizeof(t_almacen));
+	for(int i = 0; i < ALMACEN_PARTES; i++) {
+		t_parte_almacen* parte = &almacen->partes[i];
+		pthread_rwlock_init(&parte->lock, NULL);
+		parte->capacidad = ALMACEN_CAPACIDAD_INICIAL;
+		parte->cantidad = 0;
+		parte->entradas = calloc(parte->capacidad, sizeof(t_entrada_almacen));
+		parte->bloque = NULL;
+		parte->arena = 0;
+		parte->desperdicio = 0;
+	}
+	return almacen;
+}
+
+void almacen_guardar(t_almacen* almacen, const void* clave, int largo_clave, const void* valor, int largo_valor)
+{
+	uint64_t hash = calcular_hash(clave, largo_clave);
+	t_parte_almacen* parte = elegir_parte(almacen, hash);
+
+	TRAZA_INICIO(tramo);
+	pthread_rwlock_wrlock(&parte->lock);
+	TRAZA_FIN(tramo, "almacen_guardar:wrlock");
+	size_t posicion = buscar_posicion(parte, hash, clave, largo_clave);
+	t_entrada_almacen* entrada = &parte->entradas[posicion];
+
+	if(entrada->hash != 0 && leer_campo(entrada->registro, 2) >= (uint32_t) largo_valor) {
+		// La clave ya estaba y el valor nuevo entra en el lugar del anterior
+		escribir_campo(entrada->registro, 1, largo_valor);
+		memcpy(entrada->registro + ALMACEN_ENCABEZADO + largo_clave, valor, largo_valor);
+		pthread_rwlock_unlock(&parte->lock);
+		return;
+	}
+
+	uint8_t* registro = reservar_en_arena(parte, tamanio_registro(largo_clave, largo_valor));
+	escribir_campo(registro, 0, largo_clave);
+	escribir_campo(registro, 1, largo_valor);
+	escribir_campo(registro, 2, largo_valor);
+	memcpy(registro + ALMACEN_ENCABEZADO, clave, largo_clave);
+	memcpy(registro + ALMACEN_ENCABEZADO + largo_clave, valor, largo_valor);
+
+	if(entrada->hash == 0) {
+		entrada->hash = hash;
+		parte->cantidad++;
+	}
+	else { // el registro anterior queda sin usar
+		size_t desperdicio = tamanio_registro(largo_clave, leer_campo(entrada->registro, 2));
+		parte->desperdicio += desperdicio;
+		metricas_desperdicio(desperdicio);
+	}
+	entrada->registro = registro;
+	if(parte->cantidad * 10 > parte->capacidad * 7) // mas del 70%: el sondeo lineal empieza a alargarse
+		agrandar(parte);
+	// Mas desperdicio que registros vivos: compactar cuesta menos de lo que ya se desperdicio
+	if(parte->desperdicio > ALMACEN_DESPERDICIO_MINIMO && parte->desperdicio * 2 > parte->arena)
+		compactar(parte);
+	pthread_rwlock_unlock(&parte->lock);
+}
+
+bool almacen_obtener(t_almacen* almacen, const void* clave, int largo_clave, t_usar_valor usar, void* contexto)
+{
+	uint64_t hash = calcular_hash(clave, largo_clave);
+	t_parte_almacen* parte = elegir_parte(almacen, hash);
+
+	TRAZA_INICIO(tramo);
+	pthread_rwlock_rdlock(&parte->lock);
+	TRAZA_FIN(tramo, "almacen_obtener:rdlock");
+	t_entrada_almacen* entrada = &parte->entradas[buscar_posicion(parte, hash, clave, largo_clave)];
+	bool encontrada = entrada->hash != 0;
+	if(encontrada && usar != NULL)
+		usar(contexto, entrada->registro + ALMACEN_ENCABEZADO + largo_clave, leer_campo(entrada->registro, 1));
+	pthread_rwlock_unlock(&parte->lock);
+	return encontrada;
+}
+
+size_t almacen_cantidad(t_almacen* almacen)
+{
+	size_t cantidad = 0;
+	for(int i = 0; i < ALMACEN_PARTES; i++) {
+		pthread_rwlock_rdlock(&almacen->partes[i].lock);
+		cantidad += almacen->partes[i].cantidad;
+		pthread_rwlock_unlock(&almacen->partes[i].lock);
+	}
+	return cantidad;
+}
+
+void almacen_destruir(t_almacen* almacen)
+{
+	for(int i = 0; i < ALMACEN_PARTES; i++) {
+		t_parte_almacen* parte = &almacen->partes[i];
+		liberar_bloques(parte->bloque);
+		free(parte->entradas);
+		pthread_rwlock_destroy(&parte->lock);
+	}
+	free(almacen);
+}
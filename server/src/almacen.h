@@ -0,0 +1,137 @@
+/**
+ * @file almacen.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del almacen clave/valor en memoria del servidor
+ *
+ * Guarda lo que mandan los clientes para poder consultarlo despues (op_codes PUT, GET y EXISTS):
+ * - PUT guarda clave -> valor;
+ * - cada MENSAJE y cada elemento de PAQUETE se guarda como clave (con valor vacio), para que EXISTS diga si llego.
+ *
+ * Indice: tabla hash de direccionamiento abierto con sondeo lineal. Cada entrada ocupa 16 bytes (hash + puntero),
+ * asi entran 4 por linea de cache y una busqueda casi nunca sale de una o dos lineas; la clave solo se compara
+ * cuando coincide el hash completo. Las claves y valores no se reservan con un malloc() cada uno (como en
+ * recibir_paquete()): se copian a una arena de bloques grandes.
+ * Un valor reemplazado por uno mas grande deja su registro viejo en la arena: cuando lo desperdiciado de una parte pasa
+ * ALMACEN_DESPERDICIO_MINIMO y lo que sigue en uso, la parte se compacta (los registros vivos se copian a bloques nuevos).
+ * Asi la arena ocupa a lo sumo el doble de lo vivo, y cada compactacion copia menos de lo que se desperdicio antes.
+ * La tabla esta partida en ALMACEN_PARTES partes con su propio rwlock: los workers casi nunca compiten por el mismo lock.
+ * @see https://en.wikipedia.org/wiki/Linear_probing
+ */
+
+#ifndef ALMACEN_H_
+#define ALMACEN_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint64_t
+#include<stdbool.h> // bool
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // un rwlock por parte
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+#include "metricas.h" // bytes desperdiciados y compactaciones
+
+/* Partes independientes de la tabla (potencia de 2) */
+#define ALMACEN_PARTES 64
+
+/* Entradas con las que arranca cada parte (potencia de 2). Se duplica al pasar el 70% de ocupacion */
+#define ALMACEN_CAPACIDAD_INICIAL 1024
+
+/* Tamanio de cada bloque de la arena. Un registro mas grande va en un bloque propio */
+#define ALMACEN_BLOQUE (1024 * 1024)
+
+/* Desperdicio por debajo del cual una parte no se compacta (para no copiar todo por unos pocos reemplazos) */
+#define ALMACEN_DESPERDICIO_MINIMO ALMACEN_BLOQUE
+
+/**
+ * @brief Entrada del indice
+ *
+ * registro apunta a la arena: | uint32 largo clave | uint32 largo valor | uint32 capacidad valor | clave | valor |
+ */
+typedef struct
+{
+	uint64_t hash; /**< hash completo de la clave (0 = entrada libre) */
+	uint8_t* registro; /**< clave y valor dentro de la arena */
+} t_entrada_almacen;
+
+/**
+ * @brief Bloque de la arena (se encadenan: solo se recorren al liberar todo)
+ */
+typedef struct t_bloque_almacen
+{
+	struct t_bloque_almacen* anterior;
+	size_t usado; /**< bytes ocupados de datos */
+	size_t capacidad; /**< bytes de datos */
+	uint8_t datos[]; /**< registros */
+} t_bloque_almacen;
+
+/**
+ * @brief Una parte del almacen: su indice, su arena y su lock
+ */
+typedef struct
+{
+	pthread_rwlock_t lock; /**< varios GET/EXISTS a la vez, PUT de a uno */
+	t_entrada_almacen* entradas; /**< indice (capacidad potencia de 2) */
+	size_t capacidad; /**< entradas reservadas */
+	size_t cantidad; /**< entradas ocupadas */
+	t_bloque_almacen* bloque; /**< bloque actual de la arena */
+	size_t arena; /**< bytes de registros en la arena (en uso o desperdiciados) */
+	size_t desperdicio; /**< bytes de registros reemplazados, que se recuperan al compactar */
+} t_parte_almacen;
+
+/**
+ * @brief Almacen clave/valor
+ */
+typedef struct
+{
+	t_parte_almacen partes[ALMACEN_PARTES];
+} t_almacen;
+
+/**
+ * @brief Funcion que recibe el valor encontrado por almacen_obtener()
+ * @param contexto lo que se paso a almacen_obtener()
+ * @param valor apunta dentro del almacen: solo es valido durante la llamada
+ * @param largo bytes del valor
+ */
+typedef void (*t_usar_valor)(void* contexto, const void* valor, int largo);
+
+// Declaracion de variable global
+extern t_almacen* almacen;
+
+/**
+ * @brief Crea un almacen vacio
+ */
+t_almacen* almacen_crear(void);
+
+/**
+ * @brief Guarda (o reemplaza) el valor de una clave
+ * @param almacen almacen creado
+ * @param clave bytes de la clave (no hace falta '\0')
+ * @param largo_clave bytes de la clave
+ * @param valor bytes del valor (se copian)
+ * @param largo_valor bytes del valor (0 = solo la clave)
+ * @note Si el valor nuevo entra donde estaba el anterior se pisa ahi; si no, el anterior queda en la arena sin usar
+ * hasta que se compacte la parte (ver ALMACEN_DESPERDICIO_MINIMO)
+ */
+void almacen_guardar(t_almacen* almacen, const void* clave, int largo_clave, const void* valor, int largo_valor);
+
+/**
+ * @brief Busca una clave y, si esta, llama a @p usar con su valor (sin copiarlo)
+ * @param usar funcion que recibe el valor, se llama con el lock tomado (puede ser NULL: solo se pregunta si existe)
+ * @return true si la clave existe
+ */
+bool almacen_obtener(t_almacen* almacen, const void* clave, int largo_clave, t_usar_valor usar, void* contexto);
+
+/**
+ * @brief Cantidad de claves guardadas
+ */
+size_t almacen_cantidad(t_almacen* almacen);
+
+/**
+ * @brief Libera el indice y toda la arena
+ */
+void almacen_destruir(t_almacen* almacen);
+
+#endif /* ALMACEN_H_ */
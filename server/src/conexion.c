@@ -0,0 +1,637 @@
+/**
+ * @file conexion.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del estado de cada conexion
+ *
+ * Reemplaza a la secuencia bloqueante recibir_operacion() -> recibir_buffer():
+ * en lugar de esperar cada campo con MSG_WAITALL, se lee todo lo disponible al lector
+ * y se procesan los frames que ya esten completos; el resto se retoma en el proximo evento.
+ * Con procesadores los campos de la conexion quedan repartidos: el event loop es dueño del socket, el lector,
+ * la salida y el credito; el procesador que la atiende, de los de la solicitud en curso (solicitud_con_id,
+ * id_solicitud, respondida, rechazada, persistido) y de devolucion. Lo unico que comparten (tareas, programada, referencias)
+ * es atomico.
+ * @see https://docs.utnso.com.ar/guias/linux/sockets
+ */
+
+#include "conexion.h"
+#include "procesadores.h"
+#include "topicos.h"
+#include "persistencia.h"
+
+t_conexion* conexion_crear(int fd, struct t_buzon* buzon)
+{
+	t_conexion* conexion = malloc(sizeof(t_conexion));
+	conexion->fd = fd;
+	conexion->lector = lector_crear(LECTOR_CAPACIDAD_INICIAL);
+	conexion->negociada = false;
+	conexion->capacidades = 0;
+	conexion->descompresor = NULL;
+	conexion->salida = NULL;
+	conexion->inicio_salida = 0;
+	conexion->fin_salida = 0;
+	conexion->capacidad_salida = 0;
+	conexion->solicitud_con_id = false;
+	conexion->id_solicitud = 0;
+	conexion->respondida = false;
+	conexion->rechazada = false;
+	conexion->persistido = 0;
+	conexion->recibido = 0;
+	conexion->credito = 0;
+	conexion->credito_a_devolver = 0;
+	conexion->pausada = false;
+	conexion->lectura_pendiente = false;
+	conexion->cerro_cliente = false;
+	conexion->buzon = buzon;
+	conexion->en_procesadores = buzon != NULL && procesadores_activos();
+	conexion->dueno = NULL;
+	conexion->tareas.cima = NULL;
+	conexion->programada = false;
+	conexion->referencias = 1; // la del event loop
+	conexion->encolados = 0;
+	conexion->cerrada = false;
+	conexion->cortada = false;
+	conexion->devolucion = NULL;
+	conexion->suscriptora = false;
+	conexion->publicaciones = NULL;
+	conexion->primera_publicacion = 0;
+	conexion->cantidad_publicaciones = 0;
+	conexion->enviado_publicacion = 0;
+	conexion->bytes_publicaciones = 0;
+	metricas_conexion(true);
+	metricas_reservas(3); // la conexion, el lector y su buffer
+	return conexion;
+}
+
+/**
+ * @brief Decide la version de la conexion mirando sus primeros bytes
+ * @return 1 si ya esta decidida, 0 si falta recibir el resto del handshake, -1 si el handshake es invalido
+ * @note Un frame v1 empieza con el byte bajo de su cod_op (int little endian): como los cod_op v1 quedan por debajo
+ * de la magia (ver PROTOCOLO_MAGIA), no hay ambiguedad
+ */
+static int negociar_version(t_conexion* conexion)
+{
+	int disponibles;
+	uint8_t* datos = lector_pendientes(conexion->lector, &disponibles);
+	if(disponibles == 0)
+		return 0;
+	if(datos[0] != PROTOCOLO_MAGIA) {
+		conexion->negociada = true; // cliente v1: el lector ya arranca en esa version
+		return 1;
+	}
+	if(disponibles < PROTOCOLO_TAMANIO_HANDSHAKE)
+		return 0;
+
+	int version = handshake_servidor(conexion->fd, datos, &conexion->capacidades);
+	if(version == -1)
+		return -1;
+	lector_descartar(conexion->lector, PROTOCOLO_TAMANIO_HANDSHAKE);
+	conexion->lector->version = version;
+	conexion->credito = PROTOCOLO_CREDITO_INICIAL;
+	conexion->negociada = true;
+	return 1;
+}
+
+/**
+ * @brief Reemplaza el payload de un frame comprimido por el original
+ * @return tamanio del payload original, o -1 si no se negocio compresion o el payload es invalido
+ */
+static int descomprimir(t_conexion* conexion, void** payload, int size)
+{
+	if(!(conexion->capacidades & PROTOCOLO_CAPACIDAD_COMPRESION))
+		return -1;
+	// Las conexiones que nunca comprimen no pagan el estado de inflate (~40 KB)
+	if(conexion->descompresor == NULL) {
+		if((conexion->descompresor = descompresor_crear(limites.frame_maximo)) == NULL)
+			return -1;
+		metricas_reservas(1);
+	}
+	TRAZA_INICIO(tramo);
+	int descomprimidos = descompresor_descomprimir(conexion->descompresor, *payload, size, payload);
+	TRAZA_FIN(tramo, "descomprimir:inflate");
+	return descomprimidos;
+}
+
+/**
+ * @brief Bytes de respuestas que todavia no se enviaron
+ */
+static int salida_pendiente(t_conexion* conexion)
+{
+	return conexion->fin_salida - conexion->inicio_salida;
+}
+
+/**
+ * @brief Se asegura @p bytes libres al final de la salida
+ * @return donde escribirlos (fin_salida lo avanza quien llama)
+ */
+static uint8_t* reservar_en_salida(t_conexion* conexion, int bytes)
+{
+	// Lo ya enviado se descarta antes de agrandar: el buffer no crece con cada respuesta
+	if(conexion->inicio_salida > 0 && conexion->inicio_salida == conexion->fin_salida)
+		conexion->inicio_salida = conexion->fin_salida = 0;
+
+	int necesarios = conexion->fin_salida + bytes;
+	if(necesarios > conexion->capacidad_salida) {
+		if(conexion->inicio_salida > 0) { // se compacta: lo pendiente pasa al principio
+			memmove(conexion->salida, conexion->salida + conexion->inicio_salida, conexion->fin_salida - conexion->inicio_salida);
+			conexion->fin_salida -= conexion->inicio_salida;
+			necesarios -= conexion->inicio_salida;
+			conexion->inicio_salida = 0;
+		}
+		int capacidad = conexion->capacidad_salida > 0 ? conexion->capacidad_salida : 4096;
+		while(capacidad < necesarios)
+			capacidad *= 2;
+		if(capacidad != conexion->capacidad_salida) {
+			TRAZA_INICIO(tramo);
+			conexion->salida = realloc(conexion->salida, capacidad);
+			TRAZA_FIN(tramo, "conexion_reservar_respuesta:realloc");
+			metricas_reservas(1);
+			conexion->capacidad_salida = capacidad;
+		}
+	}
+	return conexion->salida + conexion->fin_salida;
+}
+
+/**
+ * @brief Se asegura @p bytes libres al final de las respuestas de una devolucion
+ */
+static uint8_t* reservar_en_devolucion(t_devolucion* devolucion, int bytes)
+{
+	if(devolucion->size + bytes > devolucion->capacidad) {
+		int capacidad = devolucion->capacidad > 0 ? devolucion->capacidad : 256;
+		while(capacidad < devolucion->size + bytes)
+			capacidad *= 2;
+		devolucion->respuestas = realloc(devolucion->respuestas, capacidad);
+		metricas_reservas(1);
+		devolucion->capacidad = capacidad;
+	}
+	return devolucion->respuestas + devolucion->size;
+}
+
+/**
+ * @brief Devuelve con un CREDITO lo ya procesado, de a tandas de medio credito inicial para no mandar un frame por cada uno
+ * @note Con la salida arriba de la marca alta se retiene: el cliente espera hasta que lea sus respuestas
+ */
+static void devolver_credito(t_conexion* conexion)
+{
+	if(conexion->credito_a_devolver < PROTOCOLO_CREDITO_INICIAL / 2 || conexion->pausada || salida_pendiente(conexion) >= CONEXION_SALIDA_ALTA)
+		return;
+	// Un frame descartado puede pasar lo que entra en un varint: se devuelve en varios CREDITO
+	while(conexion->credito_a_devolver > 0) {
+		uint32_t tanda = conexion->credito_a_devolver < UINT32_MAX ? conexion->credito_a_devolver : UINT32_MAX;
+		// Directo a la salida y sin id: con procesadores, la solicitud en curso es de otro hilo
+		uint8_t* destino = reservar_en_salida(conexion, PROTOCOLO_ENCABEZADO_MAXIMO + VARINT_MAXIMO);
+		int encabezado = protocolo_codificar_encabezado(conexion->lector->version, destino, CREDITO, 0, varint_tamanio(tanda));
+		conexion->fin_salida += encabezado + varint_codificar(tanda, destino + encabezado);
+		conexion->credito += tanda;
+		conexion->credito_a_devolver -= tanda;
+	}
+}
+
+/**
+ * @brief Envia las respuestas y, si igual quedan mas de CONEXION_SALIDA_ALTA bytes sin enviar, pausa la lectura
+ * @return lo mismo que conexion_vaciar()
+ */
+static int controlar_salida(t_conexion* conexion)
+{
+	int estado = conexion_vaciar(conexion);
+	if(estado == 1 && salida_pendiente(conexion) > CONEXION_SALIDA_ALTA)
+		conexion->pausada = true;
+	return estado;
+}
+
+/**
+ * @brief Procesa una tarea (en el event loop o en un procesador) y la confirma si el cliente espera su id
+ */
+static void procesar_tarea(t_conexion* conexion, t_tarea* tarea, t_procesar_frame procesar)
+{
+	conexion->solicitud_con_id = tarea->con_id;
+	conexion->id_solicitud = tarea->id;
+	conexion->respondida = false;
+	conexion->rechazada = false;
+	if(tarea->rechazada)
+		conexion_confirmar(conexion, PROTOCOLO_ACK_ERROR);
+	else {
+		TRAZA_INICIO(tramo);
+		procesar(conexion, tarea->cod_op, tarea->payload, tarea->size);
+		TRAZA_FIN(tramo, "procesar_frames:procesar");
+	}
+	// Lo que no tiene RESPUESTA (MENSAJE, PAQUETE, PUT) se confirma igual: el cliente espera cada id
+	conexion_confirmar(conexion, PROTOCOLO_ACK_OK);
+	conexion->solicitud_con_id = false;
+	metricas_frame(tarea->cod_op, tarea->largo, tarea->recibido, conexion->rechazada);
+}
+
+/**
+ * @brief Espera a que este en disco lo que persistieron los frames con id del lote (un solo fdatasync() para todos)
+ * @return 0 si ya se pueden enviar sus confirmaciones, -1 si fallo el disco (no se puede enviar ninguna)
+ */
+static int esperar_persistencia(t_conexion* conexion)
+{
+	if(conexion->persistido == 0)
+		return 0;
+	TRAZA_INICIO(tramo);
+	int resultado = persistencia_esperar(persistencia, conexion->persistido);
+	TRAZA_FIN(tramo, "esperar_persistencia:fdatasync");
+	conexion->persistido = 0;
+	if(resultado == -1)
+		log_error(logger, "No se pudo persistir lo que se le iba a confirmar al cliente (fd %d): se lo desconecta", conexion->fd);
+	return resultado;
+}
+
+/**
+ * @brief Deja una copia de la tarea en la conexion y, si nadie la esta atendiendo, la programa en el pool
+ */
+static void encolar_tarea(t_conexion* conexion, t_tarea* tarea)
+{
+	int size = tarea->rechazada ? 0 : tarea->size;
+	t_tarea* copia = malloc(sizeof(t_tarea) + size);
+	*copia = *tarea;
+	memcpy(copia->datos, tarea->payload, size);
+	copia->payload = copia->datos;
+	copia->size = size;
+	metricas_reservas(1);
+	conexion->encolados += sizeof(t_tarea) + size;
+	pila_apilar(&conexion->tareas, &copia->nodo);
+	if(!__atomic_exchange_n(&conexion->programada, true, __ATOMIC_SEQ_CST)) {
+		__atomic_add_fetch(&conexion->referencias, 1, __ATOMIC_RELAXED); // la del procesador
+		procesadores_programar(conexion);
+	}
+}
+
+/**
+ * @brief Procesa todos los frames completos que haya en el lector (o los encola, si hay procesadores)
+ * @return 0 si todo bien, -1 si algun frame es invalido
+ * @note Si la conexion se pausa se deja de procesar: el resto queda en el lector hasta conexion_retomar().
+ * Un frame demasiado grande o con un payload comprimido invalido se rechaza (ACK_ERROR si tiene id) y se sigue:
+ * solo se corta la conexion si se perdio la sincronizacion o el cliente no respeta lo acordado (ids, credito)
+ */
+static int procesar_frames(t_conexion* conexion, t_procesar_frame procesar)
+{
+	if(!conexion->negociada) {
+		int estado = negociar_version(conexion);
+		if(estado == -1)
+			metricas_invalido();
+		if(estado != 1)
+			return estado;
+	}
+
+	t_encabezado encabezado;
+	int estado = 0;
+	void* payload;
+	while(!conexion->pausada
+		&& ((estado = lector_siguiente_frame(conexion->lector, &encabezado, &payload)) == 1 || estado == LECTOR_FRAME_DESCARTADO)) {
+		int size = encabezado.size;
+		if((encabezado.flags & PROTOCOLO_FLAG_ID) && !(conexion->capacidades & PROTOCOLO_CAPACIDAD_IDS)) {
+			metricas_invalido();
+			return -1;
+		}
+		// Los frames sin id consumen credito (un cliente que no lo respeta se desconecta)
+		int64_t largo = (int64_t) encabezado.encabezado + encabezado.size;
+		bool con_credito = (conexion->capacidades & PROTOCOLO_CAPACIDAD_CREDITOS) && !(encabezado.flags & PROTOCOLO_FLAG_ID);
+		if(con_credito) {
+			if(conexion->credito <= 0) {
+				metricas_invalido();
+				return -1;
+			}
+			conexion->credito -= largo;
+		}
+		t_tarea tarea = {
+			.cod_op = encabezado.cod_op, .con_id = encabezado.flags & PROTOCOLO_FLAG_ID, .id = encabezado.id,
+			.con_credito = con_credito, .largo = largo, .recibido = conexion->recibido
+		};
+		if(estado == LECTOR_FRAME_DESCARTADO) {
+			log_warning(logger, "Frame de %u bytes descartado (maximo %u, fd %d)", encabezado.size, limites.frame_maximo, conexion->fd);
+			tarea.rechazada = true;
+		}
+		else if((encabezado.flags & PROTOCOLO_FLAG_COMPRIMIDO) && (size = descomprimir(conexion, &payload, size)) == -1) {
+			log_warning(logger, "Frame comprimido invalido o demasiado grande (fd %d)", conexion->fd);
+			tarea.rechazada = true;
+		}
+		tarea.payload = payload;
+		tarea.size = size;
+		if(conexion->en_procesadores) {
+			encolar_tarea(conexion, &tarea); // el credito se devuelve cuando vuelven sus respuestas
+			// Lo encolado cuenta como salida: si los procesadores no dan abasto, se deja de leer
+			if(conexion->encolados > CONEXION_SALIDA_ALTA)
+				conexion->pausada = true;
+			continue;
+		}
+		procesar_tarea(conexion, &tarea, procesar);
+		if(con_credito)
+			conexion->credito_a_devolver += largo;
+		// Un lote grande (p.ej. muchos GET de un valor grande) se envia a medida que se procesa: si el socket no lo
+		// acepta se pausa. Lo confirmado tiene que estar en disco antes de salir
+		if(salida_pendiente(conexion) > CONEXION_SALIDA_ALTA && (esperar_persistencia(conexion) == -1 || controlar_salida(conexion) == -1))
+			return -1;
+	}
+	// Las confirmaciones de lo persistido salen con el registro en disco: sin enviarlas, el event loop corta la conexion
+	if(esperar_persistencia(conexion) == -1)
+		return -1;
+	if(estado == -1)
+		metricas_invalido();
+	devolver_credito(conexion);
+	return estado == -1 ? -1 : 0;
+}
+
+int conexion_retomar(t_conexion* conexion, t_procesar_frame procesar)
+{
+	if(conexion->pausada || conexion->lector->inicio == conexion->lector->fin)
+		return 0;
+	if(procesar_frames(conexion, procesar) == -1)
+		return -1;
+	return controlar_salida(conexion) == -1 ? -1 : 0;
+}
+
+int conexion_leer(t_conexion* conexion, t_procesar_frame procesar)
+{
+	// Lo que quedo en el lector al pausarse va antes que lo nuevo
+	if(conexion_retomar(conexion, procesar) == -1)
+		return -1;
+	int leidos = 0;
+	while(!conexion->pausada) {
+		// Presupuesto agotado: lo que quede en el socket se lee en la proxima vuelta, despues de las demas conexiones
+		if(leidos >= CONEXION_PRESUPUESTO_LECTURA)
+			return controlar_salida(conexion) == -1 ? -1 : !conexion->pausada;
+		TRAZA_INICIO(tramo);
+		int recibidos = lector_llenar(conexion->lector, conexion->fd);
+		TRAZA_FIN(tramo, "conexion_leer:recv");
+		if(recibidos == 0) { // el cliente cerro su lado: se le envia lo que ya tiene (ver conexion_terminada())
+			conexion->cerro_cliente = true;
+			return controlar_salida(conexion) == -1 ? -1 : 0;
+		}
+		if(recibidos == -1) {
+			if(errno == EINTR)
+				continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				return controlar_salida(conexion) == -1 ? -1 : 0; // socket vacio: se retoma en el proximo evento
+			return -1;
+		}
+		leidos += recibidos;
+		conexion->recibido = metricas_instante();
+
+		// Si el recv() no lleno el espacio libre, el socket quedo vacio: no hace falta otro recv() para ver EAGAIN.
+		// Salvo que el cliente ya haya cerrado: hay que llegar al recv() que devuelve 0 (epoll no vuelve a avisar el cierre)
+		bool socket_vacio = !conexion->cerro_cliente && conexion->lector->fin < conexion->lector->capacidad;
+
+		if(procesar_frames(conexion, procesar) == -1)
+			return -1;
+		if(socket_vacio)
+			return controlar_salida(conexion) == -1 ? -1 : 0;
+		if(salida_pendiente(conexion) > CONEXION_SALIDA_ALTA && controlar_salida(conexion) == -1)
+			return -1;
+	}
+	return 0; // pausada: se sigue leyendo despues de conexion_reanudar()
+}
+
+int conexion_consumir(t_conexion* conexion, const void* datos, int cantidad, t_procesar_frame procesar)
+{
+	lector_agregar(conexion->lector, datos, cantidad);
+	conexion->recibido = metricas_instante();
+	if(procesar_frames(conexion, procesar) == -1)
+		return -1;
+	return controlar_salida(conexion) == -1 ? -1 : 0;
+}
+
+uint8_t* conexion_reservar_respuesta(t_conexion* conexion, int cod_op, int size)
+{
+	// En un procesador la respuesta va a la devolucion: la salida es del event loop
+	t_devolucion* devolucion = conexion->devolucion;
+	uint8_t* destino = devolucion != NULL
+		? reservar_en_devolucion(devolucion, PROTOCOLO_ENCABEZADO_MAXIMO + size)
+		: reservar_en_salida(conexion, PROTOCOLO_ENCABEZADO_MAXIMO + size);
+	int encabezado;
+	if(conexion->solicitud_con_id) {
+		encabezado = protocolo_codificar_encabezado_id(conexion->lector->version, destino, cod_op, 0, size, conexion->id_solicitud);
+		conexion->respondida = true;
+	} else
+		encabezado = protocolo_codificar_encabezado(conexion->lector->version, destino, cod_op, 0, size);
+	if(devolucion != NULL)
+		devolucion->size += encabezado + size;
+	else
+		conexion->fin_salida += encabezado + size;
+	return destino + encabezado;
+}
+
+void conexion_confirmar(t_conexion* conexion, uint8_t resultado)
+{
+	if(resultado == PROTOCOLO_ACK_ERROR)
+		conexion->rechazada = true; // se cuenta aunque el cliente no tenga ids y no reciba el ACK
+	if(conexion->solicitud_con_id && !conexion->respondida)
+		conexion_reservar_respuesta(conexion, ACK, 1)[0] = resultado;
+}
+
+/**
+ * @brief Envia publicaciones de la cola, varias por sendmsg()
+ * @param maximo publicaciones a enviar como mucho
+ * @return 0 si se enviaron, 1 si el socket se lleno, -1 si fallo la conexion
+ */
+static int enviar_publicaciones(t_conexion* conexion, int maximo)
+{
+	while(conexion->cantidad_publicaciones > 0 && maximo > 0) {
+		struct iovec partes[CONEXION_PUBLICACIONES_ENVIO];
+		int cantidad = 0;
+		for(; cantidad < conexion->cantidad_publicaciones && cantidad < maximo && cantidad < CONEXION_PUBLICACIONES_ENVIO; cantidad++) {
+			t_publicacion* publicacion = conexion->publicaciones[(conexion->primera_publicacion + cantidad) & (CONEXION_PUBLICACIONES - 1)];
+			int desde = cantidad == 0 ? conexion->enviado_publicacion : 0;
+			partes[cantidad] = (struct iovec) { publicacion->frame + desde, publicacion->size - desde };
+		}
+		struct msghdr mensaje = { .msg_iov = partes, .msg_iovlen = cantidad };
+		TRAZA_INICIO(tramo);
+		ssize_t enviados = sendmsg(conexion->fd, &mensaje, MSG_DONTWAIT | MSG_NOSIGNAL);
+		TRAZA_FIN(tramo, "conexion_vaciar:publicaciones");
+		if(enviados == -1) {
+			if(errno == EINTR)
+				continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				return 1;
+			return -1;
+		}
+		// Se sueltan las que salieron enteras; la que quedo cortada sigue primera
+		enviados += conexion->enviado_publicacion;
+		conexion->enviado_publicacion = 0;
+		while(conexion->cantidad_publicaciones > 0 && maximo > 0) {
+			t_publicacion* publicacion = conexion->publicaciones[conexion->primera_publicacion];
+			if(enviados < publicacion->size) {
+				conexion->enviado_publicacion = enviados;
+				break;
+			}
+			enviados -= publicacion->size;
+			conexion->bytes_publicaciones -= publicacion->size;
+			conexion->primera_publicacion = (conexion->primera_publicacion + 1) & (CONEXION_PUBLICACIONES - 1);
+			conexion->cantidad_publicaciones--;
+			maximo--;
+			publicacion_soltar(publicacion);
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Agrega una publicacion a la cola del suscriptor, o la descarta si la cola esta llena
+ * @note Se lleva la referencia de la entrega
+ */
+static void encolar_publicacion(t_conexion* conexion, t_publicacion* publicacion)
+{
+	if(conexion->cantidad_publicaciones == CONEXION_PUBLICACIONES || (conexion->cantidad_publicaciones > 0
+		&& conexion->bytes_publicaciones + publicacion->size > CONEXION_PUBLICACIONES_BYTES)) {
+		metricas_publicacion(false);
+		publicacion_soltar(publicacion);
+		return;
+	}
+	if(conexion->publicaciones == NULL) {
+		conexion->publicaciones = malloc(CONEXION_PUBLICACIONES * sizeof(t_publicacion*));
+		metricas_reservas(1);
+	}
+	int posicion = (conexion->primera_publicacion + conexion->cantidad_publicaciones) & (CONEXION_PUBLICACIONES - 1);
+	conexion->publicaciones[posicion] = publicacion;
+	conexion->cantidad_publicaciones++;
+	conexion->bytes_publicaciones += publicacion->size;
+	metricas_publicacion(true);
+}
+
+int conexion_vaciar(t_conexion* conexion)
+{
+	if(conexion->cortada)
+		return -1;
+	// Una publicacion a medio enviar va primero: otro frame en el medio la cortaria
+	if(conexion->enviado_publicacion > 0) {
+		int estado = enviar_publicaciones(conexion, 1);
+		if(estado != 0)
+			return estado;
+	}
+	while(conexion->inicio_salida < conexion->fin_salida) {
+		// MSG_DONTWAIT: vale tambien para los sockets bloqueantes del backend io_uring
+		TRAZA_INICIO(tramo);
+		ssize_t enviados = send(conexion->fd, conexion->salida + conexion->inicio_salida,
+			conexion->fin_salida - conexion->inicio_salida, MSG_DONTWAIT | MSG_NOSIGNAL);
+		TRAZA_FIN(tramo, "conexion_vaciar:send");
+		if(enviados == -1) {
+			if(errno == EINTR)
+				continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				return 1;
+			return -1;
+		}
+		conexion->inicio_salida += enviados;
+	}
+	conexion->inicio_salida = conexion->fin_salida = 0;
+	return enviar_publicaciones(conexion, CONEXION_PUBLICACIONES);
+}
+
+bool conexion_salida_pendiente(t_conexion* conexion)
+{
+	return conexion->inicio_salida < conexion->fin_salida || conexion->cantidad_publicaciones > 0;
+}
+
+bool conexion_pausada(t_conexion* conexion)
+{
+	return conexion->pausada;
+}
+
+bool conexion_reanudar(t_conexion* conexion)
+{
+	if(!conexion->pausada || salida_pendiente(conexion) > CONEXION_SALIDA_BAJA || conexion->encolados > CONEXION_SALIDA_BAJA)
+		return false;
+	conexion->pausada = false;
+	devolver_credito(conexion); // lo retenido durante la pausa
+	return true;
+}
+
+bool conexion_terminada(t_conexion* conexion)
+{
+	// encolados vuelve a 0 recien cuando se recogio la devolucion de la ultima tarea
+	return conexion->cerro_cliente && !conexion->pausada && !conexion->lectura_pendiente && conexion->encolados == 0
+		&& !conexion_salida_pendiente(conexion);
+}
+
+/**
+ * @brief Suelta una referencia; con la ultima se libera la conexion
+ */
+static void conexion_soltar(t_conexion* conexion)
+{
+	if(__atomic_sub_fetch(&conexion->referencias, 1, __ATOMIC_ACQ_REL) > 0)
+		return;
+	lector_destruir(conexion->lector); // puede quedar un frame a medio recibir
+	if(conexion->descompresor != NULL)
+		descompresor_destruir(conexion->descompresor);
+	free(conexion->salida);
+	for(int i = 0; i < conexion->cantidad_publicaciones; i++)
+		publicacion_soltar(conexion->publicaciones[(conexion->primera_publicacion + i) & (CONEXION_PUBLICACIONES - 1)]);
+	free(conexion->publicaciones);
+	free(conexion);
+}
+
+bool conexion_procesar_tareas(t_conexion* conexion, t_procesar_frame procesar)
+{
+	t_devolucion* devolucion = calloc(1, sizeof(t_devolucion));
+	devolucion->conexion = conexion;
+	conexion->devolucion = devolucion;
+	t_nodo* nodo = pila_tomar_todo(&conexion->tareas);
+	bool hubo_tareas = nodo != NULL;
+	while(nodo != NULL) {
+		t_tarea* tarea = (t_tarea*) nodo;
+		nodo = nodo->siguiente;
+		procesar_tarea(conexion, tarea, procesar);
+		if(tarea->con_credito)
+			devolucion->credito += tarea->largo;
+		devolucion->encolados += sizeof(t_tarea) + tarea->size;
+		free(tarea);
+	}
+	conexion->devolucion = NULL;
+	if(esperar_persistencia(conexion) == -1) {
+		devolucion->size = 0;
+		devolucion->cortar = true;
+	}
+
+	if(hubo_tareas) {
+		__atomic_add_fetch(&conexion->referencias, 1, __ATOMIC_RELAXED); // la de la devolucion
+		buzon_entregar(conexion->buzon, devolucion);
+	} else
+		free(devolucion);
+
+	// Se libera la conexion y se vuelve a mirar: una tarea encolada justo antes la vio todavia programada
+	__atomic_store_n(&conexion->programada, false, __ATOMIC_SEQ_CST);
+	if(!pila_vacia(&conexion->tareas) && !__atomic_exchange_n(&conexion->programada, true, __ATOMIC_SEQ_CST))
+		return true;
+	conexion_soltar(conexion);
+	return false;
+}
+
+bool conexion_recoger(t_devolucion* devolucion)
+{
+	t_conexion* conexion = devolucion->conexion;
+	bool abierta = !conexion->cerrada;
+	if(devolucion->publicacion != NULL) {
+		if(abierta)
+			encolar_publicacion(conexion, devolucion->publicacion);
+		else
+			publicacion_soltar(devolucion->publicacion);
+	}
+	else if(abierta && devolucion->cortar)
+		conexion->cortada = true; // conexion_vaciar() devuelve -1 y el event loop la desconecta
+	else if(abierta) {
+		if(devolucion->size > 0) {
+			memcpy(reservar_en_salida(conexion, devolucion->size), devolucion->respuestas, devolucion->size);
+			conexion->fin_salida += devolucion->size;
+		}
+		conexion->credito_a_devolver += devolucion->credito;
+		conexion->encolados -= devolucion->encolados;
+		devolver_credito(conexion);
+	}
+	free(devolucion->respuestas);
+	free(devolucion);
+	conexion_soltar(conexion);
+	return abierta;
+}
+
+void conexion_destruir(t_conexion* conexion)
+{
+	metricas_conexion(false);
+	close(conexion->fd);
+	// Un procesador puede estar atendiendola o tener respuestas sin recoger: se libera con la ultima referencia
+	__atomic_store_n(&conexion->cerrada, true, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&conexion->suscriptora, __ATOMIC_SEQ_CST))
+		topicos_cerrar_conexion(conexion); // despues nadie le puede entregar publicaciones
+	conexion_soltar(conexion);
+}
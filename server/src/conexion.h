@@ -0,0 +1,272 @@
+/**
+ * @file conexion.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del estado de cada conexion del servidor
+ *
+ * Cada cliente conectado tiene su propio lector (ver lector.h) que arma los frames
+ * | cod_op | size | payload | a medida que llegan los bytes por un socket no bloqueante.
+ * Si lo primero que llega es un handshake (ver protocolo.h) se negocia la version;
+ * si no, la conexion queda en protocolo v1 (clientes viejos).
+ * Los frames comprimidos se descomprimen antes de procesarlos: quien procesa siempre ve el payload original.
+ * Las respuestas (ej. a un GET) se acumulan en un buffer de salida y se envian juntas despues de procesar
+ * todos los frames de una lectura; lo que el socket no acepta queda pendiente para cuando vuelva a tener lugar.
+ * Si se negocio PROTOCOLO_CAPACIDAD_IDS, toda solicitud con id recibe exactamente una contestacion con ese id:
+ * la RESPUESTA que arme quien procesa o, si no armo ninguna, un ACK automatico.
+ * Control de flujo: con PROTOCOLO_CAPACIDAD_CREDITOS el credito de los frames sin id se devuelve recien
+ * despues de procesarlos; si la salida pasa CONEXION_SALIDA_ALTA (el cliente no lee sus respuestas) se deja de leer
+ * a la conexion y de devolverle credito hasta que baje de CONEXION_SALIDA_BAJA. Asi la memoria de cada conexion queda acotada.
+ * Con procesadores (ver procesadores.h) el event loop solo separa y descomprime los frames: cada uno pasa a ser una
+ * t_tarea en la lista de la conexion, la procesa un hilo del pool y sus respuestas vuelven en una t_devolucion
+ * al event loop, que es el unico que toca el socket. Los bytes de tareas sin devolver cuentan como salida para la pausa.
+ * Con persistencia (ver persistencia.h), las respuestas de un lote de frames (los de una lectura o los que atiende un
+ * procesador de una vez) salen recien cuando lo que persistieron sus frames con id esta en disco: un ACK_OK de un PUT
+ * promete que el PUT sobrevive a un corte de luz. Se espera una sola vez por lote, asi el group commit sigue juntando.
+ * Un suscriptor (ver topicos.h) tiene ademas una cola acotada de publicaciones: referencias a frames ya codificados
+ * que comparte con los demas suscriptores. Se envian entre las respuestas, sin cortar ningun frame; si la cola
+ * esta llena la publicacion se descarta (un suscriptor lento no frena a nadie ni junta memoria sin limite).
+ * @see https://docs.utnso.com.ar/guias/linux/sockets
+ */
+
+#ifndef CONEXION_H_
+#define CONEXION_H_
+
+// Librerias standard de C
+#include<stdlib.h> // malloc, free
+#include<stdbool.h> // bool
+
+// Librerias standard de POSIX/Linux
+#include<sys/uio.h> // struct iovec: varias publicaciones en un solo sendmsg()
+
+// Descompresion de los frames con PROTOCOLO_FLAG_COMPRIMIDO
+#include<compresion.h>
+
+// Inclusión del buffer de lectura (y de las utilidades)
+#include "lector.h"
+#include "metricas.h" // frames, errores y latencias de cada worker
+#include "pila_atomica.h" // tareas y devoluciones que pasan entre el event loop y los procesadores
+
+/* Bytes que se leen como mucho de una conexion seguidos: un cliente que no para de mandar no acapara al worker */
+#define CONEXION_PRESUPUESTO_LECTURA (256 * 1024)
+
+/* Marcas de la salida: arriba de la alta se pausa la lectura, se reanuda al bajar de la baja */
+#define CONEXION_SALIDA_ALTA (1024 * 1024)
+#define CONEXION_SALIDA_BAJA (256 * 1024)
+
+/* Publicaciones en la cola de un suscriptor como mucho (potencia de 2); las que no entran se descartan */
+#define CONEXION_PUBLICACIONES 256
+
+/* Bytes de publicaciones en la cola de un suscriptor como mucho (con la cola vacia entra una de cualquier tamanio) */
+#define CONEXION_PUBLICACIONES_BYTES (4 * 1024 * 1024)
+
+/* Publicaciones que se envian como mucho en un solo sendmsg() */
+#define CONEXION_PUBLICACIONES_ENVIO 64
+
+struct t_buzon;
+struct t_conexion;
+struct t_publicacion;
+
+/**
+ * @brief Un frame ya separado (y descomprimido), listo para procesar
+ */
+typedef struct
+{
+	t_nodo nodo; /**< enlace en la lista de tareas de la conexion */
+	int cod_op; /**< codigo de operacion del frame */
+	bool con_id; /**< si trae id (hay que contestarlo) */
+	uint32_t id; /**< id del frame */
+	bool rechazada; /**< ya se rechazo al separarlo (demasiado grande o mal comprimido): solo se contesta ACK_ERROR */
+	bool con_credito; /**< si consumio credito (se devuelve despues de procesarlo) */
+	int64_t largo; /**< bytes que ocupo en el cable (encabezado + payload) */
+	uint64_t recibido; /**< metricas_instante() de cuando se recibio */
+	void* payload; /**< datos del frame (en una tarea encolada apuntan a datos) */
+	int size; /**< tamanio del payload */
+	uint8_t datos[]; /**< copia del payload de una tarea encolada */
+} t_tarea;
+
+/**
+ * @brief Lo que devuelve un procesador despues de atender un lote de tareas de una conexion
+ */
+typedef struct
+{
+	t_nodo nodo; /**< enlace en el buzon del event loop */
+	struct t_conexion* conexion; /**< conexion de las tareas */
+	uint8_t* respuestas; /**< frames de respuesta ya codificados, en orden (NULL si no hubo) */
+	int size; /**< bytes usados de respuestas */
+	int capacidad; /**< bytes reservados en respuestas */
+	int64_t credito; /**< bytes de frames con credito que ya se procesaron */
+	int64_t encolados; /**< bytes de tareas que se liberaron */
+	bool cortar; /**< no se pudo persistir lo que confirmaban las respuestas: se descartan y se desconecta al cliente */
+	struct t_publicacion* publicacion; /**< si no es NULL, no viene de un procesador: es una publicacion para encolar */
+} t_devolucion;
+
+/**
+ * @brief Estado de un cliente conectado al servidor
+ */
+typedef struct t_conexion
+{
+	int fd; /**< socket (no bloqueante) del cliente */
+	t_lector* lector; /**< bytes recibidos que todavia no formaron un frame completo */
+	bool negociada; /**< si ya se decidio la version (por handshake o por ser un cliente v1) */
+	uint8_t capacidades; /**< PROTOCOLO_CAPACIDAD_* acordadas en el handshake */
+	t_descompresor* descompresor; /**< se crea con el primer frame comprimido (NULL hasta entonces) */
+	uint8_t* salida; /**< respuestas todavia no enviadas (NULL hasta la primera) */
+	int inicio_salida; /**< primer byte sin enviar */
+	int fin_salida; /**< primer byte libre */
+	int capacidad_salida; /**< bytes reservados en salida */
+	bool solicitud_con_id; /**< si el frame que se esta procesando trae id (hay que contestarlo) */
+	uint32_t id_solicitud; /**< id del frame que se esta procesando */
+	bool respondida; /**< si ya se contesto el frame que se esta procesando */
+	bool rechazada; /**< si el frame que se esta procesando se rechazo con PROTOCOLO_ACK_ERROR (tenga id o no) */
+	uint64_t persistido; /**< ultimo registro de persistencia de un frame con id del lote en curso (0 si no hay): se confirma con el registro en disco */
+	uint64_t recibido; /**< metricas_instante() de la ultima lectura: desde ahi se mide la latencia de sus frames */
+	int64_t credito; /**< bytes de frames sin id que el cliente todavia puede enviar (con PROTOCOLO_CAPACIDAD_CREDITOS) */
+	int64_t credito_a_devolver; /**< bytes de frames sin id ya procesados que todavia no se devolvieron con CREDITO */
+	bool pausada; /**< la salida paso CONEXION_SALIDA_ALTA: no se lee hasta que baje (ver conexion_reanudar()) */
+	bool lectura_pendiente; /**< agoto su presupuesto con datos en el socket: el event loop la vuelve a leer */
+	bool cerro_cliente; /**< el cliente cerro su lado (EPOLLRDHUP/EPOLLHUP o recv() en 0): se lee hasta el fin y se cierra al terminar de contestar */
+	struct t_buzon* buzon; /**< buzon de su event loop: respuestas de los procesadores y publicaciones (NULL si no se pudo crear) */
+	bool en_procesadores; /**< sus frames los procesa el pool (si no, el hilo del event loop) */
+	void* dueno; /**< estado que le agrega el event loop (ej. io_uring), para atender sus devoluciones */
+	t_pila tareas; /**< frames que esperan a un procesador, en orden de llegada */
+	bool programada; /**< esta en la cola o la atiende un procesador: nunca dos a la vez, asi se respeta el orden */
+	int referencias; /**< el event loop, el procesador que la atiende y cada devolucion sin recoger: se libera en 0 */
+	int64_t encolados; /**< bytes de tareas que todavia no volvieron (solo los toca el event loop) */
+	bool cerrada; /**< el event loop ya la cerro: lo que devuelvan los procesadores se descarta */
+	bool cortada; /**< fallo la persistencia de algo que se le iba a confirmar: conexion_vaciar() ya no envia nada */
+	bool suscriptora; /**< se suscribio a algun topico: al cerrarla hay que sacarla de los topicos */
+	t_devolucion* devolucion; /**< donde van las respuestas mientras la atiende un procesador (NULL en el event loop) */
+	struct t_publicacion** publicaciones; /**< cola circular de CONEXION_PUBLICACIONES por enviar (NULL hasta la primera) */
+	int primera_publicacion; /**< posicion en la cola de la proxima a enviar */
+	int cantidad_publicaciones; /**< publicaciones en la cola */
+	int enviado_publicacion; /**< bytes ya enviados de la primera: hasta terminarla no se puede enviar otro frame */
+	int64_t bytes_publicaciones; /**< bytes de las publicaciones en la cola */
+} t_conexion;
+
+/**
+ * @brief Funcion que procesa un frame completo
+ * @param conexion conexion por la que llego el frame
+ * @param cod_op codigo de operacion recibido
+ * @param payload datos del frame, en la version de conexion->lector->version (apuntan dentro del lector: solo son validos durante la llamada)
+ * @param size tamanio del payload
+ * @note Con procesadores se llama desde los hilos del pool, nunca a la vez para la misma conexion: solo puede
+ * leer de la conexion su version y su fd, y contestar con conexion_reservar_respuesta() y conexion_confirmar()
+ */
+typedef void (*t_procesar_frame)(t_conexion* conexion, int cod_op, void* payload, int size);
+
+/**
+ * @brief Crea el estado de una conexion nueva
+ * @param fd socket del cliente ya aceptado y en modo no bloqueante
+ * @param buzon buzon del event loop que la atiende si hay procesadores (ver procesadores.h), NULL si no
+ * @return conexion lista para recibir su primer frame
+ */
+t_conexion* conexion_crear(int fd, struct t_buzon* buzon);
+
+/**
+ * @brief Lee lo disponible en el socket (hasta CONEXION_PRESUPUESTO_LECTURA) y procesa cada frame que se complete
+ * @param conexion conexion con datos pendientes
+ * @param procesar funcion a llamar por cada frame completo
+ * @return 0 si se vacio el socket (EAGAIN), el cliente cerro su lado (ver conexion_terminada()) o la conexion quedo
+ * pausada, 1 si se agoto el presupuesto y quedan datos (hay que volver a llamarla aunque no llegue otro evento),
+ * -1 si el cliente mando algo invalido o hubo un error
+ * @note Con epoll edge-triggered hay que leer hasta vaciar el socket: eso ya lo hace internamente, salvo que devuelva 1.
+ * Cada recv() trae todo lo que entre en el lector, y se procesan todos los frames completos que haya.
+ * Al final se envian las respuestas que hayan generado (ver conexion_vaciar())
+ */
+int conexion_leer(t_conexion* conexion, t_procesar_frame procesar);
+
+/**
+ * @brief Procesa bytes que ya fueron recibidos por otro medio (ej. io_uring)
+ * @param conexion conexion a la que pertenecen los bytes
+ * @param datos bytes recibidos, en el orden en que llegaron
+ * @param cantidad cantidad de bytes
+ * @param procesar funcion a llamar por cada frame completo
+ * @return 0 si todo bien, -1 si el frame o el handshake es invalido o fallo el envio de las respuestas
+ * @note Los bytes se copian al lector: @p datos se puede reutilizar apenas retorna.
+ * Si la conexion esta pausada solo se guardan: se procesan con conexion_retomar()
+ */
+int conexion_consumir(t_conexion* conexion, const void* datos, int cantidad, t_procesar_frame procesar);
+
+/**
+ * @brief Procesa los frames que quedaron en el lector cuando se pauso la conexion, y envia sus respuestas
+ * @return 0 si todo bien (puede volver a quedar pausada), -1 si algun frame es invalido o fallo el envio
+ * @note Despues de conexion_reanudar(): con io_uring no llegan mas datos si el cliente ya mando todo.
+ * conexion_leer() la llama antes de leer el socket
+ */
+int conexion_retomar(t_conexion* conexion, t_procesar_frame procesar);
+
+/**
+ * @brief Agrega una respuesta al buffer de salida y devuelve donde escribir su payload
+ * @param conexion conexion a la que se responde
+ * @param cod_op codigo de operacion de la respuesta (ej. RESPUESTA)
+ * @param size tamanio del payload
+ * @return puntero a @p size bytes dentro del buffer de salida (valido hasta la proxima llamada)
+ * @note El encabezado va en la version de la conexion y, si el frame que se esta procesando trae id, con ese id.
+ * No envia nada: eso lo hace conexion_vaciar()
+ */
+uint8_t* conexion_reservar_respuesta(t_conexion* conexion, int cod_op, int size);
+
+/**
+ * @brief Contesta con un ACK el frame que se esta procesando, si trae id y todavia no se contesto
+ * @param conexion conexion por la que llego el frame
+ * @param resultado PROTOCOLO_ACK_OK o PROTOCOLO_ACK_ERROR
+ * @note Los frames sin id no se contestan: un cliente sin PROTOCOLO_CAPACIDAD_IDS no espera nada
+ */
+void conexion_confirmar(t_conexion* conexion, uint8_t resultado);
+
+/**
+ * @brief Envia todo lo que se pueda del buffer de salida y de la cola de publicaciones, sin bloquear
+ * @return 0 si se envio todo, 1 si quedo algo pendiente (el socket esta lleno), -1 si fallo la conexion (o la persistencia)
+ */
+int conexion_vaciar(t_conexion* conexion);
+
+/**
+ * @brief Indica si hay respuestas o publicaciones esperando a que el socket tenga lugar
+ */
+bool conexion_salida_pendiente(t_conexion* conexion);
+
+/**
+ * @brief Indica si hay que dejar de leer a la conexion porque su salida paso CONEXION_SALIDA_ALTA
+ * @note Lo decide conexion_leer()/conexion_consumir(); el event loop solo tiene que dejar de pedir datos
+ */
+bool conexion_pausada(t_conexion* conexion);
+
+/**
+ * @brief Despues de vaciar la salida, saca la pausa si bajo de CONEXION_SALIDA_BAJA (y devuelve el credito retenido)
+ * @return true si se reanudo: el event loop tiene que volver a leer (los datos que llegaron durante la pausa no avisan de nuevo)
+ */
+bool conexion_reanudar(t_conexion* conexion);
+
+/**
+ * @brief Indica si un cliente que cerro su lado ya tiene todo contestado: leido hasta el fin, sin tareas en los
+ * procesadores y con la salida enviada
+ * @note El event loop la cierra recien entonces: con un shutdown(SHUT_WR) el cliente igual espera sus respuestas
+ */
+bool conexion_terminada(t_conexion* conexion);
+
+/**
+ * @brief Procesa, desde un hilo del pool, todas las tareas que tenga la conexion y entrega las respuestas a su buzon
+ * @param conexion conexion programada (con programada en true y una referencia para quien la atiende)
+ * @param procesar funcion a llamar por cada tarea
+ * @return true si llegaron mas tareas y la sigue teniendo quien llamo (hay que volver a llamarla),
+ * false si la solto (puede haberse liberado: no se la puede volver a tocar)
+ */
+bool conexion_procesar_tareas(t_conexion* conexion, t_procesar_frame procesar);
+
+/**
+ * @brief Agrega a la salida las respuestas de una devolucion (o encola su publicacion), devuelve su credito y la libera
+ * @param devolucion devolucion sacada del buzon (la libera)
+ * @return true si la conexion sigue abierta (hay que enviar su salida y ver si se reanuda), false si ya estaba
+ * cerrada (se descarto lo devuelto y la conexion puede haberse liberado)
+ * @note Solo desde el event loop de la conexion
+ */
+bool conexion_recoger(t_devolucion* devolucion);
+
+/**
+ * @brief Cierra el socket y libera el estado de la conexion
+ * @param conexion conexion a destruir
+ * @note Si todavia hay tareas en los procesadores la memoria se libera cuando vuelva la ultima devolucion
+ */
+void conexion_destruir(t_conexion* conexion);
+
+#endif /* CONEXION_H_ */
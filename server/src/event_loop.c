@@ -0,0 +1,222 @@
+/**
+ * @file event_loop.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del event loop del servidor
+ *
+ * El socket de escucha se registra con data.ptr = NULL y cada cliente con data.ptr = su t_conexion,
+ * asi al volver de epoll_wait() se sabe directamente a quien pertenece cada evento.
+ * Las conexiones que agotan su presupuesto de lectura quedan en una lista de pendientes: se siguen leyendo
+ * en la proxima vuelta, despues de atender los eventos nuevos (epoll no vuelve a avisar por esos datos).
+ * Tambien se registra el eventfd del buzon (data.ptr = el buzon): cuando avisa se recogen las devoluciones de los
+ * procesadores y las publicaciones para los suscriptores, y se envian como cualquier otra respuesta.
+ * @see https://man7.org/linux/man-pages/man7/epoll.7.html
+ */
+
+#include "event_loop.h"
+
+/**
+ * @brief Conexiones con datos sin leer porque agotaron su presupuesto
+ */
+typedef struct
+{
+	t_conexion** conexiones;
+	int cantidad;
+	int capacidad;
+} t_pendientes;
+
+static void agregar_pendiente(t_pendientes* pendientes, t_conexion* conexion)
+{
+	if(conexion->lectura_pendiente)
+		return;
+	if(pendientes->cantidad == pendientes->capacidad) {
+		pendientes->capacidad = pendientes->capacidad > 0 ? pendientes->capacidad * 2 : 64;
+		pendientes->conexiones = realloc(pendientes->conexiones, pendientes->capacidad * sizeof(t_conexion*));
+	}
+	pendientes->conexiones[pendientes->cantidad++] = conexion;
+	conexion->lectura_pendiente = true;
+}
+
+static void quitar_pendiente(t_pendientes* pendientes, t_conexion* conexion)
+{
+	if(!conexion->lectura_pendiente)
+		return;
+	for(int i = 0; i < pendientes->cantidad; i++)
+		if(pendientes->conexiones[i] == conexion) {
+			pendientes->conexiones[i] = pendientes->conexiones[--pendientes->cantidad];
+			break;
+		}
+	conexion->lectura_pendiente = false;
+}
+
+/**
+ * @brief Sube el limite de fds abiertos al maximo permitido (por defecto suele ser 1024)
+ */
+static void elevar_limite_descriptores(void)
+{
+	struct rlimit limite;
+	if(getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max) {
+		limite.rlim_cur = limite.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limite);
+	}
+}
+
+/**
+ * @brief Acepta todos los clientes pendientes y los registra en epoll
+ * @note Edge-triggered: si no se vacia la cola de listen() no vuelve a llegar el aviso
+ */
+static void aceptar_pendientes(int epoll_fd, int socket_servidor, t_buzon* buzon)
+{
+	int socket_cliente;
+	while((socket_cliente = aceptar_cliente(socket_servidor)) != -1) {
+		t_conexion* conexion = conexion_crear(socket_cliente, buzon);
+		// EPOLLOUT: con edge-triggered solo avisa cuando el socket vuelve a tener lugar (para las respuestas pendientes)
+		struct epoll_event evento = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = conexion };
+		if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket_cliente, &evento) == -1) {
+			log_error(logger, "No se pudo registrar al cliente (fd %d) en epoll", socket_cliente);
+			conexion_destruir(conexion);
+		}
+	}
+	if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		log_warning(logger, "accept fallo: %s", strerror(errno)); // ej. EMFILE: se reintenta en el proximo evento
+}
+
+/**
+ * @brief Saca al cliente de epoll y libera su conexion, sin afectar al resto
+ */
+static void desconectar(int epoll_fd, t_pendientes* pendientes, t_conexion* conexion)
+{
+	log_info(logger, "El cliente (fd %d) se desconecto", conexion->fd);
+	quitar_pendiente(pendientes, conexion);
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conexion->fd, NULL);
+	conexion_destruir(conexion);
+}
+
+/**
+ * @brief Indica si hay que desconectar al cliente despues de leerlo o enviarle
+ * @param estado lo que devolvio conexion_leer() o conexion_vaciar()
+ * @note Un cliente que cerro su lado se desconecta recien con todo contestado: no va a llegar otro evento que lo avise
+ */
+static bool cerro(t_conexion* conexion, int estado)
+{
+	return estado == -1 || conexion_terminada(conexion);
+}
+
+/**
+ * @brief Recoge lo que devolvieron los procesadores y las publicaciones, y envia la salida de cada conexion
+ */
+static void recoger_devoluciones(int epoll_fd, t_pendientes* pendientes, t_buzon* buzon, t_procesar_frame procesar)
+{
+	uint64_t avisos;
+	while(read(buzon->aviso, &avisos, sizeof(avisos)) == -1 && errno == EINTR);
+	t_devolucion* devolucion = buzon_recoger(buzon);
+	while(devolucion != NULL) {
+		t_devolucion* siguiente = (t_devolucion*) devolucion->nodo.siguiente;
+		t_conexion* conexion = devolucion->conexion;
+		if(conexion_recoger(devolucion)) {
+			int estado = conexion_vaciar(conexion);
+			// Lo recogido puede sacarla de la pausa: lo que llego mientras tanto no genera otro evento
+			if(estado != -1 && conexion_reanudar(conexion) && !conexion->lectura_pendiente)
+				estado = conexion_leer(conexion, procesar);
+			if(estado == 1)
+				agregar_pendiente(pendientes, conexion);
+			else if(cerro(conexion, estado))
+				desconectar(epoll_fd, pendientes, conexion);
+		}
+		devolucion = siguiente;
+	}
+}
+
+int ejecutar_event_loop(int socket_servidor, t_procesar_frame procesar)
+{
+	elevar_limite_descriptores();
+
+	int epoll_fd = epoll_create1(0);
+	if(epoll_fd == -1 || configurar_no_bloqueante(socket_servidor) == -1) {
+		log_error(logger, "No se pudo iniciar el event loop: %s", strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	struct epoll_event evento_servidor = { .events = EPOLLIN | EPOLLET, .data.ptr = NULL };
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket_servidor, &evento_servidor);
+
+	// Sin buzon los frames se procesan en este hilo y sus clientes no se pueden suscribir
+	t_buzon* buzon = buzon_crear();
+	if(buzon != NULL) {
+		struct epoll_event evento_buzon = { .events = EPOLLIN, .data.ptr = buzon };
+		if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, buzon->aviso, &evento_buzon) == -1) {
+			buzon_destruir(buzon);
+			buzon = NULL;
+		}
+	}
+	if(buzon == NULL)
+		log_warning(logger, "No se pudo crear el buzon del event loop: procesa sus frames en su hilo y sin suscripciones");
+
+	struct epoll_event eventos[MAX_EVENTOS];
+	t_pendientes pendientes = { .conexiones = NULL, .cantidad = 0, .capacidad = 0 };
+	while(1) {
+		// Bloquea hasta que haya actividad, salvo que haya conexiones con datos sin leer
+		int cantidad = epoll_wait(epoll_fd, eventos, MAX_EVENTOS, pendientes.cantidad > 0 ? 0 : -1);
+		if(cantidad == -1) {
+			if(errno == EINTR)
+				continue;
+			log_error(logger, "epoll_wait fallo: %s", strerror(errno));
+			close(epoll_fd);
+			free(pendientes.conexiones);
+			return EXIT_FAILURE;
+		}
+
+		bool avisado = false;
+		for(int i = 0; i < cantidad; i++) {
+			t_conexion* conexion = eventos[i].data.ptr;
+			if(conexion == NULL) { // actividad en el socket de escucha
+				aceptar_pendientes(epoll_fd, socket_servidor, buzon);
+				continue;
+			}
+			if(conexion == (void*) buzon) { // se recoge despues: puede desconectar clientes con eventos en esta tanda
+				avisado = true;
+				continue;
+			}
+
+			// Primero se lee lo que haya: un cliente puede mandar datos y cerrar en el mismo evento.
+			// El cierre se guarda: si quedan datos sin leer o respuestas en camino, epoll no lo vuelve a avisar (ver cerro()).
+			if(eventos[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+				conexion->cerro_cliente = true;
+			int estado = 0;
+			if((eventos[i].events & ~EPOLLOUT) && !conexion->lectura_pendiente)
+				estado = conexion_leer(conexion, procesar);
+			// El socket volvio a tener lugar (o fallo): se sigue con las respuestas que no entraron.
+			// Si no se pueden enviar hay que desconectar aca: pausada, conexion_leer() no llega al recv() que veria el error
+			if(estado != -1 && (eventos[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && conexion_salida_pendiente(conexion)) {
+				if(conexion_vaciar(conexion) == -1)
+					estado = -1;
+				else if(conexion_reanudar(conexion))
+					estado = conexion_leer(conexion, procesar); // lo que llego durante la pausa no genera otro evento
+			}
+			if(estado == 1)
+				agregar_pendiente(&pendientes, conexion);
+			// Con datos sin leer el cierre se atiende despues de leerlos (en la tanda de pendientes) y con tareas en los
+			// procesadores, al recoger sus respuestas
+			if(cerro(conexion, estado))
+				desconectar(epoll_fd, &pendientes, conexion);
+		}
+
+		// Respuestas de los procesadores
+		if(avisado)
+			recoger_devoluciones(epoll_fd, &pendientes, buzon, procesar);
+
+		// Otra tanda de las conexiones que agotaron su presupuesto (las que lo vuelvan a agotar quedan para la proxima)
+		int tanda = pendientes.cantidad;
+		for(int i = 0; i < tanda; i++) {
+			t_conexion* conexion = pendientes.conexiones[i];
+			conexion->lectura_pendiente = false;
+			int estado = conexion_leer(conexion, procesar);
+			if(estado == 1)
+				agregar_pendiente(&pendientes, conexion); // va al final, despues de la tanda
+			else if(cerro(conexion, estado))
+				desconectar(epoll_fd, &pendientes, conexion);
+		}
+		pendientes.cantidad -= tanda;
+		memmove(pendientes.conexiones, pendientes.conexiones + tanda, pendientes.cantidad * sizeof(t_conexion*));
+	}
+}
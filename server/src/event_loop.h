@@ -0,0 +1,36 @@
+/**
+ * @file event_loop.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del event loop del servidor
+ *
+ * Un unico hilo atiende a todos los clientes con epoll (edge-triggered):
+ * el kernel avisa que sockets tienen datos y solo se lee de esos.
+ * @see https://man7.org/linux/man-pages/man7/epoll.7.html
+ */
+
+#ifndef EVENT_LOOP_H_
+#define EVENT_LOOP_H_
+
+// Librerias standard de POSIX/Linux
+#include<sys/epoll.h> // epoll_create1, epoll_ctl, epoll_wait
+#include<sys/resource.h> // getrlimit/setrlimit para poder abrir miles de sockets
+
+// Inclusión de la conexion (y de las utilidades)
+#include "conexion.h"
+// Inclusión del pool de procesadores (buzon del event loop)
+#include "procesadores.h"
+
+/* Cantidad maxima de eventos que se piden al kernel en cada epoll_wait() */
+#define MAX_EVENTOS 256
+
+/**
+ * @brief Atiende a todos los clientes que se conecten al socket de escucha
+ * @param socket_servidor fd del socket ya bindeado y en escucha (ver iniciar_servidor())
+ * @param procesar funcion que se llama por cada frame completo de cualquier cliente
+ * @return EXIT_FAILURE si no se pudo armar el event loop (en funcionamiento normal no retorna)
+ * @note La desconexion de un cliente solo cierra su conexion, el servidor sigue atendiendo al resto
+ */
+int ejecutar_event_loop(int socket_servidor, t_procesar_frame procesar);
+
+#endif /* EVENT_LOOP_H_ */
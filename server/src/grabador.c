@@ -0,0 +1,122 @@
+/**
+ * @file grabador.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del grabador de capturas de trafico del servidor
+ *
+ * Mismo esquema de doble buffer que la persistencia: los workers copian el registro con el mutex tomado
+ * y el escritor intercambia los buffers y hace un write() por lote, sin el mutex.
+ * El archivo se escribe solo con registros enteros: si el servidor muere, a lo sumo se pierde el ultimo lote.
+ */
+
+#include "grabador.h"
+
+t_grabador* grabador;
+
+static void* escribir_capturas(void* arg);
+
+static uint64_t ahora_ns(clockid_t reloj)
+{
+	struct timespec ahora;
+	clock_gettime(reloj, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+}
+
+t_grabador* grabador_crear(char* ruta, size_t capacidad)
+{
+	int archivo = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(archivo == -1)
+		return NULL;
+	uint8_t cabecera[CAPTURA_CABECERA];
+	captura_codificar_cabecera(cabecera, ahora_ns(CLOCK_REALTIME));
+	if(escribir_todo(archivo, cabecera, sizeof(cabecera), -1) == -1) {
+		close(archivo);
+		return NULL;
+	}
+
+	t_grabador* grabador = calloc(1, sizeof(t_grabador));
+	grabador->archivo = archivo;
+	grabador->inicio = ahora_ns(CLOCK_MONOTONIC);
+	grabador->capacidad = capacidad;
+	grabador->pendientes = malloc(capacidad);
+	grabador->escribiendo = malloc(capacidad);
+	grabador->activo = true;
+	pthread_mutex_init(&grabador->mutex, NULL);
+	pthread_cond_init(&grabador->hay_pendientes, NULL);
+	pthread_create(&grabador->escritor, NULL, escribir_capturas, grabador);
+	return grabador;
+}
+
+void grabador_agregar(t_grabador* grabador, int cod_op, int version, const void* payload, int size)
+{
+	uint8_t encabezado[CAPTURA_ENCABEZADO];
+	captura_codificar_registro(encabezado, cod_op, version, ahora_ns(CLOCK_MONOTONIC) - grabador->inicio, size);
+	size_t largo = CAPTURA_ENCABEZADO + size;
+
+	pthread_mutex_lock(&grabador->mutex);
+	if(grabador->cantidad_pendientes + largo > grabador->capacidad) {
+		grabador->descartados++;
+		pthread_mutex_unlock(&grabador->mutex);
+		return;
+	}
+	uint8_t* destino = grabador->pendientes + grabador->cantidad_pendientes;
+	memcpy(destino, encabezado, CAPTURA_ENCABEZADO);
+	memcpy(destino + CAPTURA_ENCABEZADO, payload, size);
+	grabador->cantidad_pendientes += largo;
+	grabador->grabados++;
+	// Pasada la mitad se despierta al escritor sin esperar el intervalo: asi casi nunca se llega a descartar
+	if(grabador->cantidad_pendientes - largo < grabador->capacidad / 2 && grabador->cantidad_pendientes >= grabador->capacidad / 2)
+		pthread_cond_signal(&grabador->hay_pendientes);
+	pthread_mutex_unlock(&grabador->mutex);
+}
+
+static void* escribir_capturas(void* arg)
+{
+	t_grabador* grabador = arg;
+	pthread_mutex_lock(&grabador->mutex);
+	while(grabador->activo || grabador->cantidad_pendientes > 0) {
+		if(grabador->cantidad_pendientes == 0 || (grabador->activo && grabador->cantidad_pendientes < grabador->capacidad / 2)) {
+			struct timespec limite;
+			clock_gettime(CLOCK_REALTIME, &limite);
+			limite.tv_nsec += GRABADOR_INTERVALO_MS * 1000000L;
+			if(limite.tv_nsec >= 1000000000L) {
+				limite.tv_sec++;
+				limite.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait(&grabador->hay_pendientes, &grabador->mutex, &limite);
+			if(grabador->cantidad_pendientes == 0)
+				continue;
+		}
+
+		uint8_t* lote = grabador->pendientes;
+		size_t cantidad = grabador->cantidad_pendientes;
+		grabador->pendientes = grabador->escribiendo;
+		grabador->cantidad_pendientes = 0;
+		grabador->escribiendo = lote;
+		pthread_mutex_unlock(&grabador->mutex);
+
+		if(escribir_todo(grabador->archivo, lote, cantidad, -1) == -1)
+			log_error(logger, "Captura: no se pudo escribir un lote de %zu bytes: %s", cantidad, strerror(errno));
+
+		pthread_mutex_lock(&grabador->mutex);
+	}
+	pthread_mutex_unlock(&grabador->mutex);
+	return NULL;
+}
+
+void grabador_destruir(t_grabador* grabador)
+{
+	pthread_mutex_lock(&grabador->mutex);
+	grabador->activo = false;
+	pthread_cond_signal(&grabador->hay_pendientes);
+	pthread_mutex_unlock(&grabador->mutex);
+	pthread_join(grabador->escritor, NULL); // el escritor termina despues de vaciar lo pendiente
+
+	log_info(logger, "Captura: %" PRIu64 " frames grabados, %" PRIu64 " descartados", grabador->grabados, grabador->descartados);
+	close(grabador->archivo);
+	pthread_cond_destroy(&grabador->hay_pendientes);
+	pthread_mutex_destroy(&grabador->mutex);
+	free(grabador->pendientes);
+	free(grabador->escribiendo);
+	free(grabador);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file grabador.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del grabador de capturas de trafico del servidor
+ *
+ * Con CAPTURA_ARCHIVO en servidor.config, cada frame que llega a procesar_operacion() se guarda
+ * en un archivo de captura (formato en captura.h) para reproducirlo despues con el replay.
+ * A diferencia de la persistencia, la captura es de mejor esfuerzo: no hace fdatasync() y, si el disco
+ * no da abasto, descarta frames (y los cuenta) en lugar de frenar a los workers.
+ */
+
+#ifndef GRABADOR_H_
+#define GRABADOR_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint64_t
+#include<stdbool.h> // bool
+#include<inttypes.h> // PRIu64
+#include<time.h> // instante de cada frame
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilo escritor
+
+// Formato de los archivos de captura (compartido con el replay)
+#include<captura.h>
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Bytes por defecto que se acumulan sin escribir (CAPTURA_BUFFER_MB en servidor.config) */
+#define GRABADOR_BUFFER_DEFECTO (4 * 1024 * 1024)
+
+/* Cada cuanto el escritor vuelca lo acumulado aunque el buffer no se haya llenado */
+#define GRABADOR_INTERVALO_MS 100
+
+/**
+ * @brief Grabador de una captura
+ */
+typedef struct
+{
+	int archivo; /**< fd del archivo de captura */
+	uint64_t inicio; /**< CLOCK_MONOTONIC al abrir, en ns (los instantes son relativos a este) */
+	size_t capacidad; /**< bytes de cada buffer */
+
+	uint8_t* pendientes; /**< registros encolados por los workers */
+	size_t cantidad_pendientes; /**< bytes usados de pendientes */
+	uint8_t* escribiendo; /**< buffer que esta escribiendo el escritor (se intercambia con pendientes) */
+
+	uint64_t grabados; /**< frames escritos en el archivo */
+	uint64_t descartados; /**< frames que no entraron en el buffer */
+	bool activo; /**< false cuando se esta cerrando */
+
+	pthread_mutex_t mutex; /**< protege pendientes y los contadores */
+	pthread_cond_t hay_pendientes; /**< despierta al escritor antes del intervalo */
+	pthread_t escritor;
+} t_grabador;
+
+// Declaracion de variable global (NULL si CAPTURA_ARCHIVO no esta en servidor.config)
+extern t_grabador* grabador;
+
+/**
+ * @brief Crea (o trunca) el archivo de captura y lanza el hilo escritor
+ * @param ruta archivo de captura
+ * @param capacidad bytes de cada buffer (un frame mas grande no se graba)
+ * @return el grabador, o NULL si no se pudo crear el archivo
+ */
+t_grabador* grabador_crear(char* ruta, size_t capacidad);
+
+/**
+ * @brief Encola un frame para grabarlo
+ * @param grabador grabador abierto
+ * @param cod_op codigo de operacion del frame
+ * @param version version de protocolo de la conexion
+ * @param payload datos del frame (se copian)
+ * @param size tamanio del payload
+ * @note Nunca espera al disco: si no hay lugar en el buffer el frame se descarta
+ */
+void grabador_agregar(t_grabador* grabador, int cod_op, int version, const void* payload, int size);
+
+/**
+ * @brief Escribe lo pendiente, frena el escritor, cierra el archivo y libera el grabador
+ */
+void grabador_destruir(t_grabador* grabador);
+
+#endif /* GRABADOR_H_ */
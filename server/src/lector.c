@@ -0,0 +1,212 @@
+/**
+ * @file lector.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del buffer de lectura por conexion
+ *
+ * Los bytes pendientes se mueven al principio (compactar) solo cuando hace falta lugar,
+ * y el buffer crece solo cuando un frame no entra entero.
+ * @see https://docs.utnso.com.ar/guias/linux/sockets
+ */
+
+#include "lector.h"
+#include "paquete_vista.h"
+#include "metricas.h"
+
+t_lector* lector_crear(int capacidad)
+{
+	t_lector* lector = malloc(sizeof(t_lector));
+	lector->datos = malloc(capacidad);
+	lector->capacidad = capacidad;
+	lector->inicio = 0;
+	lector->fin = 0;
+	lector->version = PROTOCOLO_VERSION_1;
+	lector->descartar = 0;
+	return lector;
+}
+
+/**
+ * @brief Deja al menos @p necesarios bytes libres al final, compactando o agrandando
+ */
+static void asegurar_espacio(t_lector* lector, int necesarios)
+{
+	int pendientes = lector->fin - lector->inicio;
+	if(lector->capacidad - lector->fin >= necesarios)
+		return;
+
+	// Primero se intenta recuperar lo ya procesado moviendo los pendientes al principio
+	if(lector->inicio > 0) {
+		memmove(lector->datos, lector->datos + lector->inicio, pendientes);
+		lector->inicio = 0;
+		lector->fin = pendientes;
+		if(lector->capacidad - lector->fin >= necesarios)
+			return;
+	}
+
+	int capacidad = lector->capacidad;
+	while(capacidad - pendientes < necesarios)
+		capacidad *= 2;
+	lector->datos = realloc(lector->datos, capacidad);
+	lector->capacidad = capacidad;
+	metricas_reservas(1);
+}
+
+int lector_llenar(t_lector* lector, int socket)
+{
+	if(lector->inicio == lector->fin) // todo procesado: se vuelve al principio sin mover nada
+		lector->inicio = lector->fin = 0;
+	else if(lector->capacidad - lector->fin < lector->capacidad / 4)
+		asegurar_espacio(lector, lector->capacidad / 4); // que el recv() no quede limitado a unos pocos bytes
+
+	int recibidos = recv(socket, lector->datos + lector->fin, lector->capacidad - lector->fin, 0);
+	if(recibidos > 0)
+		lector->fin += recibidos;
+	return recibidos;
+}
+
+void lector_agregar(t_lector* lector, const void* datos, int cantidad)
+{
+	if(lector->inicio == lector->fin)
+		lector->inicio = lector->fin = 0;
+	asegurar_espacio(lector, cantidad);
+	memcpy(lector->datos + lector->fin, datos, cantidad);
+	lector->fin += cantidad;
+}
+
+void* lector_pendientes(t_lector* lector, int* disponibles)
+{
+	*disponibles = lector->fin - lector->inicio;
+	return lector->datos + lector->inicio;
+}
+
+void lector_descartar(t_lector* lector, int bytes)
+{
+	lector->inicio += bytes;
+}
+
+/**
+ * @brief Tira los bytes ya recibidos del frame que se esta descartando
+ * @return bytes del frame que todavia faltan llegar
+ */
+static uint32_t descartar_recibidos(t_lector* lector)
+{
+	uint32_t pendientes = lector->fin - lector->inicio;
+	uint32_t tirados = pendientes < lector->descartar ? pendientes : lector->descartar;
+	lector->inicio += tirados;
+	lector->descartar -= tirados;
+	return lector->descartar;
+}
+
+/**
+ * @brief Indica si hay un frame completo pendiente (sin consumirlo)
+ * @return 1 si lo hay (y deja su encabezado en @p encabezado), 0 si falta recibir, -1 si es invalido,
+ * LECTOR_FRAME_DESCARTADO si es demasiado grande (ese si se consume: su encabezado y lo que haya llegado del payload)
+ */
+static int hay_frame_completo(t_lector* lector, t_encabezado* encabezado)
+{
+	if(lector->descartar > 0 && descartar_recibidos(lector) > 0)
+		return 0; // sigue llegando el frame descartado
+
+	int pendientes = lector->fin - lector->inicio;
+	int estado = protocolo_decodificar_encabezado(lector->version, (uint8_t*) lector->datos + lector->inicio, pendientes, encabezado);
+	if(estado != 1)
+		return estado; // encabezado incompleto o invalido
+
+	// El size lo manda el cliente: se valida antes de hacerle lugar (si no, un frame corrupto podria pedir gigas)
+	if(encabezado->size > limites.frame_maximo) {
+		lector->inicio += encabezado->encabezado;
+		lector->descartar = encabezado->size;
+		descartar_recibidos(lector);
+		return LECTOR_FRAME_DESCARTADO;
+	}
+
+	int64_t total = (int64_t) encabezado->encabezado + encabezado->size;
+	if(total > INT32_MAX)
+		return -1; // no entra en un int: solo puede ser basura
+	if(pendientes < total) {
+		// Frame cortado: se hace lugar para que la proxima lectura lo pueda completar
+		asegurar_espacio(lector, total - pendientes);
+		return 0;
+	}
+	return 1;
+}
+
+int lector_siguiente_frame(t_lector* lector, t_encabezado* encabezado, void** payload)
+{
+	int estado = hay_frame_completo(lector, encabezado);
+	if(estado != 1) {
+		*payload = NULL;
+		return estado;
+	}
+
+	*payload = lector->datos + lector->inicio + encabezado->encabezado;
+	lector->inicio += encabezado->encabezado + encabezado->size;
+	return 1;
+}
+
+int lector_recibir_operacion(t_lector* lector, int socket_cliente)
+{
+	int estado;
+	t_encabezado encabezado;
+	// Un solo recv() puede traer varios frames: solo se vuelve al socket si no hay ninguno completo
+	while((estado = hay_frame_completo(lector, &encabezado)) == 0 || estado == LECTOR_FRAME_DESCARTADO) {
+		if(estado == LECTOR_FRAME_DESCARTADO) {
+			log_warning(logger, "Frame de %u bytes descartado (maximo %u, fd %d)", encabezado.size, limites.frame_maximo, socket_cliente);
+			continue;
+		}
+		if(lector_llenar(lector, socket_cliente) <= 0) {
+			estado = -1;
+			break;
+		}
+	}
+	if(estado == -1) {
+		close(socket_cliente); // se cierra el socket, igual que recibir_operacion()
+		return -1;
+	}
+
+	return encabezado.cod_op;
+}
+
+void* lector_recibir_buffer(t_lector* lector, int* size)
+{
+	t_encabezado encabezado;
+	void* payload;
+	if(lector_siguiente_frame(lector, &encabezado, &payload) != 1)
+		return NULL;
+	*size = encabezado.size;
+	return payload;
+}
+
+void lector_recibir_mensaje(t_lector* lector)
+{
+	int size;
+	char* buffer = lector_recibir_buffer(lector, &size);
+	if(buffer != NULL)
+		log_info(logger, "Me llego el mensaje: %.*s", size, buffer);
+}
+
+t_list* lector_recibir_paquete(t_lector* lector)
+{
+	int size;
+	void* buffer = lector_recibir_buffer(lector, &size);
+	if(buffer == NULL)
+		return list_create();
+	// Se copian los elementos: el buffer sigue siendo del lector
+	t_list* valores = list_create();
+	t_paquete_vista* vista = paquete_vista_crear(buffer, size, lector->version, false);
+	if(vista == NULL)
+		return valores;
+	for(int i = 0; i < vista->cantidad; i++) {
+		int tamanio;
+		void* elemento = paquete_vista_elemento(vista, i, &tamanio);
+		list_add(valores, memcpy(malloc(tamanio), elemento, tamanio));
+	}
+	paquete_vista_destruir(vista);
+	return valores;
+}
+
+void lector_destruir(t_lector* lector)
+{
+	free(lector->datos);
+	free(lector);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file lector.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del buffer de lectura por conexion
+ *
+ * En lugar de un recv(MSG_WAITALL) por campo (cod_op, size, payload), se lee de una vez todo lo
+ * que haya en el socket y despues se separan todos los frames completos que contenga.
+ * Los frames que quedan cortados entre dos lecturas se completan en la siguiente.
+ * @see https://docs.utnso.com.ar/guias/linux/sockets
+ */
+
+#ifndef LECTOR_H_
+#define LECTOR_H_
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Capacidad con la que arranca cada lector. Crece si llega un frame mas grande (hasta limites.frame_maximo) */
+#define LECTOR_CAPACIDAD_INICIAL 16384
+
+/* lector_siguiente_frame(): el frame supera limites.frame_maximo y su payload se descarta a medida que llega */
+#define LECTOR_FRAME_DESCARTADO 2
+
+/**
+ * @brief Bytes recibidos de un socket que todavia no se procesaron
+ *
+ * | ya procesado | datos[inicio..fin) pendientes | libre |
+ */
+typedef struct
+{
+	char* datos; /**< memoria del buffer */
+	int capacidad; /**< tamanio de datos */
+	int inicio; /**< primer byte sin procesar */
+	int fin; /**< primer byte libre */
+	int version; /**< version de protocolo con la que se separan los frames (PROTOCOLO_VERSION_1 hasta que haya handshake) */
+	uint32_t descartar; /**< bytes de un frame descartado que todavia faltan llegar (se tiran sin guardarlos) */
+} t_lector;
+
+/**
+ * @brief Crea un lector vacio
+ * @param capacidad capacidad inicial en bytes (ej. LECTOR_CAPACIDAD_INICIAL)
+ */
+t_lector* lector_crear(int capacidad);
+
+/**
+ * @brief Hace un unico recv() con todo el espacio libre del lector
+ * @param lector lector del socket
+ * @param socket fd del que se lee
+ * @return lo mismo que recv(): bytes leidos, 0 si el otro extremo cerro, -1 si error (ver errno)
+ */
+int lector_llenar(t_lector* lector, int socket);
+
+/**
+ * @brief Agrega bytes ya recibidos por otro medio (ej. un buffer de io_uring)
+ * @param lector lector de la conexion
+ * @param datos bytes a copiar al final de lo pendiente
+ * @param cantidad cantidad de bytes
+ */
+void lector_agregar(t_lector* lector, const void* datos, int cantidad);
+
+/**
+ * @brief Devuelve los bytes pendientes sin consumirlos
+ * @param lector lector con bytes pendientes
+ * @param disponibles donde guardar la cantidad de bytes pendientes
+ * @return puntero al primer byte pendiente (ej. para mirar si llego el handshake)
+ */
+void* lector_pendientes(t_lector* lector, int* disponibles);
+
+/**
+ * @brief Da por procesados los primeros @p bytes pendientes
+ */
+void lector_descartar(t_lector* lector, int bytes);
+
+/**
+ * @brief Separa el siguiente frame completo, si lo hay
+ * @param lector lector con bytes pendientes
+ * @param encabezado donde guardar cod_op, flags y size del frame
+ * @param payload donde guardar el puntero al payload (apunta DENTRO del lector)
+ * @return 1 si habia un frame completo (y queda consumido), 0 si falta recibir mas, -1 si el frame es invalido,
+ * LECTOR_FRAME_DESCARTADO si su size supera limites.frame_maximo (queda su encabezado en @p encabezado, pero no hay payload)
+ * @note @p payload es valido hasta la proxima llamada a cualquier otra funcion del lector (puede compactarlo).
+ * Un frame descartado no corta la conexion: el encabezado ya dice donde empieza el siguiente, asi que
+ * solo se tiran sus bytes (nunca se reserva lugar para el) y se sigue con el proximo
+ */
+int lector_siguiente_frame(t_lector* lector, t_encabezado* encabezado, void** payload);
+
+/**
+ * @brief Version de recibir_operacion() sobre el lector: bloquea hasta tener un frame completo
+ * @param lector lector del socket
+ * @param socket_cliente fd del socket (bloqueante)
+ * @return cod_op del frame, o -1 si el cliente se desconecto o el frame es invalido (y se cierra el socket, igual que recibir_operacion())
+ * @note Los frames que superan limites.frame_maximo se descartan y se espera el siguiente. No consume el frame: despues hay que llamar a lector_recibir_buffer(), lector_recibir_mensaje() o lector_recibir_paquete()
+ */
+int lector_recibir_operacion(t_lector* lector, int socket_cliente);
+
+/**
+ * @brief Version de recibir_buffer() sobre el lector: consume el frame que dejo listo lector_recibir_operacion()
+ * @param lector lector del socket
+ * @param size donde guardar el tamanio del payload
+ * @return puntero al payload dentro del lector (no hay que liberarlo), o NULL si no habia frame
+ */
+void* lector_recibir_buffer(t_lector* lector, int* size);
+
+/**
+ * @brief Version de recibir_mensaje() sobre el lector
+ */
+void lector_recibir_mensaje(t_lector* lector);
+
+/**
+ * @brief Version de recibir_paquete() sobre el lector
+ * @return lista con una copia de cada elemento (igual que recibir_paquete())
+ */
+t_list* lector_recibir_paquete(t_lector* lector);
+
+/**
+ * @brief Libera el lector y todo lo pendiente
+ */
+void lector_destruir(t_lector* lector);
+
+#endif /* LECTOR_H_ */
@@ -0,0 +1,273 @@
+/**
+ * @file log_async.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del logger asincronico del servidor
+ *
+ * La cola es la "bounded MPMC queue" de D. Vyukov usada con un unico consumidor: cada posicion tiene
+ * un numero de secuencia que dice si esta libre (secuencia == posicion) o lista para leer (secuencia == posicion + 1).
+ * Los productores reservan posicion con un compare-and-swap; el escritor no necesita ninguna operacion atomica de escritura compartida.
+ * @see https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#include "log_async.h"
+
+t_log_async* logger_async;
+
+static void* escribir_registros(void* arg);
+
+t_log_async* log_async_crear(char* archivo, char* programa, bool consola, t_log_level nivel, int capacidad, t_politica_log politica)
+{
+	int fd = open(archivo, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if(fd == -1)
+		return NULL;
+
+	size_t tamanio = 2;
+	while(tamanio < (size_t) capacidad) // la mascara solo funciona con potencias de 2
+		tamanio *= 2;
+
+	t_log_async* logger = malloc(sizeof(t_log_async));
+	logger->registros = malloc(tamanio * sizeof(t_registro_log));
+	for(size_t i = 0; i < tamanio; i++)
+		atomic_init(&logger->registros[i].secuencia, i); // todas libres
+	logger->mascara = tamanio - 1;
+	atomic_init(&logger->posicion_escritura, 0);
+	logger->posicion_lectura = 0;
+	logger->politica = politica;
+	atomic_init(&logger->descartados, 0);
+	logger->archivo = fd;
+	logger->consola = consola;
+	logger->nivel = nivel;
+	logger->programa = strdup(programa);
+	atomic_init(&logger->escritor_durmiendo, false);
+	atomic_init(&logger->activo, true);
+	pthread_mutex_init(&logger->mutex, NULL);
+	pthread_cond_init(&logger->hay_registros, NULL);
+
+	pthread_create(&logger->escritor, NULL, escribir_registros, logger);
+	return logger;
+}
+
+/**
+ * @brief Reserva una posicion libre de la cola
+ * @return el registro reservado (con su posicion en @p posicion), o NULL si la cola esta llena
+ */
+static t_registro_log* reservar_registro(t_log_async* logger, size_t* posicion)
+{
+	size_t actual = atomic_load_explicit(&logger->posicion_escritura, memory_order_relaxed);
+	while(1) {
+		t_registro_log* registro = &logger->registros[actual & logger->mascara];
+		size_t secuencia = atomic_load_explicit(&registro->secuencia, memory_order_acquire);
+		intptr_t diferencia = (intptr_t) secuencia - (intptr_t) actual;
+
+		if(diferencia == 0) { // libre: se intenta reservar
+			if(atomic_compare_exchange_weak_explicit(&logger->posicion_escritura, &actual, actual + 1,
+					memory_order_relaxed, memory_order_relaxed)) {
+				*posicion = actual;
+				return registro;
+			}
+			// otro productor la reservo primero: actual ya quedo actualizado por el CAS
+		}
+		else if(diferencia < 0)
+			return NULL; // todavia tiene un registro de la vuelta anterior: cola llena
+		else
+			actual = atomic_load_explicit(&logger->posicion_escritura, memory_order_relaxed);
+	}
+}
+
+/**
+ * @brief Arma la linea con el mismo formato que las commons: [NIVEL] HH:MM:SS:mmm Programa/(pid:tid): mensaje
+ */
+static int formatear(t_log_async* logger, char* destino, t_log_level nivel, const char* formato, va_list argumentos)
+{
+	struct timespec ahora;
+	struct tm hora;
+	clock_gettime(CLOCK_REALTIME, &ahora);
+	localtime_r(&ahora.tv_sec, &hora);
+
+	int longitud = snprintf(destino, LOG_ASYNC_TAMANIO_REGISTRO, "[%s] %02d:%02d:%02d:%03ld %s/(%d:%d): ",
+		log_level_as_string(nivel), hora.tm_hour, hora.tm_min, hora.tm_sec, ahora.tv_nsec / 1000000,
+		logger->programa, getpid(), gettid());
+	longitud += vsnprintf(destino + longitud, LOG_ASYNC_TAMANIO_REGISTRO - longitud, formato, argumentos);
+
+	if(longitud > LOG_ASYNC_TAMANIO_REGISTRO - 1)
+		longitud = LOG_ASYNC_TAMANIO_REGISTRO - 1; // truncado: se pisa el ultimo caracter con el '\n'
+	destino[longitud++] = '\n';
+	return longitud;
+}
+
+void log_async_escribir(t_log_async* logger, t_log_level nivel, const char* formato, va_list argumentos)
+{
+	if(nivel < logger->nivel)
+		return;
+
+	size_t posicion;
+	t_registro_log* registro;
+	while((registro = reservar_registro(logger, &posicion)) == NULL) {
+		if(logger->politica == LOG_DESCARTAR) {
+			atomic_fetch_add_explicit(&logger->descartados, 1, memory_order_relaxed);
+			return;
+		}
+		sched_yield(); // LOG_BLOQUEAR: se cede el CPU hasta que el escritor libere lugar
+	}
+
+	registro->longitud = formatear(logger, registro->texto, nivel, formato, argumentos);
+	// Publicar: a partir de aca el escritor puede leer el registro
+	atomic_store_explicit(&registro->secuencia, posicion + 1, memory_order_release);
+
+	// La barrera ordena "publicar" antes de "mirar si duerme" (el escritor hace lo simetrico): alguno de los dos ve al otro
+	atomic_thread_fence(memory_order_seq_cst);
+	if(atomic_load_explicit(&logger->escritor_durmiendo, memory_order_relaxed)) {
+		pthread_mutex_lock(&logger->mutex);
+		pthread_cond_signal(&logger->hay_registros);
+		pthread_mutex_unlock(&logger->mutex);
+	}
+}
+
+#define DEFINIR_NIVEL(funcion, nivel) \
+	void funcion(t_log_async* logger, const char* formato, ...) \
+	{ \
+		va_list argumentos; \
+		va_start(argumentos, formato); \
+		log_async_escribir(logger, nivel, formato, argumentos); \
+		va_end(argumentos); \
+	}
+
+DEFINIR_NIVEL(log_async_info, LOG_LEVEL_INFO)
+DEFINIR_NIVEL(log_async_warning, LOG_LEVEL_WARNING)
+DEFINIR_NIVEL(log_async_error, LOG_LEVEL_ERROR)
+
+/**
+ * @brief Escribe un lote en el archivo (y en la consola), reintentando escrituras parciales
+ */
+static void volcar(t_log_async* logger, struct iovec* iov, int cantidad)
+{
+	if(logger->consola) {
+		struct iovec copia[LOG_ASYNC_LOTE];
+		memcpy(copia, iov, cantidad * sizeof(struct iovec));
+		writev(STDOUT_FILENO, copia, cantidad);
+	}
+	while(cantidad > 0) {
+		ssize_t escritos = writev(logger->archivo, iov, cantidad);
+		if(escritos == -1) {
+			if(errno == EINTR)
+				continue;
+			return; // sin disco no hay donde avisar: se pierde el lote
+		}
+		while(cantidad > 0 && escritos >= (ssize_t) iov->iov_len) {
+			escritos -= iov->iov_len;
+			iov++;
+			cantidad--;
+		}
+		if(cantidad > 0) {
+			iov->iov_base = (char*) iov->iov_base + escritos;
+			iov->iov_len -= escritos;
+		}
+	}
+}
+
+/**
+ * @brief Toma hasta LOG_ASYNC_LOTE registros listos y los escribe en un writev()
+ * @return cantidad de registros escritos
+ */
+static int escribir_lote(t_log_async* logger)
+{
+	struct iovec iov[LOG_ASYNC_LOTE];
+	t_registro_log* tomados[LOG_ASYNC_LOTE];
+	int cantidad = 0;
+
+	while(cantidad < LOG_ASYNC_LOTE) {
+		t_registro_log* registro = &logger->registros[logger->posicion_lectura & logger->mascara];
+		size_t secuencia = atomic_load_explicit(&registro->secuencia, memory_order_acquire);
+		if(secuencia != logger->posicion_lectura + 1)
+			break; // vacia, o el productor todavia esta formateando
+		iov[cantidad].iov_base = registro->texto;
+		iov[cantidad].iov_len = registro->longitud;
+		tomados[cantidad++] = registro;
+		logger->posicion_lectura++;
+	}
+	if(cantidad == 0)
+		return 0;
+
+	volcar(logger, iov, cantidad);
+
+	// Recien ahora se liberan las posiciones (el writev leia de ellas)
+	size_t posicion = logger->posicion_lectura - cantidad;
+	for(int i = 0; i < cantidad; i++, posicion++)
+		atomic_store_explicit(&tomados[i]->secuencia, posicion + logger->mascara + 1, memory_order_release);
+	return cantidad;
+}
+
+/**
+ * @brief Avisa en el log cuantos registros se perdieron por tener la cola llena
+ */
+static void informar_descartados(t_log_async* logger)
+{
+	size_t descartados = atomic_exchange_explicit(&logger->descartados, 0, memory_order_relaxed);
+	if(descartados == 0)
+		return;
+
+	char texto[128];
+	int longitud = snprintf(texto, sizeof(texto), "[WARNING] %s: se descartaron %zu registros (cola de log llena)\n",
+		logger->programa, descartados);
+	struct iovec iov = { .iov_base = texto, .iov_len = longitud };
+	volcar(logger, &iov, 1);
+}
+
+/**
+ * @brief Indica si el proximo registro a escribir ya fue publicado
+ */
+static bool hay_registro_listo(t_log_async* logger)
+{
+	t_registro_log* registro = &logger->registros[logger->posicion_lectura & logger->mascara];
+	return atomic_load_explicit(&registro->secuencia, memory_order_acquire) == logger->posicion_lectura + 1;
+}
+
+static void* escribir_registros(void* arg)
+{
+	t_log_async* logger = arg;
+	while(1) {
+		if(escribir_lote(logger) > 0)
+			continue;
+		informar_descartados(logger);
+		if(!atomic_load(&logger->activo))
+			break; // ya no se encola nada mas y la cola quedo vacia
+
+		// Cola vacia: se duerme hasta que un productor avise (o, por las dudas, hasta un timeout corto)
+		pthread_mutex_lock(&logger->mutex);
+		atomic_store_explicit(&logger->escritor_durmiendo, true, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		if(hay_registro_listo(logger)) { // se publico algo entre el ultimo lote y marcar durmiendo
+			atomic_store(&logger->escritor_durmiendo, false);
+			pthread_mutex_unlock(&logger->mutex);
+			continue;
+		}
+		struct timespec limite;
+		clock_gettime(CLOCK_REALTIME, &limite);
+		limite.tv_nsec += 10 * 1000000L;
+		if(limite.tv_nsec >= 1000000000L) {
+			limite.tv_sec++;
+			limite.tv_nsec -= 1000000000L;
+		}
+		pthread_cond_timedwait(&logger->hay_registros, &logger->mutex, &limite);
+		atomic_store(&logger->escritor_durmiendo, false);
+		pthread_mutex_unlock(&logger->mutex);
+	}
+	return NULL;
+}
+
+void log_async_destruir(t_log_async* logger)
+{
+	atomic_store(&logger->activo, false);
+	pthread_mutex_lock(&logger->mutex);
+	pthread_cond_signal(&logger->hay_registros);
+	pthread_mutex_unlock(&logger->mutex);
+	pthread_join(logger->escritor, NULL); // el escritor termina despues de vaciar la cola
+
+	close(logger->archivo);
+	pthread_cond_destroy(&logger->hay_registros);
+	pthread_mutex_destroy(&logger->mutex);
+	free(logger->programa);
+	free(logger->registros);
+	free(logger);
+}
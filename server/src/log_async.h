@@ -0,0 +1,115 @@
+/**
+ * @file log_async.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del logger asincronico del servidor
+ *
+ * log_info() de las commons escribe en el archivo y en la consola en el mismo hilo que llama:
+ * si el disco esta lento, se frena la recepcion de los sockets. Aca el hilo que loggea solo formatea
+ * el registro en una cola sin locks (varios productores, un consumidor) y un hilo escritor aparte
+ * los vuelca por lotes con writev().
+ * @see https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#ifndef LOG_ASYNC_H_
+#define LOG_ASYNC_H_
+
+// Librerias standard de C
+#include<stdarg.h> // va_list
+#include<stdbool.h> // bool
+#include<stdatomic.h> // contadores y secuencias atomicas de la cola
+#include<stdint.h> // intptr_t
+#include<time.h> // hora de cada registro
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilo escritor
+#include<sched.h> // sched_yield
+#include<sys/uio.h> // writev: un lote de registros en una syscall
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Tamanio maximo de un registro ya formateado (los mas largos se truncan) */
+#define LOG_ASYNC_TAMANIO_REGISTRO 512
+
+/* Cantidad maxima de registros que el escritor junta en un writev() */
+#define LOG_ASYNC_LOTE 64
+
+/**
+ * @brief Que hacer cuando la cola esta llena (LOG_POLITICA en servidor.config)
+ */
+typedef enum
+{
+	LOG_DESCARTAR, /**< se pierde el registro (y se cuenta): nunca frena al hilo que loggea */
+	LOG_BLOQUEAR /**< el hilo que loggea espera a que el escritor haga lugar */
+} t_politica_log;
+
+/**
+ * @brief Un registro ya formateado, en una posicion de la cola
+ */
+typedef struct
+{
+	atomic_size_t secuencia; /**< indica si la posicion esta libre o tiene un registro listo para escribir */
+	int longitud; /**< bytes usados de texto */
+	char texto[LOG_ASYNC_TAMANIO_REGISTRO]; /**< linea completa, con el '\n' final */
+} t_registro_log;
+
+/**
+ * @brief Logger asincronico
+ */
+typedef struct
+{
+	t_registro_log* registros; /**< cola circular de registros (capacidad potencia de 2) */
+	size_t mascara; /**< capacidad - 1 */
+	atomic_size_t posicion_escritura; /**< proxima posicion a reservar por los productores */
+	size_t posicion_lectura; /**< proxima posicion a escribir (solo la usa el hilo escritor) */
+	t_politica_log politica; /**< que hacer con la cola llena */
+	atomic_size_t descartados; /**< registros perdidos con LOG_DESCARTAR desde el ultimo aviso */
+	int archivo; /**< fd del archivo de log (O_APPEND) */
+	bool consola; /**< si tambien se escribe en stdout */
+	t_log_level nivel; /**< nivel minimo a registrar */
+	char* programa; /**< nombre que aparece en cada linea */
+	atomic_bool escritor_durmiendo; /**< el escritor espera en la condicion: hay que despertarlo */
+	atomic_bool activo; /**< false cuando se esta destruyendo */
+	pthread_mutex_t mutex; /**< solo para dormir/despertar al escritor, no para encolar */
+	pthread_cond_t hay_registros;
+	pthread_t escritor;
+} t_log_async;
+
+// Declaracion de variable global (como logger, pero para el camino caliente)
+extern t_log_async* logger_async;
+
+/**
+ * @brief Crea el logger y lanza su hilo escritor
+ * @param archivo ruta del archivo de log (se agrega al final)
+ * @param programa nombre del programa en cada linea
+ * @param consola true para escribir tambien en stdout
+ * @param nivel nivel minimo a registrar
+ * @param capacidad cantidad de registros de la cola (se redondea a potencia de 2)
+ * @param politica que hacer con la cola llena
+ * @return el logger, o NULL si no se pudo abrir el archivo
+ */
+t_log_async* log_async_crear(char* archivo, char* programa, bool consola, t_log_level nivel, int capacidad, t_politica_log politica);
+
+/**
+ * @brief Formatea el registro y lo encola para el escritor
+ * @param logger logger asincronico
+ * @param nivel nivel del registro
+ * @param formato formato printf
+ * @param argumentos argumentos del formato
+ */
+void log_async_escribir(t_log_async* logger, t_log_level nivel, const char* formato, va_list argumentos);
+
+/**
+ * @brief Equivalentes de log_info()/log_warning()/log_error() de las commons
+ */
+void log_async_info(t_log_async* logger, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+void log_async_warning(t_log_async* logger, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+void log_async_error(t_log_async* logger, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Escribe todo lo pendiente, frena el escritor y libera el logger
+ */
+void log_async_destruir(t_log_async* logger);
+
+#endif /* LOG_ASYNC_H_ */
@@ -0,0 +1,316 @@
+/**
+ * @file metricas.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de las metricas del servidor
+ *
+ * Cada contador lo escribe un solo hilo: alcanza con un store relajado (en x86 es un mov comun, sin lock)
+ * para que el hilo que exporta pueda leerlo a la vez sin ver un valor roto.
+ * Cubeta de un valor v >= 16 con p = bit mas alto de v: (p - 3) * 16 + los 4 bits que siguen al mas alto.
+ */
+
+#include "metricas.h"
+
+/* Bits de la subcubeta: log2(METRICAS_SUBCUBETAS) */
+#define BITS_SUBCUBETA 4
+
+/* Metricas de cada hilo registrado (se suman al exportar) */
+static t_metricas* hilos[METRICAS_HILOS_MAXIMO];
+static atomic_int cantidad_hilos = 0;
+static bool activas = false;
+
+/* Metricas del hilo actual (NULL si no se registro) */
+static __thread t_metricas* metricas_hilo = NULL;
+
+static const char* nombres[METRICAS_OPERACIONES + 1] = {
+	"MENSAJE", "PAQUETE", "PUT", "GET", "EXISTS", "RESPUESTA", "ACK", "CREDITO",
+	"SUSCRIBIR", "DESUSCRIBIR", "PUBLICAR", "PUBLICACION", "desconocido"
+};
+
+/**
+ * @brief Suma @p cantidad a un contador del hilo actual
+ */
+static inline void contar(uint64_t* contador, uint64_t cantidad)
+{
+	__atomic_store_n(contador, *contador + cantidad, __ATOMIC_RELAXED);
+}
+
+static int cubeta(uint64_t valor)
+{
+	if(valor < METRICAS_SUBCUBETAS)
+		return valor;
+	int potencia = 63 - __builtin_clzll(valor);
+	if(potencia >= METRICAS_BITS_MAXIMOS)
+		return METRICAS_CUBETAS - 1;
+	return (potencia - BITS_SUBCUBETA + 1) * METRICAS_SUBCUBETAS + ((valor >> (potencia - BITS_SUBCUBETA)) & (METRICAS_SUBCUBETAS - 1));
+}
+
+/**
+ * @brief Valor que representa a una cubeta (el medio de su rango)
+ */
+static uint64_t valor_de_cubeta(int indice)
+{
+	if(indice < METRICAS_SUBCUBETAS)
+		return indice;
+	int potencia = indice / METRICAS_SUBCUBETAS + BITS_SUBCUBETA - 1;
+	uint64_t ancho = 1ULL << (potencia - BITS_SUBCUBETA);
+	return (METRICAS_SUBCUBETAS + indice % METRICAS_SUBCUBETAS) * ancho + ancho / 2;
+}
+
+static int operacion(int cod_op)
+{
+	return cod_op >= 0 && cod_op < METRICAS_OPERACIONES ? cod_op : METRICAS_OPERACIONES;
+}
+
+void metricas_registrar_hilo(void)
+{
+	if(!activas || metricas_hilo != NULL)
+		return;
+	int indice = atomic_fetch_add(&cantidad_hilos, 1);
+	if(indice >= METRICAS_HILOS_MAXIMO) {
+		log_warning(logger, "Hay mas de %d hilos: el hilo %d no cuenta metricas", METRICAS_HILOS_MAXIMO, indice);
+		return;
+	}
+	// Alineadas a la linea de cache: los contadores de dos workers nunca la comparten
+	t_metricas* metricas = aligned_alloc(64, (sizeof(t_metricas) + 63) & ~(size_t) 63);
+	memset(metricas, 0, sizeof(t_metricas));
+	__atomic_store_n(&hilos[indice], metricas, __ATOMIC_RELEASE);
+	metricas_hilo = metricas;
+}
+
+uint64_t metricas_instante(void)
+{
+	if(metricas_hilo == NULL)
+		return 0;
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+}
+
+void metricas_frame(int cod_op, uint64_t bytes, uint64_t recibido, bool error)
+{
+	t_metricas* metricas = metricas_hilo;
+	if(metricas == NULL)
+		return;
+	int indice = operacion(cod_op);
+	contar(&metricas->frames[indice], 1);
+	contar(&metricas->bytes[indice], bytes);
+	if(error)
+		contar(&metricas->errores[indice], 1);
+	if(recibido == 0)
+		return;
+
+	uint64_t latencia = metricas_instante() - recibido;
+	t_histograma* histograma = &metricas->latencias[indice];
+	contar(&histograma->cubetas[cubeta(latencia)], 1);
+	contar(&histograma->cantidad, 1);
+	contar(&histograma->suma, latencia);
+}
+
+void metricas_invalido(void)
+{
+	if(metricas_hilo != NULL)
+		contar(&metricas_hilo->invalidos, 1);
+}
+
+void metricas_conexion(bool abierta)
+{
+	if(metricas_hilo != NULL)
+		contar(abierta ? &metricas_hilo->conexiones_abiertas : &metricas_hilo->conexiones_cerradas, 1);
+}
+
+void metricas_reservas(int cantidad)
+{
+	if(metricas_hilo != NULL)
+		contar(&metricas_hilo->reservas, cantidad);
+}
+
+void metricas_publicacion(bool encolada)
+{
+	if(metricas_hilo != NULL)
+		contar(encolada ? &metricas_hilo->publicaciones_encoladas : &metricas_hilo->publicaciones_descartadas, 1);
+}
+
+void metricas_desperdicio(uint64_t bytes)
+{
+	if(metricas_hilo != NULL)
+		contar(&metricas_hilo->almacen_desperdiciado, bytes);
+}
+
+void metricas_compactacion(uint64_t bytes)
+{
+	if(metricas_hilo != NULL) {
+		contar(&metricas_hilo->almacen_recuperado, bytes);
+		contar(&metricas_hilo->almacen_compactaciones, 1);
+	}
+}
+
+/**
+ * @brief Suma las metricas de todos los hilos registrados
+ * @note t_metricas son todos uint64_t: se suman como un arreglo
+ */
+static void sumar_hilos(t_metricas* total)
+{
+	memset(total, 0, sizeof(t_metricas));
+	uint64_t* destino = (uint64_t*) total;
+	int cantidad = atomic_load(&cantidad_hilos);
+	if(cantidad > METRICAS_HILOS_MAXIMO)
+		cantidad = METRICAS_HILOS_MAXIMO;
+	for(int i = 0; i < cantidad; i++) {
+		uint64_t* origen = (uint64_t*) __atomic_load_n(&hilos[i], __ATOMIC_ACQUIRE);
+		if(origen == NULL)
+			continue; // se esta registrando
+		for(size_t j = 0; j < sizeof(t_metricas) / sizeof(uint64_t); j++)
+			destino[j] += __atomic_load_n(&origen[j], __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * @brief Valor del cuantil @p q (0..1) del histograma, en ns
+ */
+static uint64_t cuantil(const t_histograma* histograma, double q)
+{
+	// El total sale de las cubetas: cantidad pudo leerse en otro momento que ellas
+	uint64_t total = 0;
+	for(int i = 0; i < METRICAS_CUBETAS; i++)
+		total += histograma->cubetas[i];
+	if(total == 0)
+		return 0;
+	uint64_t objetivo = q * total;
+	if(objetivo == 0)
+		objetivo = 1;
+	uint64_t acumulado = 0;
+	for(int i = 0; i < METRICAS_CUBETAS; i++) {
+		acumulado += histograma->cubetas[i];
+		if(acumulado >= objetivo)
+			return valor_de_cubeta(i);
+	}
+	return valor_de_cubeta(METRICAS_CUBETAS - 1);
+}
+
+/**
+ * @brief Escribe un contador con una serie por op_code
+ */
+static void exportar_por_operacion(FILE* salida, const char* nombre, const char* ayuda, const uint64_t* valores)
+{
+	fprintf(salida, "# HELP %s %s\n# TYPE %s counter\n", nombre, ayuda, nombre);
+	for(int i = 0; i <= METRICAS_OPERACIONES; i++)
+		fprintf(salida, "%s{op=\"%s\"} %lu\n", nombre, nombres[i], valores[i]);
+}
+
+size_t metricas_exportar(char** texto)
+{
+	static const double cuantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+	t_metricas* total = malloc(sizeof(t_metricas));
+	sumar_hilos(total);
+
+	size_t largo;
+	FILE* salida = open_memstream(texto, &largo);
+	exportar_por_operacion(salida, "servidor_frames_total", "Frames procesados por op_code", total->frames);
+	exportar_por_operacion(salida, "servidor_bytes_total", "Bytes recibidos (encabezado + payload) por op_code", total->bytes);
+	exportar_por_operacion(salida, "servidor_errores_total", "Frames rechazados con ACK_ERROR por op_code", total->errores);
+	fprintf(salida, "# HELP servidor_invalidos_total Frames o handshakes invalidos que cortaron la conexion\n"
+		"# TYPE servidor_invalidos_total counter\nservidor_invalidos_total %lu\n", total->invalidos);
+	fprintf(salida, "# HELP servidor_conexiones_total Conexiones aceptadas\n"
+		"# TYPE servidor_conexiones_total counter\nservidor_conexiones_total %lu\n", total->conexiones_abiertas);
+	fprintf(salida, "# HELP servidor_conexiones_activas Conexiones abiertas en este momento\n"
+		"# TYPE servidor_conexiones_activas gauge\nservidor_conexiones_activas %lu\n",
+		total->conexiones_abiertas - total->conexiones_cerradas);
+	fprintf(salida, "# HELP servidor_reservas_total malloc/realloc hechos por las conexiones\n"
+		"# TYPE servidor_reservas_total counter\nservidor_reservas_total %lu\n", total->reservas);
+	fprintf(salida, "# HELP servidor_publicaciones_encoladas_total Publicaciones encoladas para enviar a un suscriptor\n"
+		"# TYPE servidor_publicaciones_encoladas_total counter\nservidor_publicaciones_encoladas_total %lu\n", total->publicaciones_encoladas);
+	fprintf(salida, "# HELP servidor_publicaciones_descartadas_total Publicaciones descartadas por la cola llena de un suscriptor lento\n"
+		"# TYPE servidor_publicaciones_descartadas_total counter\nservidor_publicaciones_descartadas_total %lu\n", total->publicaciones_descartadas);
+	fprintf(salida, "# HELP servidor_almacen_desperdicio_bytes Bytes de la arena del almacen ocupados por valores reemplazados\n"
+		"# TYPE servidor_almacen_desperdicio_bytes gauge\nservidor_almacen_desperdicio_bytes %lu\n",
+		total->almacen_desperdiciado - total->almacen_recuperado);
+	fprintf(salida, "# HELP servidor_almacen_compactaciones_total Compactaciones de una parte del almacen por exceso de desperdicio\n"
+		"# TYPE servidor_almacen_compactaciones_total counter\nservidor_almacen_compactaciones_total %lu\n", total->almacen_compactaciones);
+
+	fprintf(salida, "# HELP servidor_latencia_segundos Desde que se recibe un frame hasta que se termina de procesar\n"
+		"# TYPE servidor_latencia_segundos summary\n");
+	for(int i = 0; i <= METRICAS_OPERACIONES; i++) {
+		t_histograma* histograma = &total->latencias[i];
+		if(histograma->cantidad == 0)
+			continue;
+		for(size_t j = 0; j < sizeof(cuantiles) / sizeof(cuantiles[0]); j++)
+			fprintf(salida, "servidor_latencia_segundos{op=\"%s\",quantile=\"%g\"} %.9f\n", nombres[i], cuantiles[j],
+				cuantil(histograma, cuantiles[j]) / 1e9);
+		fprintf(salida, "servidor_latencia_segundos_sum{op=\"%s\"} %.9f\n", nombres[i], histograma->suma / 1e9);
+		fprintf(salida, "servidor_latencia_segundos_count{op=\"%s\"} %lu\n", nombres[i], histograma->cantidad);
+	}
+	fclose(salida);
+	free(total);
+	return largo;
+}
+
+/**
+ * @brief Envia todo el bloque (el socket del pedido es bloqueante)
+ */
+static void enviar_todo(int socket, const char* datos, size_t largo)
+{
+	while(largo > 0) {
+		ssize_t enviados = send(socket, datos, largo, MSG_NOSIGNAL);
+		if(enviados == -1 && errno == EINTR)
+			continue;
+		if(enviados <= 0)
+			return;
+		datos += enviados;
+		largo -= enviados;
+	}
+}
+
+/**
+ * @brief Hilo del puerto de metricas: contesta cada pedido HTTP con todas las metricas y cierra
+ */
+static void* atender_pedidos(void* arg)
+{
+	int socket_metricas = (intptr_t) arg;
+	while(1) {
+		int cliente = accept(socket_metricas, NULL, NULL);
+		if(cliente == -1) {
+			if(errno == EINTR || errno == ECONNABORTED)
+				continue;
+			log_error(logger, "El puerto de metricas dejo de aceptar pedidos: %s", strerror(errno));
+			break;
+		}
+		// Cualquier pedido recibe lo mismo: solo se lee para no cerrar con datos sin leer (el cliente veria un RST)
+		struct timeval espera = { .tv_sec = 1 };
+		setsockopt(cliente, SOL_SOCKET, SO_RCVTIMEO, &espera, sizeof(espera));
+		char pedido[1024];
+		recv(cliente, pedido, sizeof(pedido), 0);
+
+		char* texto;
+		size_t largo = metricas_exportar(&texto);
+		char encabezado[160];
+		int largo_encabezado = snprintf(encabezado, sizeof(encabezado), "HTTP/1.0 200 OK\r\n"
+			"Content-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", largo);
+		enviar_todo(cliente, encabezado, largo_encabezado);
+		enviar_todo(cliente, texto, largo);
+		free(texto);
+		close(cliente);
+	}
+	close(socket_metricas);
+	return NULL;
+}
+
+bool metricas_iniciar(int puerto)
+{
+	int socket_metricas = socket(AF_INET, SOCK_STREAM, 0);
+	if(socket_metricas == -1)
+		return false;
+	setsockopt(socket_metricas, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int));
+	// Solo local: las metricas no se publican hacia afuera
+	struct sockaddr_in direccion = { .sin_family = AF_INET, .sin_port = htons(puerto), .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+	pthread_t hilo;
+	if(bind(socket_metricas, (struct sockaddr*) &direccion, sizeof(direccion)) == -1 || listen(socket_metricas, SOMAXCONN) == -1
+		|| pthread_create(&hilo, NULL, atender_pedidos, (void*) (intptr_t) socket_metricas) != 0) {
+		close(socket_metricas);
+		return false;
+	}
+	pthread_detach(hilo);
+	activas = true;
+	log_info(logger, "Metricas en http://127.0.0.1:%d/metrics", puerto);
+	return true;
+}
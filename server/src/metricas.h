@@ -0,0 +1,144 @@
+/**
+ * @file metricas.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de las metricas del servidor
+ *
+ * Cada worker cuenta en su propia estructura (sin locks ni atomicos con lock: solo el escribe sus contadores):
+ * frames, bytes y errores por op_code, conexiones abiertas y cerradas, reservas de memoria de las conexiones
+ * y un histograma de latencia por op_code, desde que se recibio el frame hasta que se termino de procesar.
+ * Recien cuando alguien las pide se suman las de todos los hilos y se exportan en formato de texto de Prometheus,
+ * por HTTP en un puerto local aparte (METRICAS_PUERTO en servidor.config) que atiende un hilo propio.
+ * Sin METRICAS_PUERTO no se registra ningun hilo y cada funcion de este archivo vuelve apenas la llama el camino caliente.
+ *
+ * Histograma al estilo HdrHistogram: cubetas lineales hasta 16 ns y despues 16 cubetas por cada potencia de 2,
+ * asi el error relativo de cualquier cuantil es menor a 1/16 sin importar la magnitud (de ns a decenas de segundos).
+ * @see https://prometheus.io/docs/instrumenting/exposition_formats/
+ * @see https://hdrhistogram.github.io/HdrHistogram/
+ */
+
+#ifndef METRICAS_H_
+#define METRICAS_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint64_t
+#include<stdbool.h> // bool
+#include<stdatomic.h> // registro de hilos
+#include<time.h> // clock_gettime
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilo que atiende el puerto de metricas
+#include<netinet/in.h> // sockaddr_in, INADDR_LOOPBACK
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* op_code que se cuentan por separado; los demas van juntos como "desconocido" */
+#define METRICAS_OPERACIONES (PUBLICACION + 1)
+
+/* Subcubetas por potencia de 2 (potencia de 2) y potencia mas alta que se distingue (2^40 ns = ~18 minutos) */
+#define METRICAS_SUBCUBETAS 16
+#define METRICAS_BITS_MAXIMOS 40
+#define METRICAS_CUBETAS ((METRICAS_BITS_MAXIMOS - 3) * METRICAS_SUBCUBETAS)
+
+/* Hilos que pueden registrar metricas como mucho */
+#define METRICAS_HILOS_MAXIMO 256
+
+/**
+ * @brief Histograma de latencias en ns
+ */
+typedef struct
+{
+	uint64_t cubetas[METRICAS_CUBETAS]; /**< cantidad de valores por cubeta (ver metricas.c) */
+	uint64_t cantidad; /**< valores registrados */
+	uint64_t suma; /**< suma de los valores (ns) */
+} t_histograma;
+
+/**
+ * @brief Metricas de un hilo (el ultimo lugar de cada arreglo es para los op_code desconocidos)
+ * @note Solo las escribe su hilo; el que exporta las lee sin frenarlo
+ */
+typedef struct
+{
+	uint64_t frames[METRICAS_OPERACIONES + 1]; /**< frames procesados */
+	uint64_t bytes[METRICAS_OPERACIONES + 1]; /**< bytes en el cable (encabezado + payload) */
+	uint64_t errores[METRICAS_OPERACIONES + 1]; /**< frames rechazados (contestados o contestables con ACK_ERROR) */
+	uint64_t invalidos; /**< frames o handshakes que cortaron la conexion (sincronizacion, ids o credito) */
+	uint64_t conexiones_abiertas; /**< conexiones creadas */
+	uint64_t conexiones_cerradas; /**< conexiones destruidas */
+	uint64_t reservas; /**< malloc/realloc hechos por las conexiones (estado, lector, salida, vistas) */
+	uint64_t publicaciones_encoladas; /**< publicaciones que entraron en la cola de un suscriptor */
+	uint64_t publicaciones_descartadas; /**< publicaciones que no entraron: la cola del suscriptor estaba llena */
+	uint64_t almacen_desperdiciado; /**< bytes de la arena del almacen que quedaron sin usar al reemplazar un valor */
+	uint64_t almacen_recuperado; /**< bytes desperdiciados que libero una compactacion */
+	uint64_t almacen_compactaciones; /**< compactaciones de una parte del almacen */
+	t_histograma latencias[METRICAS_OPERACIONES + 1]; /**< recibido -> procesado */
+} t_metricas;
+
+/**
+ * @brief Empieza a atender el puerto de metricas (solo en 127.0.0.1) con un hilo propio
+ * @param puerto puerto TCP local
+ * @return true si se pudo abrir el puerto; si no, las metricas quedan desactivadas
+ * @note Hay que llamarla antes de lanzar los workers: los hilos que se registran despues son los que cuentan
+ */
+bool metricas_iniciar(int puerto);
+
+/**
+ * @brief Reserva las metricas del hilo que llama (cada worker, al arrancar)
+ * @note No hace nada si las metricas no estan activas o ya hay METRICAS_HILOS_MAXIMO hilos registrados
+ */
+void metricas_registrar_hilo(void);
+
+/**
+ * @brief Instante actual en ns para medir latencias
+ * @return el instante, o 0 si el hilo no tiene metricas (asi no se paga el clock_gettime())
+ */
+uint64_t metricas_instante(void);
+
+/**
+ * @brief Cuenta un frame procesado
+ * @param cod_op codigo de operacion del frame
+ * @param bytes bytes que ocupo en el cable
+ * @param recibido metricas_instante() de cuando se recibio (0: no se mide la latencia)
+ * @param error si se rechazo
+ */
+void metricas_frame(int cod_op, uint64_t bytes, uint64_t recibido, bool error);
+
+/**
+ * @brief Cuenta un frame o handshake invalido que corta la conexion
+ */
+void metricas_invalido(void);
+
+/**
+ * @brief Cuenta una conexion que se abre (@p abierta true) o se cierra
+ */
+void metricas_conexion(bool abierta);
+
+/**
+ * @brief Cuenta @p cantidad reservas de memoria (malloc/realloc) de una conexion
+ */
+void metricas_reservas(int cantidad);
+
+/**
+ * @brief Cuenta una publicacion que entro (@p encolada true) o no entro en la cola de un suscriptor
+ */
+void metricas_publicacion(bool encolada);
+
+/**
+ * @brief Cuenta bytes de la arena del almacen que quedaron sin usar (un valor reemplazado por uno mas grande)
+ */
+void metricas_desperdicio(uint64_t bytes);
+
+/**
+ * @brief Cuenta una compactacion de una parte del almacen, que libero @p bytes desperdiciados
+ */
+void metricas_compactacion(uint64_t bytes);
+
+/**
+ * @brief Suma las metricas de todos los hilos y las escribe en formato de texto de Prometheus
+ * @param texto donde guardar el texto (liberar con free())
+ * @return bytes del texto
+ */
+size_t metricas_exportar(char** texto);
+
+#endif /* METRICAS_H_ */
@@ -0,0 +1,145 @@
+/**
+ * @file operaciones.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del registro de operaciones del servidor y de las operaciones propias
+ *
+ * Cada operacion propia es lo que antes era un case del switch de procesar_operacion().
+ */
+
+#include "operaciones.h"
+
+/**
+ * @brief Largo de un valor sin el '\0' final que agrega el cliente (las claves se guardan y buscan sin el)
+ */
+static int largo_sin_nulo(void* valor, int tamanio)
+{
+	return tamanio > 0 && ((char*) valor)[tamanio - 1] == '\0' ? tamanio - 1 : tamanio;
+}
+
+/**
+ * @brief Copia el valor encontrado por un GET directo al buffer de salida de la conexion
+ */
+static void responder_valor(void* contexto, const void* valor, int largo)
+{
+	uint8_t* respuesta = conexion_reservar_respuesta(contexto, RESPUESTA, 1 + largo);
+	respuesta[0] = PROTOCOLO_ENCONTRADO;
+	memcpy(respuesta + 1, valor, largo);
+}
+
+/**
+ * @brief MENSAJE: se loguea y se guarda como clave
+ */
+static void procesar_mensaje(t_conexion* conexion, void* payload, int size)
+{
+	TRAZA_INICIO(tramo);
+	log_async_info(logger_async, "Me llego el mensaje: %.*s", size, (char*) payload);
+	TRAZA_FIN(tramo, "procesar_operacion:log");
+	almacen_guardar(almacen, payload, largo_sin_nulo(payload, size), NULL, 0);
+}
+
+/**
+ * @brief PAQUETE: se loguea cada elemento y se guarda como clave
+ */
+static void procesar_paquete(t_conexion* conexion, void* payload, int size)
+{
+	// El payload lo libera la conexion despues de esta llamada: la vista solo lo toma prestado
+	t_paquete_vista* vista = paquete_vista_crear(payload, size, conexion->lector->version, false);
+	if(vista == NULL) {
+		log_warning(logger, "Paquete mal formado (fd %d)", conexion->fd);
+		conexion_confirmar(conexion, PROTOCOLO_ACK_ERROR);
+		return;
+	}
+	log_async_info(logger_async, "Me llegaron los siguientes valores:");
+	paquete_vista_iterar(vista, iterator_vista);
+	int tamanio_clave;
+	for(int i = 0; i < vista->cantidad; i++) {
+		void* clave = paquete_vista_elemento(vista, i, &tamanio_clave);
+		almacen_guardar(almacen, clave, largo_sin_nulo(clave, tamanio_clave), NULL, 0);
+	}
+	paquete_vista_destruir(vista);
+}
+
+/**
+ * @brief PUT: | clave | valor |, con el mismo formato de elementos que PAQUETE
+ */
+static void procesar_put(t_conexion* conexion, void* payload, int size)
+{
+	t_paquete_vista* vista = paquete_vista_crear(payload, size, conexion->lector->version, false);
+	if(vista == NULL || vista->cantidad != 2) {
+		log_warning(logger, "PUT mal formado (fd %d)", conexion->fd);
+		conexion_confirmar(conexion, PROTOCOLO_ACK_ERROR);
+		if(vista != NULL)
+			paquete_vista_destruir(vista);
+		return;
+	}
+	int tamanio_clave, tamanio_valor;
+	void* clave = paquete_vista_elemento(vista, 0, &tamanio_clave);
+	void* valor = paquete_vista_elemento(vista, 1, &tamanio_valor);
+	almacen_guardar(almacen, clave, largo_sin_nulo(clave, tamanio_clave), valor, largo_sin_nulo(valor, tamanio_valor));
+	paquete_vista_destruir(vista);
+}
+
+/**
+ * @brief GET: la respuesta se arma directo en el buffer de salida, con el valor copiado una sola vez
+ */
+static void procesar_get(t_conexion* conexion, void* payload, int size)
+{
+	if(!almacen_obtener(almacen, payload, largo_sin_nulo(payload, size), responder_valor, conexion))
+		conexion_reservar_respuesta(conexion, RESPUESTA, 1)[0] = PROTOCOLO_NO_ENCONTRADO;
+}
+
+static void procesar_exists(t_conexion* conexion, void* payload, int size)
+{
+	conexion_reservar_respuesta(conexion, RESPUESTA, 1)[0] =
+		almacen_obtener(almacen, payload, largo_sin_nulo(payload, size), NULL, NULL) ? PROTOCOLO_ENCONTRADO : PROTOCOLO_NO_ENCONTRADO;
+}
+
+t_registro_operacion operaciones[OPERACIONES_MAXIMO] = {
+	[MENSAJE] = { procesar_mensaje, "MENSAJE", true },
+	[PAQUETE] = { procesar_paquete, "PAQUETE", true },
+	[PUT] = { procesar_put, "PUT", true },
+	[GET] = { procesar_get, "GET", false },
+	[EXISTS] = { procesar_exists, "EXISTS", false },
+	[SUSCRIBIR] = { topicos_suscribir, "SUSCRIBIR", false },
+	[DESUSCRIBIR] = { topicos_desuscribir, "DESUSCRIBIR", false },
+	[PUBLICAR] = { topicos_publicar, "PUBLICAR", false }
+};
+
+bool operaciones_registrar(int cod_op, const char* nombre, t_operacion procesar, bool persistir)
+{
+	if(cod_op < 0 || cod_op >= OPERACIONES_MAXIMO || procesar == NULL || operaciones[cod_op].procesar != NULL
+		|| cod_op == RESPUESTA || cod_op == ACK || cod_op == CREDITO || cod_op == PUBLICACION)
+		return false;
+	operaciones[cod_op] = (t_registro_operacion) { procesar, nombre, persistir };
+	return true;
+}
+
+bool operaciones_cargar_plugin(const char* ruta)
+{
+	// RTLD_NOW: un simbolo que falte se detecta al arrancar y no con el primer frame
+	void* plugin = dlopen(ruta, RTLD_NOW | RTLD_LOCAL);
+	if(plugin == NULL) {
+		log_error(logger, "No se pudo cargar el plugin %s: %s", ruta, dlerror());
+		return false;
+	}
+	t_plugin_iniciar iniciar = (t_plugin_iniciar) dlsym(plugin, OPERACIONES_PLUGIN_INICIAR);
+	if(iniciar == NULL) {
+		log_error(logger, "El plugin %s no exporta %s", ruta, OPERACIONES_PLUGIN_INICIAR);
+		dlclose(plugin);
+		return false;
+	}
+	if(!iniciar()) {
+		log_error(logger, "El plugin %s no se pudo iniciar", ruta);
+		return false; // no se descarga: puede haber registrado alguna operacion antes de fallar
+	}
+	log_info(logger, "Plugin %s cargado", ruta);
+	return true;
+}
+
+void iterator_vista(void* valor, int tamanio) {
+	// tamanio incluye el '\0' que agrega el cliente; %.*s no depende de que este
+	TRAZA_INICIO(tramo);
+	log_async_info(logger_async,"%.*s", tamanio > 0 && ((char*) valor)[tamanio - 1] == '\0' ? tamanio - 1 : tamanio, (char*) valor);
+	TRAZA_FIN(tramo, "iterator_vista:log");
+}
@@ -0,0 +1,119 @@
+/**
+ * @file operaciones.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del registro de operaciones del servidor (que hacer con cada cod_op)
+ *
+ * En lugar del switch de procesar_operacion(), cada cod_op tiene una entrada en una tabla indexada por el mismo cod_op:
+ * despachar un frame es un acceso a la tabla y una llamada indirecta, sin importar cuantas operaciones haya.
+ * - las operaciones propias (MENSAJE, PAQUETE, PUT, GET, EXISTS, y SUSCRIBIR, DESUSCRIBIR y PUBLICAR de topicos.h)
+ *   vienen cargadas desde la compilacion;
+ * - otras se agregan al arrancar, desde plugins (.so) listados en OPERACIONES_PLUGINS de servidor.config.
+ * La tabla solo se modifica antes de lanzar los workers y los procesadores: despues se lee sin locks.
+ *
+ * Un plugin incluye este header, exporta operaciones_plugin_iniciar() y desde ahi registra sus operaciones con
+ * operaciones_registrar(). Puede usar todo lo que exporta el servidor (conexion_reservar_respuesta(),
+ * conexion_confirmar(), paquete_vista_crear(), el almacen, el logger...): se enlaza con -rdynamic.
+ * Se compila con: gcc -shared -fPIC -D_GNU_SOURCE -I<server/src> -I<protocolo/src> -o plugin.so plugin.c
+ * @see https://man7.org/linux/man-pages/man3/dlopen.3.html
+ */
+
+#ifndef OPERACIONES_H_
+#define OPERACIONES_H_
+
+// Librerias standard de C
+#include<stdbool.h> // bool
+
+// Librerias standard de POSIX/Linux
+#include<dlfcn.h> // dlopen, dlsym de los plugins
+
+// Inclusión de la conexion (y de las utilidades)
+#include "conexion.h"
+#include "paquete_vista.h" // PAQUETE y PUT sin copiar cada elemento
+#include "log_async.h" // log del camino caliente
+#include "almacen.h" // lo que guardan MENSAJE, PAQUETE y PUT y consultan GET y EXISTS
+#include "topicos.h" // SUSCRIBIR, DESUSCRIBIR y PUBLICAR
+
+/* Entradas de la tabla: en v2 el cod_op viaja en un byte (un cod_op v1 mas grande se trata como desconocido) */
+#define OPERACIONES_MAXIMO 256
+
+/* Funcion que tiene que exportar cada plugin (ver t_plugin_iniciar) */
+#define OPERACIONES_PLUGIN_INICIAR "operaciones_plugin_iniciar"
+
+/**
+ * @brief Procesa un frame de un cod_op (sus respuestas van con conexion_reservar_respuesta() o conexion_confirmar())
+ * @param conexion conexion por la que llego
+ * @param payload contenido del frame (lo libera quien llama: no se puede guardar el puntero)
+ * @param size tamanio del payload
+ * @note Se llama desde los event loops o desde los procesadores: tiene que poder correr en varios hilos a la vez
+ */
+typedef void (*t_operacion)(t_conexion* conexion, void* payload, int size);
+
+/**
+ * @brief Entrada de la tabla de operaciones
+ */
+typedef struct
+{
+	t_operacion procesar; /**< NULL: cod_op desconocido (se contesta ACK_ERROR) */
+	const char* nombre; /**< para los logs */
+	bool persistir; /**< si se guarda en la persistencia (lo que modifica el almacen) */
+} t_registro_operacion;
+
+/**
+ * @brief Inicializacion de un plugin
+ * @return true si registro sus operaciones; false descarta el plugin (lo que ya haya registrado queda)
+ */
+typedef bool (*t_plugin_iniciar)(void);
+
+// Declaracion de variable global
+extern t_registro_operacion operaciones[OPERACIONES_MAXIMO];
+
+/**
+ * @brief Agrega una operacion a la tabla
+ * @param cod_op codigo que la identifica (menor a OPERACIONES_MAXIMO)
+ * @param nombre nombre para los logs (tiene que seguir existiendo: se guarda el puntero)
+ * @param procesar funcion que procesa cada frame
+ * @param persistir si sus frames se guardan en la persistencia
+ * @return false si el cod_op esta fuera de rango, ya tiene operacion o es de las que solo manda el servidor
+ * (RESPUESTA, ACK, CREDITO, PUBLICACION)
+ * @note Solo al arrancar, antes de lanzar los workers
+ */
+bool operaciones_registrar(int cod_op, const char* nombre, t_operacion procesar, bool persistir);
+
+/**
+ * @brief Carga un plugin y llama a su operaciones_plugin_iniciar()
+ * @param ruta archivo .so (con '/' se toma tal cual; si no, se busca como cualquier biblioteca compartida)
+ * @return true si se cargo y se inicio; si no, se loguea el motivo
+ * @note El plugin no se descarga nunca: sus funciones quedan en la tabla
+ */
+bool operaciones_cargar_plugin(const char* ruta);
+
+/**
+ * @brief Procesa un frame con la operacion de su cod_op
+ * @return false si el cod_op no tiene operacion (no se hizo nada)
+ */
+static inline bool operaciones_despachar(t_conexion* conexion, int cod_op, void* payload, int size)
+{
+	if((unsigned) cod_op >= OPERACIONES_MAXIMO || operaciones[cod_op].procesar == NULL)
+		return false;
+	operaciones[cod_op].procesar(conexion, payload, size);
+	return true;
+}
+
+/**
+ * @brief Indica si los frames de un cod_op se guardan en la persistencia
+ */
+static inline bool operaciones_persistir(int cod_op)
+{
+	return (unsigned) cod_op < OPERACIONES_MAXIMO && operaciones[cod_op].persistir;
+}
+
+/**
+ * @brief Imprime un elemento de un paquete sin copiarlo (no necesita el '\0' final)
+ * @param valor puntero al elemento dentro del buffer recibido
+ * @param tamanio tamanio del elemento
+ * @note Funcion auxiliar que usa paquete_vista_iterar(vista, iterator_vista);
+ */
+void iterator_vista(void* valor, int tamanio);
+
+#endif /* OPERACIONES_H_ */
@@ -0,0 +1,69 @@
+/**
+ * @file paquete_vista.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de la deserializacion sin copias de PAQUETE
+ *
+ * Se recorre el buffer dos veces: la primera (protocolo_contar_elementos()) valida y cuenta los elementos,
+ * para hacer una unica reserva del tamanio justo, y la segunda anota donde esta cada uno. Ninguna copia los datos.
+ */
+
+#include "paquete_vista.h"
+#include "metricas.h"
+
+t_paquete_vista* paquete_vista_crear(void* buffer, int size, int version, bool es_propio)
+{
+	int cantidad = protocolo_contar_elementos(version, buffer, size, limites.elementos_maximo);
+	if(cantidad == -1)
+		return NULL;
+
+	// La vista y su arreglo de elementos van en la misma reserva
+	t_paquete_vista* vista = malloc(sizeof(t_paquete_vista) + cantidad * sizeof(t_elemento_vista));
+	metricas_reservas(1);
+	vista->buffer = buffer;
+	vista->size = size;
+	vista->es_propio = es_propio;
+	vista->cantidad = cantidad;
+
+	int desplazamiento = 0;
+	uint32_t tamanio;
+	for(int i = 0; i < cantidad; i++) {
+		desplazamiento += protocolo_decodificar_elemento(version, (uint8_t*) buffer + desplazamiento, size - desplazamiento, &tamanio);
+		vista->elementos[i].desplazamiento = desplazamiento;
+		vista->elementos[i].tamanio = tamanio;
+		desplazamiento += tamanio;
+	}
+	return vista;
+}
+
+void* paquete_vista_elemento(t_paquete_vista* vista, int indice, int* tamanio)
+{
+	if(tamanio != NULL)
+		*tamanio = vista->elementos[indice].tamanio;
+	return (char*) vista->buffer + vista->elementos[indice].desplazamiento;
+}
+
+void paquete_vista_iterar(t_paquete_vista* vista, void (*closure)(void* valor, int tamanio))
+{
+	for(int i = 0; i < vista->cantidad; i++)
+		closure((char*) vista->buffer + vista->elementos[i].desplazamiento, vista->elementos[i].tamanio);
+}
+
+t_paquete_vista* recibir_paquete_vista(int socket_cliente)
+{
+	int size;
+	void* buffer = recibir_buffer(&size, socket_cliente);
+	if(buffer == NULL)
+		return NULL;
+	t_paquete_vista* vista = paquete_vista_crear(buffer, size, PROTOCOLO_VERSION_1, true);
+	if(vista == NULL)
+		free(buffer); // mal formado: nadie se hizo cargo del buffer
+	return vista;
+}
+
+void paquete_vista_destruir(t_paquete_vista* vista)
+{
+	if(vista->es_propio)
+		free(vista->buffer);
+	free(vista);
+}
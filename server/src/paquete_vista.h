@@ -0,0 +1,79 @@
+/**
+ * @file paquete_vista.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de la deserializacion sin copias de PAQUETE
+ *
+ * En lugar de copiar cada elemento a su propio malloc (como recibir_paquete()), una vista guarda
+ * solamente (desplazamiento, tamanio) de cada elemento dentro del buffer recibido.
+ * El buffer vive lo mismo que la vista: un paquete de N elementos cuesta una sola reserva (ademas del buffer).
+ */
+
+#ifndef PAQUETE_VISTA_H_
+#define PAQUETE_VISTA_H_
+
+// Librerias standard de C
+#include<stdbool.h> // bool
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/**
+ * @brief Ubicacion de un elemento dentro del buffer del paquete
+ */
+typedef struct
+{
+	int desplazamiento; /**< donde empiezan los datos del elemento (sin su prefijo de tamanio) */
+	int tamanio; /**< tamanio del elemento en bytes */
+} t_elemento_vista;
+
+/**
+ * @brief Paquete deserializado sin copiar sus elementos
+ */
+typedef struct
+{
+	void* buffer; /**< buffer recibido, tal cual llego */
+	int size; /**< tamanio del buffer */
+	bool es_propio; /**< si la vista libera el buffer al destruirse */
+	int cantidad; /**< cantidad de elementos */
+	t_elemento_vista elementos[]; /**< un (desplazamiento, tamanio) por elemento, en la misma reserva que la vista */
+} t_paquete_vista;
+
+/**
+ * @brief Arma la vista de un buffer de PAQUETE (| tamanio | tamanio bytes | ...)
+ * @param buffer bloque recibido
+ * @param size tamanio del bloque
+ * @param version version de protocolo del paquete (v1: tamanio en int, v2: tamanio en varint)
+ * @param es_propio true si la vista pasa a ser dueña del buffer (lo libera paquete_vista_destruir())
+ * @return la vista, o NULL si algun tamanio se sale del buffer o hay mas de limites.elementos_maximo elementos
+ * (en ese caso no se toca @p buffer)
+ */
+t_paquete_vista* paquete_vista_crear(void* buffer, int size, int version, bool es_propio);
+
+/**
+ * @brief Devuelve un puntero (dentro del buffer) al elemento @p indice
+ * @param vista vista ya creada
+ * @param indice posicion del elemento (0..cantidad-1)
+ * @param tamanio si no es NULL, se guarda ahi el tamanio del elemento
+ */
+void* paquete_vista_elemento(t_paquete_vista* vista, int indice, int* tamanio);
+
+/**
+ * @brief Llama a @p closure con cada elemento, en orden
+ */
+void paquete_vista_iterar(t_paquete_vista* vista, void (*closure)(void* valor, int tamanio));
+
+/**
+ * @brief Recibe un PAQUETE del socket y devuelve su vista (dueña del buffer recibido)
+ * @param socket_cliente (int) fd del socket
+ * @return la vista, o NULL si el paquete estaba mal formado (o no llego entero)
+ * @note Version sin copias de recibir_paquete() (protocolo v1, como recibir_buffer())
+ */
+t_paquete_vista* recibir_paquete_vista(int socket_cliente);
+
+/**
+ * @brief Libera la vista (y el buffer, si es propio)
+ */
+void paquete_vista_destruir(t_paquete_vista* vista);
+
+#endif /* PAQUETE_VISTA_H_ */
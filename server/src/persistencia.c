@@ -0,0 +1,331 @@
+/**
+ * @file persistencia.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de la persistencia de los frames recibidos
+ *
+ * Los workers arman cada registro directamente en el buffer "pendientes" (con el mutex tomado solo para el memcpy).
+ * El escritor intercambia ese buffer por uno vacio, lo escribe sin el mutex y recien despues del fdatasync()
+ * marca como durables todos los registros del lote. Si el disco no da abasto, los workers esperan a que haya lugar:
+ * un frame persistido nunca se descarta.
+ */
+
+#include "persistencia.h"
+
+t_persistencia* persistencia;
+
+static void* escribir_lotes(void* arg);
+
+/**
+ * @brief Arma la ruta de un segmento a partir del numero de su primer registro
+ */
+static void ruta_segmento(t_persistencia* persistencia, uint64_t primero, char* ruta, size_t tamanio)
+{
+	snprintf(ruta, tamanio, "%s/segmento-%020" PRIu64 ".log", persistencia->directorio, primero);
+}
+
+/**
+ * @brief Crea un segmento nuevo, reservando todo su tamanio de una vez
+ * @return fd del segmento, o -1 si no se pudo crear
+ */
+static int crear_segmento(t_persistencia* persistencia, uint64_t primero)
+{
+	char ruta[PATH_MAX];
+	ruta_segmento(persistencia, primero, ruta, sizeof(ruta));
+	int segmento = open(ruta, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(segmento == -1)
+		return -1;
+
+	// Si el sistema de archivos no soporta fallocate() se sigue igual: solo se pierde la reserva anticipada
+	if(fallocate(segmento, 0, 0, persistencia->tamanio_segmento) == -1)
+		log_warning(logger, "Persistencia: no se pudo reservar %s: %s", ruta, strerror(errno));
+	// El archivo nuevo recien sobrevive a un corte de luz cuando se sincroniza el directorio que lo contiene
+	fsync(persistencia->directorio_fd);
+	return segmento;
+}
+
+/**
+ * @brief Indica si hay un registro valido en @p datos + @p posicion
+ * @return tamanio total del registro (encabezado incluido), o 0 si no hay (fin del segmento o registro cortado)
+ */
+static size_t registro_valido(const uint8_t* datos, size_t tamanio, size_t posicion)
+{
+	if(tamanio - posicion < PERSISTENCIA_ENCABEZADO)
+		return 0;
+	uint32_t largo = leer_u32_le(datos + posicion);
+	if(largo > tamanio - posicion - PERSISTENCIA_ENCABEZADO)
+		return 0;
+	uLong crc = crc32(0, datos + posicion + 8, 2 + largo);
+	if(crc != leer_u32_le(datos + posicion + 4))
+		return 0;
+	return PERSISTENCIA_ENCABEZADO + largo;
+}
+
+/**
+ * @brief Busca el segmento con el numero mas alto del directorio
+ * @return true si hay alguno (su numero queda en @p primero)
+ */
+static bool buscar_ultimo_segmento(t_persistencia* persistencia, uint64_t* primero)
+{
+	DIR* directorio = opendir(persistencia->directorio);
+	if(directorio == NULL)
+		return false;
+
+	bool encontrado = false;
+	struct dirent* entrada;
+	while((entrada = readdir(directorio)) != NULL) {
+		uint64_t numero;
+		int largo = 0;
+		if(sscanf(entrada->d_name, "segmento-%" SCNu64 ".log%n", &numero, &largo) != 1 || entrada->d_name[largo] != '\0')
+			continue;
+		if(!encontrado || numero > *primero)
+			*primero = numero;
+		encontrado = true;
+	}
+	closedir(directorio);
+	return encontrado;
+}
+
+/**
+ * @brief Abre el ultimo segmento y se posiciona despues de su ultimo registro valido
+ * @return 0 si todo bien, -1 si no se pudo abrir o leer
+ */
+static int recuperar_segmento(t_persistencia* persistencia, uint64_t primero)
+{
+	char ruta[PATH_MAX];
+	ruta_segmento(persistencia, primero, ruta, sizeof(ruta));
+	persistencia->segmento = open(ruta, O_RDWR);
+	struct stat estado;
+	if(persistencia->segmento == -1 || fstat(persistencia->segmento, &estado) == -1)
+		return -1;
+
+	size_t tamanio = estado.st_size;
+	uint64_t registros = 0;
+	size_t posicion = 0;
+	if(tamanio > 0) {
+		uint8_t* datos = mmap(NULL, tamanio, PROT_READ, MAP_PRIVATE, persistencia->segmento, 0);
+		if(datos == MAP_FAILED)
+			return -1;
+		size_t largo;
+		while((largo = registro_valido(datos, tamanio, posicion)) > 0) {
+			posicion += largo;
+			registros++;
+		}
+		munmap(datos, tamanio);
+	}
+
+	// Lo que sigue al ultimo registro valido (un lote a medio escribir) se pone en ceros:
+	// si no, un registro viejo podria volver a parecer valido despues de los nuevos
+	if(posicion < tamanio && fallocate(persistencia->segmento, FALLOC_FL_ZERO_RANGE, posicion, tamanio - posicion) == -1)
+		log_warning(logger, "Persistencia: no se pudo limpiar el final de %s: %s", ruta, strerror(errno));
+
+	persistencia->posicion = posicion;
+	persistencia->escritos = primero + registros;
+	log_info(logger, "Persistencia: %" PRIu64 " registros previos, se sigue en %s (byte %zu)", persistencia->escritos, ruta, posicion);
+	return 0;
+}
+
+t_persistencia* persistencia_abrir(char* directorio, size_t tamanio_segmento, size_t buffer_maximo)
+{
+	if(mkdir(directorio, 0755) == -1 && errno != EEXIST)
+		return NULL;
+	int directorio_fd = open(directorio, O_RDONLY | O_DIRECTORY);
+	if(directorio_fd == -1)
+		return NULL;
+
+	t_persistencia* persistencia = calloc(1, sizeof(t_persistencia));
+	persistencia->directorio = strdup(directorio);
+	persistencia->directorio_fd = directorio_fd;
+	persistencia->tamanio_segmento = tamanio_segmento;
+	persistencia->buffer_maximo = buffer_maximo;
+
+	uint64_t primero;
+	if(buscar_ultimo_segmento(persistencia, &primero)) {
+		if(recuperar_segmento(persistencia, primero) == -1) {
+			log_error(logger, "Persistencia: no se pudo recuperar el segmento %" PRIu64 ": %s", primero, strerror(errno));
+			if(persistencia->segmento != -1)
+				close(persistencia->segmento);
+			close(directorio_fd);
+			free(persistencia->directorio);
+			free(persistencia);
+			return NULL;
+		}
+	}
+	else if((persistencia->segmento = crear_segmento(persistencia, 0)) == -1) {
+		close(directorio_fd);
+		free(persistencia->directorio);
+		free(persistencia);
+		return NULL;
+	}
+
+	persistencia->encolados = persistencia->escritos;
+	persistencia->durables = persistencia->escritos;
+	persistencia->activo = true;
+	pthread_mutex_init(&persistencia->mutex, NULL);
+	pthread_cond_init(&persistencia->hay_pendientes, NULL);
+	pthread_cond_init(&persistencia->hay_lugar, NULL);
+	pthread_cond_init(&persistencia->hay_durables, NULL);
+
+	pthread_create(&persistencia->escritor, NULL, escribir_lotes, persistencia);
+	return persistencia;
+}
+
+uint64_t persistencia_agregar(t_persistencia* persistencia, int cod_op, int version, const void* payload, int size)
+{
+	// El encabezado y el crc se calculan sin el mutex: adentro solo queda el memcpy
+	uint8_t encabezado[PERSISTENCIA_ENCABEZADO];
+	escribir_u32_le(encabezado, size);
+	encabezado[8] = cod_op;
+	encabezado[9] = version;
+	uLong crc = crc32(crc32(0, encabezado + 8, 2), payload, size);
+	escribir_u32_le(encabezado + 4, crc);
+	size_t largo = PERSISTENCIA_ENCABEZADO + size;
+
+	pthread_mutex_lock(&persistencia->mutex);
+	// Backpressure: si el escritor va atrasado se espera (un registro mas grande que el buffer entra solo)
+	while(persistencia->cantidad_pendientes > 0 && persistencia->cantidad_pendientes + largo > persistencia->buffer_maximo)
+		pthread_cond_wait(&persistencia->hay_lugar, &persistencia->mutex);
+
+	if(persistencia->cantidad_pendientes + largo > persistencia->capacidad_pendientes) {
+		size_t capacidad = persistencia->capacidad_pendientes > 0 ? persistencia->capacidad_pendientes : 64 * 1024;
+		while(capacidad < persistencia->cantidad_pendientes + largo)
+			capacidad *= 2;
+		persistencia->pendientes = realloc(persistencia->pendientes, capacidad);
+		persistencia->capacidad_pendientes = capacidad;
+	}
+	uint8_t* destino = persistencia->pendientes + persistencia->cantidad_pendientes;
+	memcpy(destino, encabezado, PERSISTENCIA_ENCABEZADO);
+	memcpy(destino + PERSISTENCIA_ENCABEZADO, payload, size);
+
+	// El escritor solo duerme con el buffer vacio: alcanza con despertarlo al agregar el primero
+	if(persistencia->cantidad_pendientes == 0)
+		pthread_cond_signal(&persistencia->hay_pendientes);
+	persistencia->cantidad_pendientes += largo;
+	uint64_t numero = ++persistencia->encolados;
+	pthread_mutex_unlock(&persistencia->mutex);
+	return numero;
+}
+
+int persistencia_esperar(t_persistencia* persistencia, uint64_t numero)
+{
+	pthread_mutex_lock(&persistencia->mutex);
+	// Termina siempre: el escritor vacia todo lo encolado (aun al cerrar) o marca el fallo
+	while(persistencia->durables < numero && !persistencia->fallo)
+		pthread_cond_wait(&persistencia->hay_durables, &persistencia->mutex);
+	int resultado = persistencia->durables >= numero ? 0 : -1;
+	pthread_mutex_unlock(&persistencia->mutex);
+	return resultado;
+}
+
+/**
+ * @brief Sincroniza y cierra el segmento actual y abre uno nuevo que empieza en el proximo registro
+ */
+static int rotar_segmento(t_persistencia* persistencia)
+{
+	if(fdatasync(persistencia->segmento) == -1)
+		return -1;
+	close(persistencia->segmento);
+	persistencia->segmento = crear_segmento(persistencia, persistencia->escritos);
+	persistencia->posicion = 0;
+	return persistencia->segmento == -1 ? -1 : 0;
+}
+
+/**
+ * @brief Escribe un lote de registros, pasando a un segmento nuevo cada vez que el actual se llena
+ * @return 0 si todo bien, -1 si fallo alguna escritura
+ * @note Un registro nunca queda partido entre dos segmentos
+ */
+static int escribir_lote(t_persistencia* persistencia, const uint8_t* datos, size_t cantidad)
+{
+	size_t inicio = 0;
+	while(inicio < cantidad) {
+		// Se toman todos los registros enteros que entran en lo que queda del segmento
+		size_t fin = inicio;
+		uint64_t registros = 0;
+		while(fin < cantidad) {
+			size_t largo = PERSISTENCIA_ENCABEZADO + leer_u32_le(datos + fin);
+			bool segmento_vacio = persistencia->posicion == 0 && fin == inicio; // uno mas grande que el segmento va solo
+			if(persistencia->posicion + (fin - inicio) + largo > persistencia->tamanio_segmento && !segmento_vacio)
+				break;
+			fin += largo;
+			registros++;
+		}
+
+		if(fin == inicio) {
+			if(rotar_segmento(persistencia) == -1)
+				return -1;
+			continue;
+		}
+		if(escribir_todo(persistencia->segmento, datos + inicio, fin - inicio, persistencia->posicion) == -1)
+			return -1;
+		persistencia->posicion += fin - inicio;
+		persistencia->escritos += registros;
+		inicio = fin;
+	}
+	return 0;
+}
+
+static void* escribir_lotes(void* arg)
+{
+	t_persistencia* persistencia = arg;
+	pthread_mutex_lock(&persistencia->mutex);
+	while(1) {
+		while(persistencia->cantidad_pendientes == 0 && persistencia->activo)
+			pthread_cond_wait(&persistencia->hay_pendientes, &persistencia->mutex);
+		if(persistencia->cantidad_pendientes == 0)
+			break; // cerrando y ya no queda nada
+
+		// Se toma todo lo acumulado y se deja un buffer vacio para que los workers sigan encolando
+		uint8_t* lote = persistencia->pendientes;
+		size_t capacidad = persistencia->capacidad_pendientes;
+		size_t cantidad = persistencia->cantidad_pendientes;
+		persistencia->pendientes = persistencia->escribiendo;
+		persistencia->capacidad_pendientes = persistencia->capacidad_escribiendo;
+		persistencia->cantidad_pendientes = 0;
+		persistencia->escribiendo = lote;
+		persistencia->capacidad_escribiendo = capacidad;
+		uint64_t hasta = persistencia->encolados;
+		pthread_cond_broadcast(&persistencia->hay_lugar);
+		pthread_mutex_unlock(&persistencia->mutex);
+
+		// Un solo fdatasync() para todos los registros del lote, vengan de la conexion que vengan
+		int resultado = escribir_lote(persistencia, lote, cantidad);
+		if(resultado == 0)
+			resultado = fdatasync(persistencia->segmento);
+		if(resultado == -1)
+			log_error(logger, "Persistencia: fallo la escritura de un lote de %zu bytes: %s", cantidad, strerror(errno));
+
+		pthread_mutex_lock(&persistencia->mutex);
+		// Despues de un fallo no se promete nada mas: puede haber un hueco en el log
+		if(resultado == -1)
+			persistencia->fallo = true;
+		else if(!persistencia->fallo)
+			persistencia->durables = hasta;
+		persistencia->lotes++;
+		pthread_cond_broadcast(&persistencia->hay_durables);
+	}
+	pthread_mutex_unlock(&persistencia->mutex);
+	return NULL;
+}
+
+void persistencia_cerrar(t_persistencia* persistencia)
+{
+	pthread_mutex_lock(&persistencia->mutex);
+	persistencia->activo = false;
+	pthread_cond_signal(&persistencia->hay_pendientes);
+	pthread_mutex_unlock(&persistencia->mutex);
+	pthread_join(persistencia->escritor, NULL); // el escritor termina despues de vaciar lo pendiente
+
+	log_info(logger, "Persistencia: %" PRIu64 " registros durables, %" PRIu64 " lotes", persistencia->durables, persistencia->lotes);
+	if(persistencia->segmento != -1)
+		close(persistencia->segmento);
+	close(persistencia->directorio_fd);
+	pthread_cond_destroy(&persistencia->hay_durables);
+	pthread_cond_destroy(&persistencia->hay_lugar);
+	pthread_cond_destroy(&persistencia->hay_pendientes);
+	pthread_mutex_destroy(&persistencia->mutex);
+	free(persistencia->pendientes);
+	free(persistencia->escribiendo);
+	free(persistencia->directorio);
+	free(persistencia);
+}
@@ -0,0 +1,125 @@
+/**
+ * @file persistencia.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de la persistencia de los frames recibidos
+ *
+ * Cada frame recibido se agrega a un log en disco de solo agregado (append-only), partido en segmentos.
+ * Hacer fdatasync() por cada mensaje limitaria el servidor a unos pocos miles por segundo: en cambio los
+ * workers solo copian el registro a un buffer compartido y un hilo escritor vuelca todo lo acumulado con
+ * un unico pwrite() + fdatasync() por lote (group commit). Mientras un lote se sincroniza se va llenando el siguiente,
+ * asi que cuanto mas carga hay, mas registros entran en cada fdatasync().
+ * Lo que se confirma con un ACK espera a ser durable: la conexion llama a persistencia_esperar() una vez por lote de
+ * frames, con el ultimo registro del lote (ver conexion.h). En el event loop esa espera frena a sus demas conexiones:
+ * con persistencia conviene PROCESADORES.
+ *
+ * Formato de cada registro (enteros little endian):
+ * | uint32 tamanio | uint32 crc32 | uint8 cod_op | uint8 version | tamanio bytes de payload |
+ * El crc32 cubre cod_op, version y payload. El payload es el original (ya descomprimido), en la version de la conexion.
+ *
+ * Los segmentos se llaman segmento-<numero del primer registro>.log y se reservan completos al crearlos (fallocate),
+ * asi escribir no cambia el tamanio del archivo y fdatasync() no tiene que actualizar metadatos.
+ * El final valido de un segmento es el primer registro con crc invalido (la parte reservada queda en ceros).
+ * @see https://man7.org/linux/man-pages/man2/fdatasync.2.html
+ * @see https://man7.org/linux/man-pages/man2/fallocate.2.html
+ */
+
+#ifndef PERSISTENCIA_H_
+#define PERSISTENCIA_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint64_t: numeros de registro
+#include<stdbool.h> // bool
+#include<inttypes.h> // PRIu64 para los nombres de los segmentos
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilo escritor, mutex y condiciones del group commit
+#include<dirent.h> // buscar el ultimo segmento al arrancar
+#include<sys/stat.h> // mkdir, fstat
+#include<sys/mman.h> // mmap para recorrer el ultimo segmento al recuperar
+
+// zlib (crc32 de cada registro)
+#include<zlib.h>
+
+// Inclusión del archivo de utilidades
+#include "utils.h"
+
+/* Bytes del encabezado de cada registro: | tamanio | crc32 | cod_op | version | */
+#define PERSISTENCIA_ENCABEZADO 10
+
+/* Tamanio por defecto de cada segmento (PERSISTENCIA_SEGMENTO_MB en servidor.config) */
+#define PERSISTENCIA_SEGMENTO_DEFECTO (64 * 1024 * 1024)
+
+/* Bytes por defecto que se acumulan como mucho sin escribir (PERSISTENCIA_BUFFER_MB en servidor.config) */
+#define PERSISTENCIA_BUFFER_DEFECTO (8 * 1024 * 1024)
+
+/**
+ * @brief Log persistente de frames recibidos
+ */
+typedef struct
+{
+	char* directorio; /**< donde estan los segmentos */
+	int directorio_fd; /**< para sincronizar la creacion de segmentos nuevos */
+	size_t tamanio_segmento; /**< bytes reservados por segmento */
+	size_t buffer_maximo; /**< bytes pendientes a partir de los cuales los workers esperan al escritor */
+
+	int segmento; /**< fd del segmento actual (solo lo usa el escritor) */
+	size_t posicion; /**< proximo byte a escribir en el segmento actual */
+	uint64_t escritos; /**< registros escritos en disco (incluye los de segmentos anteriores) */
+
+	uint8_t* pendientes; /**< registros encolados por los workers, esperando al escritor */
+	size_t cantidad_pendientes; /**< bytes usados de pendientes */
+	size_t capacidad_pendientes; /**< bytes reservados en pendientes */
+	uint8_t* escribiendo; /**< lote que esta escribiendo el escritor (se intercambia con pendientes) */
+	size_t capacidad_escribiendo; /**< bytes reservados en escribiendo */
+
+	uint64_t encolados; /**< registros encolados desde siempre (el numero del ultimo encolado) */
+	uint64_t durables; /**< registros que ya pasaron por fdatasync() */
+	uint64_t lotes; /**< cantidad de fdatasync() hechos (para ver cuantos registros entran por lote) */
+	bool fallo; /**< hubo un error de disco: lo encolado despues puede no estar en disco */
+	bool activo; /**< false cuando se esta cerrando */
+
+	pthread_mutex_t mutex; /**< protege pendientes y los contadores */
+	pthread_cond_t hay_pendientes; /**< despierta al escritor */
+	pthread_cond_t hay_lugar; /**< despierta a los workers que esperan lugar en pendientes */
+	pthread_cond_t hay_durables; /**< despierta a quienes esperan que un registro llegue a disco */
+	pthread_t escritor;
+} t_persistencia;
+
+// Declaracion de variable global (NULL si PERSISTENCIA_DIR no esta en servidor.config)
+extern t_persistencia* persistencia;
+
+/**
+ * @brief Abre (o crea) el log en @p directorio y lanza el hilo escritor
+ * @param directorio carpeta de los segmentos (se crea si no existe)
+ * @param tamanio_segmento bytes a reservar por segmento
+ * @param buffer_maximo bytes pendientes maximos antes de frenar a los workers
+ * @return el log listo para agregar, o NULL si no se pudo abrir el directorio o el ultimo segmento
+ * @note Si ya habia segmentos, se sigue despues del ultimo registro valido (un registro cortado por un corte de luz se descarta)
+ */
+t_persistencia* persistencia_abrir(char* directorio, size_t tamanio_segmento, size_t buffer_maximo);
+
+/**
+ * @brief Encola un frame para escribirlo en el proximo lote
+ * @param persistencia log abierto
+ * @param cod_op codigo de operacion del frame
+ * @param version version de protocolo del payload
+ * @param payload datos del frame (se copian: se pueden liberar al retornar)
+ * @param size tamanio del payload
+ * @return numero del registro (para persistencia_esperar())
+ * @note No espera al disco. Solo bloquea si hay mas de buffer_maximo bytes pendientes (el disco no da abasto)
+ */
+uint64_t persistencia_agregar(t_persistencia* persistencia, int cod_op, int version, const void* payload, int size);
+
+/**
+ * @brief Espera a que el registro @p numero (y todos los anteriores) este en disco
+ * @return 0 si ya es durable, -1 si hubo un error de disco o el log se cerro antes
+ */
+int persistencia_esperar(t_persistencia* persistencia, uint64_t numero);
+
+/**
+ * @brief Escribe y sincroniza todo lo pendiente, frena el escritor y libera el log
+ */
+void persistencia_cerrar(t_persistencia* persistencia);
+
+#endif /* PERSISTENCIA_H_ */
@@ -0,0 +1,75 @@
+/**
+ * @file pila_atomica.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Pila sin locks para pasar elementos entre hilos, que se vacia de una vez y en orden de llegada
+ *
+ * Cualquier hilo apila con un compare-and-swap; quien consume se lleva todo lo apilado con un solo exchange
+ * y lo da vuelta. Como nunca se saca de a un elemento no hay problema de ABA, y cada tanda que se lleva un
+ * consumidor es un prefijo de lo apilado: lo que se toma en tandas sucesivas sale en el mismo orden en que entro.
+ * Los elementos tienen que empezar con un t_nodo (la pila no reserva nada).
+ * @see https://en.wikipedia.org/wiki/Treiber_stack
+ */
+
+#ifndef PILA_ATOMICA_H_
+#define PILA_ATOMICA_H_
+
+// Librerias standard de C
+#include<stddef.h> // NULL
+#include<stdbool.h> // bool
+
+/**
+ * @brief Enlace de un elemento (tiene que ser su primer campo)
+ */
+typedef struct t_nodo
+{
+	struct t_nodo* siguiente; /**< elemento apilado antes (o el que sigue, despues de pila_tomar_todo()) */
+} t_nodo;
+
+/**
+ * @brief Pila compartida entre hilos (en cero esta vacia)
+ */
+typedef struct
+{
+	t_nodo* cima; /**< ultimo elemento apilado */
+} t_pila;
+
+/**
+ * @brief Apila un elemento (desde cualquier hilo)
+ * @return true si la pila estaba vacia: quien consume puede estar esperando un aviso
+ */
+static inline bool pila_apilar(t_pila* pila, t_nodo* nodo)
+{
+	t_nodo* cima = __atomic_load_n(&pila->cima, __ATOMIC_RELAXED);
+	do
+		nodo->siguiente = cima;
+	while(!__atomic_compare_exchange_n(&pila->cima, &cima, nodo, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+	return cima == NULL;
+}
+
+/**
+ * @brief Se lleva todo lo apilado
+ * @return el primero que se apilo (seguir por siguiente), o NULL si estaba vacia
+ */
+static inline t_nodo* pila_tomar_todo(t_pila* pila)
+{
+	t_nodo* nodo = __atomic_exchange_n(&pila->cima, NULL, __ATOMIC_SEQ_CST);
+	t_nodo* en_orden = NULL;
+	while(nodo != NULL) {
+		t_nodo* siguiente = nodo->siguiente;
+		nodo->siguiente = en_orden;
+		en_orden = nodo;
+		nodo = siguiente;
+	}
+	return en_orden;
+}
+
+/**
+ * @brief Indica si no hay nada apilado (puede cambiar apenas retorna)
+ */
+static inline bool pila_vacia(t_pila* pila)
+{
+	return __atomic_load_n(&pila->cima, __ATOMIC_SEQ_CST) == NULL;
+}
+
+#endif /* PILA_ATOMICA_H_ */
@@ -0,0 +1,348 @@
+/**
+ * @file procesadores.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del pool de procesadores
+ *
+ * Cola global: arreglo circular de celdas con numero de secuencia (Vyukov). Una celda esta libre para la posicion p
+ * si su secuencia es p y tiene una conexion para sacar si es p + 1; cada lado reserva su posicion con un CAS.
+ * Deque de cada procesador: Chase-Lev con los ordenes de memoria de Le et al. (PPoPP 2013); el dueño apila y saca
+ * por abajo sin CAS salvo cuando queda un solo elemento, los ladrones sacan por arriba con un CAS.
+ * Para dormir sin perder avisos: el procesador se anota en dormidos y vuelve a mirar las colas antes de esperar;
+ * quien encola publica y despues mira dormidos. Con ordenes seq_cst alguno de los dos ve al otro.
+ */
+
+#include "procesadores.h"
+#include "workers.h"
+
+/**
+ * @brief Celda de la cola global
+ */
+typedef struct
+{
+	uint64_t secuencia; /**< posicion para la que esta libre (o posicion + 1 si tiene conexion) */
+	t_conexion* conexion;
+} t_celda;
+
+/**
+ * @brief Un hilo del pool con su deque
+ */
+typedef struct
+{
+	pthread_t hilo;
+	int id; /**< numero de procesador (0..N-1), para el nombre del hilo */
+	// Cada uno en su linea de cache: arriba lo escriben los ladrones, abajo solo el dueño
+	int64_t arriba __attribute__((aligned(64))); /**< proximo a robar */
+	int64_t abajo __attribute__((aligned(64))); /**< proximo lugar libre (solo lo escribe el dueño) */
+	t_conexion* deque[PROCESADORES_DEQUE];
+	unsigned semilla; /**< para elegir a quien robarle */
+} t_procesador;
+
+/**
+ * @brief Estado del pool (uno solo para todo el servidor)
+ */
+typedef struct
+{
+	t_procesador* procesadores;
+	int cantidad;
+	t_procesar_frame procesar;
+	t_celda* cola;
+	uint64_t entrada; /**< proxima posicion para encolar */
+	uint64_t salida; /**< proxima posicion para desencolar */
+	int dormidos; /**< procesadores anotados para dormir */
+	uint64_t turno; /**< cambia con cada aviso: el que duerme espera a que sea distinto del que vio */
+	pthread_mutex_t mutex;
+	pthread_cond_t hay_trabajo;
+} t_pool;
+
+static t_pool pool = { .procesadores = NULL, .cantidad = 0 };
+
+/**
+ * @brief Encola una conexion en la cola global
+ * @return false si esta llena
+ */
+static bool cola_encolar(t_conexion* conexion)
+{
+	uint64_t posicion = __atomic_load_n(&pool.entrada, __ATOMIC_RELAXED);
+	t_celda* celda;
+	while(1) {
+		celda = &pool.cola[posicion & (PROCESADORES_COLA - 1)];
+		int64_t diferencia = (int64_t) (__atomic_load_n(&celda->secuencia, __ATOMIC_ACQUIRE) - posicion);
+		if(diferencia == 0) {
+			if(__atomic_compare_exchange_n(&pool.entrada, &posicion, posicion + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		else if(diferencia < 0)
+			return false; // la celda todavia tiene la conexion de una vuelta anterior
+		else
+			posicion = __atomic_load_n(&pool.entrada, __ATOMIC_RELAXED);
+	}
+	celda->conexion = conexion;
+	__atomic_store_n(&celda->secuencia, posicion + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief Saca una conexion de la cola global
+ * @return la conexion, o NULL si esta vacia
+ */
+static t_conexion* cola_desencolar(void)
+{
+	uint64_t posicion = __atomic_load_n(&pool.salida, __ATOMIC_RELAXED);
+	t_celda* celda;
+	while(1) {
+		celda = &pool.cola[posicion & (PROCESADORES_COLA - 1)];
+		int64_t diferencia = (int64_t) (__atomic_load_n(&celda->secuencia, __ATOMIC_ACQUIRE) - (posicion + 1));
+		if(diferencia == 0) {
+			if(__atomic_compare_exchange_n(&pool.salida, &posicion, posicion + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		else if(diferencia < 0)
+			return NULL;
+		else
+			posicion = __atomic_load_n(&pool.salida, __ATOMIC_RELAXED);
+	}
+	t_conexion* conexion = celda->conexion;
+	__atomic_store_n(&celda->secuencia, posicion + PROCESADORES_COLA, __ATOMIC_RELEASE); // libre para la proxima vuelta
+	return conexion;
+}
+
+/**
+ * @brief Apila en la deque propia (solo el dueño)
+ * @return false si esta llena
+ */
+static bool deque_apilar(t_procesador* procesador, t_conexion* conexion)
+{
+	int64_t abajo = __atomic_load_n(&procesador->abajo, __ATOMIC_RELAXED);
+	int64_t arriba = __atomic_load_n(&procesador->arriba, __ATOMIC_ACQUIRE);
+	if(abajo - arriba >= PROCESADORES_DEQUE)
+		return false;
+	__atomic_store_n(&procesador->deque[abajo & (PROCESADORES_DEQUE - 1)], conexion, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&procesador->abajo, abajo + 1, __ATOMIC_RELAXED);
+	return true;
+}
+
+/**
+ * @brief Saca lo ultimo apilado en la deque propia (solo el dueño)
+ * @return la conexion, o NULL si esta vacia (o un ladron se llevo la ultima)
+ */
+static t_conexion* deque_sacar(t_procesador* procesador)
+{
+	int64_t abajo = __atomic_load_n(&procesador->abajo, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&procesador->abajo, abajo, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t arriba = __atomic_load_n(&procesador->arriba, __ATOMIC_RELAXED);
+	if(arriba > abajo) { // estaba vacia
+		__atomic_store_n(&procesador->abajo, abajo + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	t_conexion* conexion = __atomic_load_n(&procesador->deque[abajo & (PROCESADORES_DEQUE - 1)], __ATOMIC_RELAXED);
+	if(arriba == abajo) { // era la ultima: se la disputa con los ladrones
+		if(!__atomic_compare_exchange_n(&procesador->arriba, &arriba, arriba + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			conexion = NULL;
+		__atomic_store_n(&procesador->abajo, abajo + 1, __ATOMIC_RELAXED);
+	}
+	return conexion;
+}
+
+/**
+ * @brief Roba lo mas viejo de la deque de otro procesador
+ * @return la conexion, o NULL si estaba vacia o perdio la carrera
+ */
+static t_conexion* deque_robar(t_procesador* victima)
+{
+	int64_t arriba = __atomic_load_n(&victima->arriba, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t abajo = __atomic_load_n(&victima->abajo, __ATOMIC_ACQUIRE);
+	if(arriba >= abajo)
+		return NULL;
+	t_conexion* conexion = __atomic_load_n(&victima->deque[arriba & (PROCESADORES_DEQUE - 1)], __ATOMIC_RELAXED);
+	if(!__atomic_compare_exchange_n(&victima->arriba, &arriba, arriba + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+		return NULL;
+	return conexion;
+}
+
+/**
+ * @brief Despierta a un procesador si hay alguno dormido
+ * @note Se llama despues de publicar el trabajo (ver el comentario del principio)
+ */
+static void despertar(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&pool.dormidos, __ATOMIC_SEQ_CST) == 0)
+		return;
+	pthread_mutex_lock(&pool.mutex);
+	pool.turno++;
+	pthread_cond_signal(&pool.hay_trabajo);
+	pthread_mutex_unlock(&pool.mutex);
+}
+
+/**
+ * @brief Indica si hay algo para hacer en la cola global o en alguna deque
+ */
+static bool hay_trabajo(void)
+{
+	if(__atomic_load_n(&pool.salida, __ATOMIC_SEQ_CST) != __atomic_load_n(&pool.entrada, __ATOMIC_SEQ_CST))
+		return true;
+	for(int i = 0; i < pool.cantidad; i++)
+		if(__atomic_load_n(&pool.procesadores[i].arriba, __ATOMIC_SEQ_CST) < __atomic_load_n(&pool.procesadores[i].abajo, __ATOMIC_SEQ_CST))
+			return true;
+	return false;
+}
+
+static void dormir(void)
+{
+	__atomic_add_fetch(&pool.dormidos, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_lock(&pool.mutex);
+	uint64_t turno = pool.turno;
+	pthread_mutex_unlock(&pool.mutex);
+	if(!hay_trabajo()) { // lo que se encolo antes de anotarse se ve aca; lo de despues cambia el turno
+		pthread_mutex_lock(&pool.mutex);
+		while(pool.turno == turno)
+			pthread_cond_wait(&pool.hay_trabajo, &pool.mutex);
+		pthread_mutex_unlock(&pool.mutex);
+	}
+	__atomic_sub_fetch(&pool.dormidos, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Busca una conexion para atender: deque propia, cola global y por ultimo las deques de los demas
+ */
+static t_conexion* buscar_trabajo(t_procesador* procesador, unsigned vuelta)
+{
+	t_conexion* conexion = NULL;
+	if(vuelta % PROCESADORES_VUELTAS_GLOBAL == 0)
+		conexion = cola_desencolar();
+	if(conexion == NULL)
+		conexion = deque_sacar(procesador);
+	if(conexion == NULL)
+		conexion = cola_desencolar();
+	// Se roba empezando por uno al azar, asi los ladrones no van todos contra el mismo
+	int inicio = rand_r(&procesador->semilla) % pool.cantidad;
+	for(int i = 0; conexion == NULL && i < pool.cantidad; i++) {
+		t_procesador* victima = &pool.procesadores[(inicio + i) % pool.cantidad];
+		if(victima != procesador)
+			conexion = deque_robar(victima);
+	}
+	return conexion;
+}
+
+/**
+ * @brief Funcion de cada procesador
+ */
+static void* correr_procesador(void* arg)
+{
+	t_procesador* procesador = arg;
+	char nombre[16];
+	snprintf(nombre, sizeof(nombre), "procesador %d", procesador->id);
+	pthread_setname_np(pthread_self(), nombre);
+	metricas_registrar_hilo(); // los frames y sus latencias se cuentan en el hilo que los procesa
+
+	for(unsigned vuelta = 0;; vuelta++) {
+		t_conexion* conexion = buscar_trabajo(procesador, vuelta);
+		if(conexion == NULL) {
+			dormir();
+			continue;
+		}
+		if(!conexion_procesar_tareas(conexion, pool.procesar))
+			continue;
+		// Le siguieron llegando tareas: vuelve a la deque, donde la sigue atendiendo este procesador (esta en su cache)
+		// salvo que la robe uno sin trabajo; cada PROCESADORES_VUELTAS_GLOBAL vueltas se atiende antes la cola global
+		if(!deque_apilar(procesador, conexion))
+			while(!cola_encolar(conexion))
+				sched_yield();
+		despertar(); // hay algo para robar
+	}
+	return NULL;
+}
+
+bool procesadores_iniciar(int cantidad, t_procesar_frame procesar)
+{
+	if(cantidad <= 0)
+		cantidad = cantidad_de_cores();
+	if(cantidad > PROCESADORES_MAXIMO)
+		cantidad = PROCESADORES_MAXIMO;
+
+	pool.cola = malloc(PROCESADORES_COLA * sizeof(t_celda));
+	for(uint64_t i = 0; i < PROCESADORES_COLA; i++)
+		pool.cola[i].secuencia = i;
+	pool.entrada = pool.salida = 0;
+	pool.dormidos = 0;
+	pool.turno = 0;
+	pool.procesar = procesar;
+	pthread_mutex_init(&pool.mutex, NULL);
+	pthread_cond_init(&pool.hay_trabajo, NULL);
+	// Con arriba y abajo alineados, sizeof(t_procesador) es multiplo de 64: dos procesadores no comparten ninguna linea
+	pool.procesadores = aligned_alloc(64, cantidad * sizeof(t_procesador));
+	for(int i = 0; i < cantidad; i++) // los primeros pueden robarle a los que todavia no arrancaron
+		pool.procesadores[i].arriba = pool.procesadores[i].abajo = 0;
+	pool.cantidad = cantidad;
+
+	int lanzados = 0;
+	for(int i = 0; i < cantidad; i++) {
+		t_procesador* procesador = &pool.procesadores[lanzados];
+		procesador->id = i;
+		procesador->semilla = i + 1;
+		if(pthread_create(&procesador->hilo, NULL, correr_procesador, procesador) != 0) {
+			log_error(logger, "No se pudo crear el procesador %d", i);
+			continue;
+		}
+		pthread_detach(procesador->hilo);
+		lanzados++;
+	}
+	__atomic_store_n(&pool.cantidad, lanzados, __ATOMIC_RELAXED); // si fallo alguno, sobran deques vacias al final
+	if(lanzados == 0) {
+		free(pool.procesadores);
+		free(pool.cola);
+		pool.procesadores = NULL;
+		return false;
+	}
+	return true;
+}
+
+bool procesadores_activos(void)
+{
+	return pool.procesadores != NULL;
+}
+
+void procesadores_programar(t_conexion* conexion)
+{
+	// Cada conexion esta a lo sumo una vez: solo se llena con mas de PROCESADORES_COLA conexiones con tareas a la vez
+	while(!cola_encolar(conexion))
+		sched_yield();
+	despertar();
+}
+
+t_buzon* buzon_crear(void)
+{
+	t_buzon* buzon = malloc(sizeof(t_buzon));
+	buzon->devoluciones.cima = NULL;
+	buzon->aviso = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(buzon->aviso == -1) {
+		free(buzon);
+		return NULL;
+	}
+	return buzon;
+}
+
+void buzon_entregar(t_buzon* buzon, t_devolucion* devolucion)
+{
+	// Si no estaba vacio el event loop ya tiene un aviso pendiente: no hace falta otra syscall
+	if(pila_apilar(&buzon->devoluciones, &devolucion->nodo)) {
+		uint64_t uno = 1;
+		if(write(buzon->aviso, &uno, sizeof(uno)) == -1 && errno != EAGAIN)
+			log_error(logger, "No se pudo avisar al event loop: %s", strerror(errno));
+	}
+}
+
+t_devolucion* buzon_recoger(t_buzon* buzon)
+{
+	return (t_devolucion*) pila_tomar_todo(&buzon->devoluciones);
+}
+
+void buzon_destruir(t_buzon* buzon)
+{
+	close(buzon->aviso);
+	free(buzon);
+}
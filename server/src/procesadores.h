@@ -0,0 +1,103 @@
+/**
+ * @file procesadores.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del pool de hilos que procesa los frames fuera de los event loops
+ *
+ * Con PROCESADORES en servidor.config, los workers solo hacen I/O: separan los frames y los dejan como tareas
+ * en la conexion (ver conexion.h). La conexion con tareas nuevas se programa en el pool y un procesador la atiende
+ * entera: procesa todas sus tareas en orden y entrega las respuestas al buzon del event loop que la lee, que las
+ * envia. Una conexion la atiende un solo procesador a la vez (orden por conexion); conexiones distintas se procesan
+ * en paralelo, asi un handler lento no frena las lecturas y uno pesado usa todos los cores.
+ * - cola global (MPMC acotada, sin locks): donde los event loops ponen las conexiones que pasan a tener tareas;
+ * - una deque por procesador (Chase-Lev): donde vuelve la conexion que siguio recibiendo tareas mientras se la
+ *   atendia; el procesador la saca por abajo (sigue en su cache) y los que no tienen trabajo roban por arriba;
+ * - buzon por event loop: pila sin locks de devoluciones mas un eventfd que lo despierta (solo al pasar de vacio a no vacio).
+ *   Lo tienen todos los event loops, haya pool o no: por ahi tambien llegan las publicaciones (ver topicos.h).
+ * Un procesador sin trabajo se duerme en una variable de condicion; solo se lo despierta si hay alguno dormido.
+ * @see https://dl.acm.org/doi/10.1145/1073970.1073974 (Chase y Lev, "Dynamic circular work-stealing deque")
+ * @see https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#ifndef PROCESADORES_H_
+#define PROCESADORES_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint64_t
+#include<stdbool.h> // bool
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // hilos del pool, variable de condicion para dormir
+#include<sched.h> // sched_yield con la cola global llena
+#include<sys/eventfd.h> // aviso al event loop
+
+// Inclusión de la conexion (tareas y devoluciones)
+#include "conexion.h"
+
+/* Procesadores como mucho */
+#define PROCESADORES_MAXIMO 64
+
+/* Conexiones en la cola global (potencia de 2; cada conexion esta a lo sumo una vez) */
+#define PROCESADORES_COLA (64 * 1024)
+
+/* Conexiones en la deque de cada procesador (potencia de 2); si se llena van a la cola global */
+#define PROCESADORES_DEQUE 1024
+
+/* Cada cuantas vueltas un procesador mira la cola global antes que su deque (para que no la posterguen siempre) */
+#define PROCESADORES_VUELTAS_GLOBAL 32
+
+/**
+ * @brief Donde los procesadores devuelven las respuestas a un event loop (y donde le llegan las publicaciones)
+ */
+typedef struct t_buzon
+{
+	t_pila devoluciones; /**< t_devolucion sin recoger, de todas sus conexiones */
+	int aviso; /**< eventfd: se escribe cuando devoluciones pasa de vacia a no vacia */
+	uint64_t contador; /**< destino del read() del eventfd (el backend io_uring lo lee de forma asincronica) */
+} t_buzon;
+
+/**
+ * @brief Lanza el pool
+ * @param cantidad procesadores (<= 0: uno por core; hasta PROCESADORES_MAXIMO)
+ * @param procesar funcion que procesa cada frame (la misma que usarian los event loops)
+ * @return true si se lanzo al menos un procesador
+ * @note Hay que llamarla antes de lanzar los workers: sus conexiones usan el pool solo si ya estaba lanzado
+ */
+bool procesadores_iniciar(int cantidad, t_procesar_frame procesar);
+
+/**
+ * @brief Indica si hay pool (si no, los event loops procesan los frames en su hilo)
+ */
+bool procesadores_activos(void);
+
+/**
+ * @brief Pone en la cola global una conexion que paso a tener tareas
+ * @param conexion conexion con programada ya en true y una referencia para el procesador que la atienda
+ * @note Desde los event loops
+ */
+void procesadores_programar(t_conexion* conexion);
+
+/**
+ * @brief Crea el buzon de un event loop
+ * @return el buzon, o NULL si no se pudo crear el eventfd
+ */
+t_buzon* buzon_crear(void);
+
+/**
+ * @brief Entrega una devolucion al buzon (desde un procesador o quien publica) y despierta al event loop si hace falta
+ */
+void buzon_entregar(t_buzon* buzon, t_devolucion* devolucion);
+
+/**
+ * @brief Se lleva todas las devoluciones del buzon (desde su event loop)
+ * @return la primera en orden de llegada (seguir por nodo.siguiente), o NULL si no habia
+ * @note No lee el eventfd: el event loop lo hace antes de llamarla (con epoll) o ya lo leyo (con io_uring)
+ */
+t_devolucion* buzon_recoger(t_buzon* buzon);
+
+/**
+ * @brief Cierra el eventfd y libera el buzon
+ */
+void buzon_destruir(t_buzon* buzon);
+
+#endif /* PROCESADORES_H_ */
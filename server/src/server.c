@@ -14,34 +14,138 @@
 
 int main(void) {
 	logger = log_create("log.log", "Servidor", 1, LOG_LEVEL_DEBUG);
-	// fd: file descriptor
-	int server_fd = iniciar_servidor(); // nos permite distinguir una conexion de otra
-	log_info(logger, "Servidor listo para recibir al cliente");
-	int cliente_fd = esperar_cliente(server_fd);
-
-	t_list* lista;
-	while (1) {
-		int cod_op = recibir_operacion(cliente_fd); // el recibir es bloqueante -> se queda esperando en esa linea
-		switch (cod_op) { //con el cod_op elijo que estoy recibiendo?
-		case MENSAJE: // recibe los log_info
-			recibir_mensaje(cliente_fd);
-			break;
-		case PAQUETE: // recibe los paquete
-			lista = recibir_paquete(cliente_fd);
-			log_info(logger, "Me llegaron los siguientes valores:\n");
-			list_iterate(lista, (void*) iterator);
-			break;
-		case -1:
-			log_error(logger, "el cliente se desconecto. Terminando servidor");
+	t_config* config = iniciar_config();
+
+	// WORKERS: cantidad de hilos, cada uno con su socket de escucha y su event loop (0 = uno por core)
+	int workers = config_get_int_value(config, "WORKERS");
+	// IO_BACKEND: epoll (por defecto) o io_uring
+	t_backend_io backend = BACKEND_EPOLL;
+	if(config_has_property(config, "IO_BACKEND") && strcmp(config_get_string_value(config, "IO_BACKEND"), "io_uring") == 0)
+		backend = BACKEND_IO_URING;
+	// FRAME_MAXIMO_KB y PAQUETE_ELEMENTOS_MAXIMO: lo mas grande que se acepta de un cliente (ver t_limites_protocolo)
+	if(config_has_property(config, "FRAME_MAXIMO_KB")) {
+		int kb = config_get_int_value(config, "FRAME_MAXIMO_KB");
+		if(kb < 1)
+			kb = 1;
+		if(kb > 1024 * 1024)
+			kb = 1024 * 1024; // hasta 1 GB: los buffers de las conexiones se indexan con int
+		limites.frame_maximo = (uint32_t) kb * 1024;
+	}
+	if(config_has_property(config, "PAQUETE_ELEMENTOS_MAXIMO") && config_get_int_value(config, "PAQUETE_ELEMENTOS_MAXIMO") > 0)
+		limites.elementos_maximo = config_get_int_value(config, "PAQUETE_ELEMENTOS_MAXIMO");
+#ifdef TRAZAS
+	// TRAZA_ARCHIVO: si esta, cada etapa del camino caliente se mide y se vuelca en ese archivo con kill -USR1 (ver traza.h).
+	// Va antes de crear cualquier hilo: todos tienen que heredar SIGUSR1 bloqueada
+	if(config_has_property(config, "TRAZA_ARCHIVO")) {
+		if(traza_iniciar(config_get_string_value(config, "TRAZA_ARCHIVO"), SIGUSR1))
+			log_info(logger, "Trazas activas: kill -USR1 %d las vuelca en %s", getpid(), config_get_string_value(config, "TRAZA_ARCHIVO"));
+		else
+			log_warning(logger, "No se pudieron activar las trazas");
+	}
+#endif
+	// Log de lo recibido: lo escribe un hilo aparte (ver log_async.h)
+	int cola = config_has_property(config, "LOG_COLA") ? config_get_int_value(config, "LOG_COLA") : 8192;
+	t_politica_log politica = LOG_DESCARTAR;
+	if(config_has_property(config, "LOG_POLITICA") && strcmp(config_get_string_value(config, "LOG_POLITICA"), "bloquear") == 0)
+		politica = LOG_BLOQUEAR;
+	logger_async = log_async_crear("log.log", "Servidor", 1, LOG_LEVEL_DEBUG, cola, politica);
+	if(logger_async == NULL) {
+		log_error(logger, "No se pudo abrir log.log para el log asincronico");
+		return EXIT_FAILURE;
+	}
+	// METRICAS_PUERTO: si esta, las metricas de los workers se exportan en http://127.0.0.1:<puerto>/metrics (ver metricas.h)
+	if(config_has_property(config, "METRICAS_PUERTO") && !metricas_iniciar(config_get_int_value(config, "METRICAS_PUERTO")))
+		log_warning(logger, "No se pudo abrir el puerto de metricas %d: %s", config_get_int_value(config, "METRICAS_PUERTO"), strerror(errno));
+	// PERSISTENCIA_DIR: si esta, cada frame recibido se guarda en un log en disco con group commit (ver persistencia.h)
+	persistencia = NULL;
+	if(config_has_property(config, "PERSISTENCIA_DIR")) {
+		size_t segmento = config_has_property(config, "PERSISTENCIA_SEGMENTO_MB") ?
+			(size_t) config_get_int_value(config, "PERSISTENCIA_SEGMENTO_MB") * 1024 * 1024 : PERSISTENCIA_SEGMENTO_DEFECTO;
+		size_t buffer = config_has_property(config, "PERSISTENCIA_BUFFER_MB") ?
+			(size_t) config_get_int_value(config, "PERSISTENCIA_BUFFER_MB") * 1024 * 1024 : PERSISTENCIA_BUFFER_DEFECTO;
+		persistencia = persistencia_abrir(config_get_string_value(config, "PERSISTENCIA_DIR"), segmento, buffer);
+		if(persistencia == NULL) {
+			log_error(logger, "No se pudo abrir la persistencia en %s: %s", config_get_string_value(config, "PERSISTENCIA_DIR"), strerror(errno));
+			return EXIT_FAILURE;
+		}
+	}
+	// CAPTURA_ARCHIVO: si esta, cada frame recibido se graba para reproducirlo despues con el replay (ver grabador.h)
+	grabador = NULL;
+	if(config_has_property(config, "CAPTURA_ARCHIVO")) {
+		size_t buffer = config_has_property(config, "CAPTURA_BUFFER_MB") ?
+			(size_t) config_get_int_value(config, "CAPTURA_BUFFER_MB") * 1024 * 1024 : GRABADOR_BUFFER_DEFECTO;
+		grabador = grabador_crear(config_get_string_value(config, "CAPTURA_ARCHIVO"), buffer);
+		if(grabador == NULL) {
+			log_error(logger, "No se pudo crear la captura %s: %s", config_get_string_value(config, "CAPTURA_ARCHIVO"), strerror(errno));
 			return EXIT_FAILURE;
-		default:
-			log_warning(logger,"Operacion desconocida. No quieras meter la pata");
-			break;
 		}
 	}
-	return EXIT_SUCCESS;
+	// OPERACIONES_PLUGINS: si esta, cada .so de la lista agrega operaciones a la tabla (ver operaciones.h)
+	if(config_has_property(config, "OPERACIONES_PLUGINS")) {
+		char** plugins = config_get_array_value(config, "OPERACIONES_PLUGINS");
+		bool cargados = true;
+		for(int i = 0; cargados && plugins[i] != NULL; i++)
+			cargados = operaciones_cargar_plugin(plugins[i]);
+		string_array_destroy(plugins);
+		if(!cargados)
+			return EXIT_FAILURE;
+	}
+	// PROCESADORES: si esta, los frames se procesan en un pool aparte y los workers solo hacen I/O (0 = uno por core, ver procesadores.h)
+	bool con_procesadores = config_has_property(config, "PROCESADORES");
+	int procesadores = con_procesadores ? config_get_int_value(config, "PROCESADORES") : 0;
+	config_destroy(config);
+
+	// Lo que llega (MENSAJE, PAQUETE, PUT) se guarda en memoria para responder GET y EXISTS (ver almacen.h)
+	almacen = almacen_crear();
+
+	// Antes que los workers: sus conexiones usan el pool solo si ya esta lanzado
+	if(con_procesadores && !procesadores_iniciar(procesadores, procesar_operacion))
+		log_warning(logger, "No se pudo lanzar el pool de procesadores: los workers procesan los frames");
+
+	log_info(logger, "Servidor listo para recibir a los clientes");
+
+	// Cada worker acepta clientes y llama a procesar_operacion() por cada frame.
+	// Solo retorna si no se pudo lanzar ningun worker.
+	int resultado = ejecutar_workers(workers, backend, procesar_operacion);
+	if(grabador != NULL)
+		grabador_destruir(grabador);
+	if(persistencia != NULL)
+		persistencia_cerrar(persistencia);
+	almacen_destruir(almacen);
+	return resultado;
 }
 
-void iterator(char* value) {
-	log_info(logger,"%s", value);
+t_config* iniciar_config(void)
+{
+	t_config* nuevo_config = config_create("servidor.config");
+	if(nuevo_config == NULL){
+		perror("Error al intentar cargar servidor.config");
+		exit(EXIT_FAILURE);
+	}
+	return nuevo_config;
+}
+
+void procesar_operacion(t_conexion* conexion, int cod_op, void* payload, int size)
+{
+	// La captura guarda todo lo que llega, aun los cod_op desconocidos: sirven para reproducir el trafico tal cual
+	if(grabador != NULL) {
+		TRAZA_INICIO(tramo);
+		grabador_agregar(grabador, cod_op, conexion->lector->version, payload, size);
+		TRAZA_FIN(tramo, "procesar_operacion:captura");
+	}
+	// Un acceso a la tabla y una llamada: agregar operaciones no toca este camino (ver operaciones.h)
+	if(!operaciones_despachar(conexion, cod_op, payload, size)) {
+		log_warning(logger,"Operacion desconocida (fd %d). No quieras meter la pata", conexion->fd);
+		conexion_confirmar(conexion, PROTOCOLO_ACK_ERROR);
+		return;
+	}
+	// Se encola recien si la operacion lo acepto (un PUT mal formado no llega al log): el escritor lo lleva a disco
+	// junto con los frames de las demas conexiones, y su ACK sale cuando ya es durable (ver conexion.h)
+	if(persistencia != NULL && operaciones_persistir(cod_op) && !conexion->rechazada) {
+		TRAZA_INICIO(tramo);
+		uint64_t registro = persistencia_agregar(persistencia, cod_op, conexion->lector->version, payload, size);
+		TRAZA_FIN(tramo, "procesar_operacion:persistencia");
+		if(conexion->solicitud_con_id)
+			conexion->persistido = registro; // los frames sin id no se confirman: no hace falta esperarlos
+	}
 }
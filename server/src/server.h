@@ -25,16 +25,44 @@
 
 // Librerías de la biblioteca Commons (de so-unix/utn)
 #include <commons/log.h> // Para crear logs fácilmente (t_log* logger, log_info, etc.).
+#include <commons/config.h> // Permite leer archivos .config, accediendo a claves y valores.
+#include <commons/string.h> // string_array_destroy para las listas del .config
 
 // Inclusión del archivo de utilidades
 #include "utils.h"
+#include "paquete_vista.h" // PAQUETE sin copiar cada elemento
+#include "event_loop.h" // atiende a todos los clientes concurrentemente
+#include "workers.h" // un event loop por core con SO_REUSEPORT
+#include "log_async.h" // log del camino caliente sin escribir a disco en el hilo del socket
+#include "persistencia.h" // log en disco de los frames recibidos, con group commit
+#include "grabador.h" // captura de trafico para el replay
+#include "almacen.h" // claves y valores recibidos, para responder GET y EXISTS
+#include "metricas.h" // contadores y latencias exportados en un puerto local
+#include "procesadores.h" // pool que procesa los frames fuera de los event loops
+#include "operaciones.h" // que hacer con cada cod_op, con operaciones agregadas por plugins
 
 /**
- * @brief Imprime cada valor recibido en el paquete
- * @param value valor que quiero imprimir en el logger global
- * @note Funcion auxiliar que usa list_iterate(lista, (void*) iterator);
+ * @brief Carga servidor.config (WORKERS=cantidad de hilos, 0 = un hilo por core; IO_BACKEND=epoll|io_uring;
+ * LOG_COLA=registros de la cola del log asincronico; LOG_POLITICA=descartar|bloquear;
+ * PERSISTENCIA_DIR=carpeta de los segmentos, sin esta clave no se persiste; PERSISTENCIA_SEGMENTO_MB; PERSISTENCIA_BUFFER_MB;
+ * CAPTURA_ARCHIVO=archivo de captura para el replay, sin esta clave no se graba; CAPTURA_BUFFER_MB;
+ * OPERACIONES_PLUGINS=[rutas de .so con operaciones propias]; PROCESADORES=hilos que procesan los frames aparte de los workers, 0 = uno por core, sin esta clave los procesan los workers;
+ * TRAZA_ARCHIVO=JSON de Chrome trace que se escribe con cada SIGUSR1, solo en debug)
+ * @return t_config* con la configuracion cargada
+ * @note Si no existe el archivo termina el programa, igual que en el cliente
  */
-void iterator(char* value);
+t_config* iniciar_config(void);
+
+/**
+ * @brief Procesa un frame completo recibido de cualquier cliente con la operacion registrada para su cod_op
+ * @param conexion conexion por la que llego
+ * @param cod_op codigo de operacion del frame
+ * @param payload contenido del frame (lo libera quien llama)
+ * @param size tamanio del payload
+ * @note Antes de despachar lo graba y, si la operacion lo acepto, lo persiste; un cod_op sin operacion se contesta con ACK_ERROR.
+ * GET y EXISTS dejan su RESPUESTA en el buffer de salida de la conexion (ver conexion_reservar_respuesta())
+ */
+void procesar_operacion(t_conexion* conexion, int cod_op, void* payload, int size);
 
 // Cierra las guards de inclusión
 #endif /* SERVER_H_ */
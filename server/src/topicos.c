@@ -0,0 +1,238 @@
+/**
+ * @file topicos.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de la publicacion/suscripcion del servidor
+ *
+ * Una conexion suscripta no tiene una referencia propia en sus topicos: conexion_destruir() la saca de todos
+ * (con el lock de escritura) antes de soltar la del event loop, asi quien publica con el lock de lectura solo
+ * ve conexiones vivas y les suma la referencia de la entrega antes de soltarlo.
+ */
+
+#include "topicos.h"
+
+/**
+ * @brief Un topico con al menos un suscriptor (el ultimo que se va lo libera)
+ */
+typedef struct t_topico
+{
+	struct t_topico* siguiente; /**< siguiente de la misma cubeta */
+	uint64_t hash; /**< hash del nombre */
+	int largo; /**< bytes del nombre */
+	t_conexion** suscriptores; /**< conexiones suscriptas, sin orden */
+	int cantidad; /**< suscriptores */
+	int capacidad; /**< lugares reservados en suscriptores */
+	uint8_t nombre[]; /**< nombre (sin '\0') */
+} t_topico;
+
+static t_topico* cubetas[TOPICOS_CUBETAS];
+static pthread_rwlock_t lock_topicos = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * @brief FNV-1a de 64 bits (los bits bajos eligen la cubeta)
+ */
+static uint64_t calcular_hash(const uint8_t* nombre, int largo)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(int i = 0; i < largo; i++) {
+		hash ^= nombre[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * @brief Busca un topico (con el lock tomado)
+ * @param anterior si no es NULL, donde queda el enlace que apunta al topico (para sacarlo de la cubeta)
+ * @return el topico, o NULL si nadie esta suscripto
+ */
+static t_topico* buscar_topico(const uint8_t* nombre, int largo, uint64_t hash, t_topico*** anterior)
+{
+	t_topico** enlace = &cubetas[hash & (TOPICOS_CUBETAS - 1)];
+	for(; *enlace != NULL; enlace = &(*enlace)->siguiente) {
+		t_topico* topico = *enlace;
+		if(topico->hash == hash && topico->largo == largo && memcmp(topico->nombre, nombre, largo) == 0) {
+			if(anterior != NULL)
+				*anterior = enlace;
+			return topico;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Saca al suscriptor @p i del topico y, si era el ultimo, saca al topico de su cubeta y lo libera
+ */
+static void quitar_suscriptor(t_topico** enlace, int i)
+{
+	t_topico* topico = *enlace;
+	topico->suscriptores[i] = topico->suscriptores[--topico->cantidad];
+	if(topico->cantidad > 0)
+		return;
+	*enlace = topico->siguiente;
+	free(topico->suscriptores);
+	free(topico);
+}
+
+/**
+ * @brief Verifica el nombre de un topico de SUSCRIBIR o DESUSCRIBIR
+ * @return true si se puede usar (en caso contrario ya se rechazo el frame)
+ */
+static bool validar_topico(t_conexion* conexion, int size, const char* operacion)
+{
+	if(size > 0 && size <= TOPICOS_LARGO_MAXIMO && conexion->lector->version >= PROTOCOLO_VERSION_2 && conexion->buzon != NULL)
+		return true;
+	log_warning(logger, "%s invalido (fd %d): topico de %d bytes o cliente sin soporte", operacion, conexion->fd, size);
+	conexion_confirmar(conexion, PROTOCOLO_ACK_ERROR);
+	return false;
+}
+
+void topicos_suscribir(t_conexion* conexion, void* payload, int size)
+{
+	if(!validar_topico(conexion, size, "SUSCRIBIR"))
+		return;
+	uint64_t hash = calcular_hash(payload, size);
+	pthread_rwlock_wrlock(&lock_topicos);
+	// Dekker con conexion_destruir(): o ella ve suscriptora y la saca despues, o aca se ve cerrada
+	__atomic_store_n(&conexion->suscriptora, true, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&conexion->cerrada, __ATOMIC_SEQ_CST)) {
+		pthread_rwlock_unlock(&lock_topicos);
+		return;
+	}
+	t_topico* topico = buscar_topico(payload, size, hash, NULL);
+	if(topico == NULL) {
+		topico = malloc(sizeof(t_topico) + size);
+		topico->hash = hash;
+		topico->largo = size;
+		memcpy(topico->nombre, payload, size);
+		topico->suscriptores = NULL;
+		topico->cantidad = topico->capacidad = 0;
+		t_topico** cubeta = &cubetas[hash & (TOPICOS_CUBETAS - 1)];
+		topico->siguiente = *cubeta;
+		*cubeta = topico;
+	}
+	for(int i = 0; i < topico->cantidad; i++)
+		if(topico->suscriptores[i] == conexion) {
+			pthread_rwlock_unlock(&lock_topicos);
+			return;
+		}
+	if(topico->cantidad == topico->capacidad) {
+		topico->capacidad = topico->capacidad > 0 ? topico->capacidad * 2 : 4;
+		topico->suscriptores = realloc(topico->suscriptores, topico->capacidad * sizeof(t_conexion*));
+	}
+	topico->suscriptores[topico->cantidad++] = conexion;
+	pthread_rwlock_unlock(&lock_topicos);
+}
+
+void topicos_desuscribir(t_conexion* conexion, void* payload, int size)
+{
+	if(!validar_topico(conexion, size, "DESUSCRIBIR"))
+		return;
+	uint64_t hash = calcular_hash(payload, size);
+	pthread_rwlock_wrlock(&lock_topicos);
+	t_topico** enlace;
+	t_topico* topico = buscar_topico(payload, size, hash, &enlace);
+	for(int i = 0; topico != NULL && i < topico->cantidad; i++)
+		if(topico->suscriptores[i] == conexion) {
+			quitar_suscriptor(enlace, i);
+			break;
+		}
+	pthread_rwlock_unlock(&lock_topicos);
+}
+
+/**
+ * @brief Verifica un PUBLICAR: | varint largo topico | topico | uint8 cod_op | payload de ese frame |
+ * @param nombre donde queda el topico
+ * @param largo donde queda el largo del topico
+ * @return true si esta bien formado
+ */
+static bool separar_publicacion(uint8_t* payload, int size, uint8_t** nombre, int* largo)
+{
+	uint32_t largo_topico;
+	int varint = varint_decodificar(payload, size, &largo_topico);
+	if(varint <= 0 || largo_topico == 0 || largo_topico > TOPICOS_LARGO_MAXIMO || varint + (int) largo_topico >= size)
+		return false;
+	*nombre = payload + varint;
+	*largo = largo_topico;
+	uint8_t* frame = *nombre + largo_topico;
+	int size_frame = size - varint - largo_topico - 1;
+	if(frame[0] == MENSAJE)
+		return true;
+	if(frame[0] != PAQUETE)
+		return false;
+	// Los suscriptores reciben el PAQUETE tal cual: se verifica una vez aca y no en cada uno
+	t_paquete_vista* vista = paquete_vista_crear(frame + 1, size_frame, PROTOCOLO_VERSION_2, false);
+	if(vista == NULL)
+		return false;
+	paquete_vista_destruir(vista);
+	return true;
+}
+
+/**
+ * @brief Deja una publicacion en el buzon del event loop de un suscriptor (con el lock de lectura tomado)
+ */
+static void entregar(t_conexion* suscriptor, t_publicacion* publicacion)
+{
+	t_devolucion* entrega = calloc(1, sizeof(t_devolucion));
+	entrega->conexion = suscriptor;
+	entrega->publicacion = publicacion;
+	__atomic_add_fetch(&publicacion->referencias, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&suscriptor->referencias, 1, __ATOMIC_RELAXED); // la suelta conexion_recoger()
+	buzon_entregar(suscriptor->buzon, entrega);
+}
+
+void topicos_publicar(t_conexion* conexion, void* payload, int size)
+{
+	uint8_t* nombre;
+	int largo;
+	if(conexion->lector->version < PROTOCOLO_VERSION_2 || !separar_publicacion(payload, size, &nombre, &largo)) {
+		log_warning(logger, "PUBLICAR mal formado (fd %d)", conexion->fd);
+		conexion_confirmar(conexion, PROTOCOLO_ACK_ERROR);
+		return;
+	}
+	uint64_t hash = calcular_hash(nombre, largo);
+	pthread_rwlock_rdlock(&lock_topicos);
+	t_topico* topico = buscar_topico(nombre, largo, hash, NULL);
+	if(topico == NULL) { // nadie suscripto: no se codifica nada
+		pthread_rwlock_unlock(&lock_topicos);
+		return;
+	}
+	// Se codifica una sola vez: cada suscriptor se lleva una referencia, no una copia
+	t_publicacion* publicacion = malloc(sizeof(t_publicacion) + PROTOCOLO_ENCABEZADO_MAXIMO + size);
+	int encabezado = protocolo_codificar_encabezado(PROTOCOLO_VERSION_2, publicacion->frame, PUBLICACION, 0, size);
+	memcpy(publicacion->frame + encabezado, payload, size);
+	publicacion->size = encabezado + size;
+	publicacion->referencias = 1;
+	metricas_reservas(1);
+	for(int i = 0; i < topico->cantidad; i++)
+		entregar(topico->suscriptores[i], publicacion);
+	pthread_rwlock_unlock(&lock_topicos);
+	publicacion_soltar(publicacion);
+}
+
+void topicos_cerrar_conexion(t_conexion* conexion)
+{
+	pthread_rwlock_wrlock(&lock_topicos);
+	for(int c = 0; c < TOPICOS_CUBETAS; c++) {
+		t_topico** enlace = &cubetas[c];
+		while(*enlace != NULL) {
+			t_topico* topico = *enlace;
+			bool liberado = false;
+			for(int i = 0; i < topico->cantidad; i++)
+				if(topico->suscriptores[i] == conexion) {
+					liberado = topico->cantidad == 1;
+					quitar_suscriptor(enlace, i);
+					break;
+				}
+			if(!liberado) // si se libero, *enlace ya es el siguiente
+				enlace = &topico->siguiente;
+		}
+	}
+	pthread_rwlock_unlock(&lock_topicos);
+}
+
+void publicacion_soltar(t_publicacion* publicacion)
+{
+	if(__atomic_sub_fetch(&publicacion->referencias, 1, __ATOMIC_ACQ_REL) == 0)
+		free(publicacion);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file topicos.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de la publicacion/suscripcion del servidor (el servidor como bus de mensajes)
+ *
+ * Un cliente v2 se suscribe a un topico con SUSCRIBIR y desde ahi recibe, como PUBLICACION, cada MENSAJE o PAQUETE
+ * que cualquier cliente mande con PUBLICAR a ese topico (ver protocolo.h).
+ * - el frame PUBLICACION se codifica una sola vez por publicacion (t_publicacion) y todos los suscriptores comparten
+ *   ese buffer contando referencias: publicar a N suscriptores no copia el contenido N veces;
+ * - a cada suscriptor le llega por el buzon de su event loop (ver procesadores.h), que es el unico que toca su socket;
+ *   el event loop la agrega a la cola acotada de la conexion (ver conexion.h) o la descarta si esta llena.
+ * Los topicos estan en una tabla hash con un rwlock: publicar solo toma el lock de lectura, suscribirse y
+ * desuscribirse (y cerrar una conexion suscripta) el de escritura.
+ */
+
+#ifndef TOPICOS_H_
+#define TOPICOS_H_
+
+// Librerias standard de C
+#include<stdint.h> // uint8_t, uint64_t
+#include<stdbool.h> // bool
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // rwlock de la tabla de topicos
+
+// Inclusión de la conexion (y de las utilidades)
+#include "conexion.h"
+#include "paquete_vista.h" // validar el PAQUETE que se publica
+#include "procesadores.h" // buzon del event loop de cada suscriptor
+
+/* Cubetas de la tabla de topicos (potencia de 2) */
+#define TOPICOS_CUBETAS 1024
+
+/* Largo maximo del nombre de un topico */
+#define TOPICOS_LARGO_MAXIMO 255
+
+/**
+ * @brief Un frame PUBLICACION ya codificado, compartido por las colas de todos los suscriptores
+ */
+typedef struct t_publicacion
+{
+	int referencias; /**< quien publica mientras reparte, cada entrega en camino y cada cola que la tiene */
+	int size; /**< bytes del frame */
+	uint8_t frame[]; /**< encabezado v2 + payload, listo para enviar */
+} t_publicacion;
+
+/**
+ * @brief SUSCRIBIR: la conexion pasa a recibir lo que se publique en el topico del payload
+ * @note Rechaza (ACK_ERROR) a los clientes v1 y a los event loops sin buzon. Suscribirse dos veces no cambia nada
+ */
+void topicos_suscribir(t_conexion* conexion, void* payload, int size);
+
+/**
+ * @brief DESUSCRIBIR: la conexion deja de recibir el topico del payload (si no estaba suscripta no hace nada)
+ */
+void topicos_desuscribir(t_conexion* conexion, void* payload, int size);
+
+/**
+ * @brief PUBLICAR: codifica la PUBLICACION una vez y la entrega a cada suscriptor del topico
+ * @note Rechaza (ACK_ERROR) un payload mal formado o que no lleve un MENSAJE o un PAQUETE v2 valido
+ */
+void topicos_publicar(t_conexion* conexion, void* payload, int size);
+
+/**
+ * @brief Saca a una conexion que se cierra de todos sus topicos
+ * @note Desde conexion_destruir(), despues de marcarla cerrada: una suscripcion que se procese despues se ignora
+ */
+void topicos_cerrar_conexion(t_conexion* conexion);
+
+/**
+ * @brief Suelta una referencia de una publicacion; con la ultima se libera
+ */
+void publicacion_soltar(t_publicacion* publicacion);
+
+#endif /* TOPICOS_H_ */
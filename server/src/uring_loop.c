@@ -0,0 +1,498 @@
+/**
+ * @file uring_loop.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente del backend io_uring del servidor
+ *
+ * Se usa el ABI de io_uring directamente (syscalls + mmap), sin liburing:
+ * - accept multishot: una sola SQE acepta a todos los clientes que vayan llegando
+ * - recv multishot + buffer ring: una sola SQE por conexion, el kernel elige el buffer libre
+ * - envio por lotes: todas las SQEs generadas al procesar completions se envian en un unico io_uring_enter()
+ * - respuestas: se envian con send() sin bloquear; si el socket esta lleno, un poll de POLLOUT avisa cuando sigue
+ * - pausa (salida arriba de CONEXION_SALIDA_ALTA): se cancela el recv multishot y se vuelve a armar al reanudar.
+ *   Lo que entregue antes de que complete la cancelacion queda en el lector y se procesa al reanudar
+ * - buzon: un read de su eventfd queda armado; cuando completa se recogen las devoluciones y las publicaciones
+ * - cierre del cliente (recv en 0): la conexion se libera recien cuando tiene todo contestado (ver conexion_terminada())
+ * @see https://man7.org/linux/man-pages/man7/io_uring.7.html
+ */
+
+#include "uring_loop.h"
+
+/* user_data del accept multishot (los punteros a t_conexion nunca valen 1) */
+#define URING_DATO_ACCEPT 1ULL
+
+/* user_data de las cancelaciones de recv (su completion no hace falta procesarla) */
+#define URING_DATO_CANCELACION 2ULL
+
+/* user_data del read del eventfd del buzon */
+#define URING_DATO_AVISO 3ULL
+
+/* Bit bajo del user_data de los poll de salida: el resto es el puntero a la conexion (alineado, su bit bajo es 0) */
+#define URING_MARCA_SALIDA 1ULL
+
+/**
+ * @brief Colas compartidas con el kernel
+ */
+typedef struct
+{
+	int fd; /**< fd del io_uring */
+	// Cola de envios (SQ)
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned* sq_mask;
+	unsigned* sq_array;
+	struct io_uring_sqe* sqes;
+	unsigned sq_local_tail; /**< tail con las SQEs preparadas pero todavia no publicadas */
+	unsigned pendientes; /**< SQEs preparadas desde el ultimo io_uring_enter() */
+	// Cola de completions (CQ)
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned* cq_mask;
+	struct io_uring_cqe* cqes;
+	// Buffer ring (buffers provistos para los recv)
+	struct io_uring_buf_ring* buf_ring;
+	char* buffers;
+	unsigned short buf_tail;
+	// Para liberar todo al final
+	void* sq_mapa;
+	size_t sq_mapa_tamanio;
+	void* cq_mapa;
+	size_t cq_mapa_tamanio;
+	size_t sqes_tamanio;
+} t_uring;
+
+/**
+ * @brief Conexion atendida por io_uring (su puntero es el user_data de su recv multishot)
+ */
+typedef struct
+{
+	t_conexion* conexion;
+	bool cerrando; /**< se pidio shutdown(): se ignoran los datos hasta la completion final */
+	bool esperando_salida; /**< hay un poll de POLLOUT armado (la conexion no se puede liberar hasta que complete) */
+	bool liberar; /**< el recv ya termino: se libera cuando complete el poll de salida */
+	bool recv_armado; /**< el recv multishot sigue activo (todavia no llego su completion final) */
+	bool cancelando; /**< se pidio cancelar el recv por la pausa */
+} t_conexion_uring;
+
+static int uring_setup(unsigned entradas, struct io_uring_params* params)
+{
+	return syscall(__NR_io_uring_setup, entradas, params);
+}
+
+static int uring_enter(int fd, unsigned a_enviar, unsigned minimo, unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, fd, a_enviar, minimo, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, void* arg, unsigned cantidad)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, cantidad);
+}
+
+/**
+ * @brief Desmapea lo que se haya llegado a mapear de las colas y del buffer ring, y cierra el io_uring
+ * @note Conserva errno: quien llama informa el motivo del fallo
+ */
+static void uring_liberar(t_uring* ring)
+{
+	int error = errno;
+	if(ring->buf_ring != NULL && ring->buf_ring != MAP_FAILED)
+		munmap(ring->buf_ring, URING_CANTIDAD_BUFFERS * sizeof(struct io_uring_buf));
+	free(ring->buffers);
+	if(ring->sqes != NULL && ring->sqes != MAP_FAILED)
+		munmap(ring->sqes, ring->sqes_tamanio);
+	if(ring->cq_mapa != NULL && ring->cq_mapa != MAP_FAILED && ring->cq_mapa != ring->sq_mapa) // con un solo mapeo se desmapea una vez
+		munmap(ring->cq_mapa, ring->cq_mapa_tamanio);
+	if(ring->sq_mapa != NULL && ring->sq_mapa != MAP_FAILED)
+		munmap(ring->sq_mapa, ring->sq_mapa_tamanio);
+	close(ring->fd);
+	errno = error;
+}
+
+/**
+ * @brief Crea el io_uring y mapea sus colas
+ * @return 0 si se pudo, -1 si io_uring no esta disponible
+ */
+static int uring_iniciar(t_uring* ring)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+	params.cq_entries = URING_ENTRADAS_CQ;
+
+	memset(ring, 0, sizeof(t_uring));
+	ring->fd = uring_setup(URING_ENTRADAS_SQ, &params);
+	if(ring->fd == -1)
+		return -1;
+
+	ring->sq_mapa_tamanio = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cq_mapa_tamanio = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP) { // SQ y CQ comparten el mismo mapeo
+		if(ring->cq_mapa_tamanio > ring->sq_mapa_tamanio)
+			ring->sq_mapa_tamanio = ring->cq_mapa_tamanio;
+		ring->cq_mapa_tamanio = 0;
+	}
+
+	ring->sq_mapa = mmap(NULL, ring->sq_mapa_tamanio, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	ring->cq_mapa = ring->sq_mapa;
+	if(ring->cq_mapa_tamanio > 0)
+		ring->cq_mapa = mmap(NULL, ring->cq_mapa_tamanio, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+	ring->sqes_tamanio = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_tamanio, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if(ring->sq_mapa == MAP_FAILED || ring->cq_mapa == MAP_FAILED || ring->sqes == MAP_FAILED) {
+		uring_liberar(ring);
+		return -1;
+	}
+
+	char* sq = ring->sq_mapa;
+	ring->sq_head = (unsigned*) (sq + params.sq_off.head);
+	ring->sq_tail = (unsigned*) (sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned*) (sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned*) (sq + params.sq_off.array);
+	ring->sq_local_tail = *ring->sq_tail;
+
+	char* cq = ring->cq_mapa;
+	ring->cq_head = (unsigned*) (cq + params.cq_off.head);
+	ring->cq_tail = (unsigned*) (cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned*) (cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+
+	// Buffer ring: el kernel toma de aca un buffer libre por cada recv completado
+	size_t tamanio_ring = URING_CANTIDAD_BUFFERS * sizeof(struct io_uring_buf);
+	ring->buf_ring = mmap(NULL, tamanio_ring, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	ring->buffers = malloc(URING_CANTIDAD_BUFFERS * URING_TAMANIO_BUFFER);
+
+	struct io_uring_buf_reg registro;
+	memset(&registro, 0, sizeof(registro));
+	registro.ring_addr = (unsigned long) ring->buf_ring;
+	registro.ring_entries = URING_CANTIDAD_BUFFERS;
+	registro.bgid = 0;
+	if(ring->buf_ring == MAP_FAILED || uring_register(ring->fd, IORING_REGISTER_PBUF_RING, &registro, 1) == -1) {
+		uring_liberar(ring); // kernel < 5.19: sin buffer rings no tiene sentido este backend
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Devuelve un buffer al buffer ring para que el kernel lo vuelva a usar
+ * @note Se publica recien con uring_publicar_buffers(), asi se devuelven varios de una vez
+ */
+static void uring_devolver_buffer(t_uring* ring, unsigned short id)
+{
+	struct io_uring_buf* buf = &ring->buf_ring->bufs[ring->buf_tail & (URING_CANTIDAD_BUFFERS - 1)];
+	buf->addr = (unsigned long) (ring->buffers + (size_t) id * URING_TAMANIO_BUFFER);
+	buf->len = URING_TAMANIO_BUFFER;
+	buf->bid = id;
+	ring->buf_tail++;
+}
+
+static void uring_publicar_buffers(t_uring* ring)
+{
+	__atomic_store_n(&ring->buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Toma una SQE libre (todavia no la ve el kernel)
+ * @return la SQE en cero, o NULL si la cola esta llena
+ */
+static struct io_uring_sqe* uring_obtener_sqe(t_uring* ring)
+{
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	if(ring->sq_local_tail - head >= URING_ENTRADAS_SQ)
+		return NULL;
+
+	unsigned indice = ring->sq_local_tail & *ring->sq_mask;
+	ring->sq_array[indice] = indice;
+	ring->sq_local_tail++;
+	ring->pendientes++;
+
+	struct io_uring_sqe* sqe = &ring->sqes[indice];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	return sqe;
+}
+
+/**
+ * @brief Publica las SQEs preparadas y espera al menos @p minimo completions, todo en una syscall
+ */
+static int uring_enviar_y_esperar(t_uring* ring, unsigned minimo)
+{
+	__atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+	unsigned a_enviar = ring->pendientes;
+	int resultado;
+	do {
+		resultado = uring_enter(ring->fd, a_enviar, minimo, IORING_ENTER_GETEVENTS);
+	} while(resultado == -1 && errno == EINTR);
+	if(resultado >= 0)
+		ring->pendientes = 0;
+	return resultado;
+}
+
+/**
+ * @brief Consigue una SQE, y si la cola esta llena envia las pendientes para hacer lugar
+ */
+static struct io_uring_sqe* uring_sqe(t_uring* ring)
+{
+	struct io_uring_sqe* sqe = uring_obtener_sqe(ring);
+	if(sqe == NULL) {
+		uring_enviar_y_esperar(ring, 0);
+		sqe = uring_obtener_sqe(ring);
+	}
+	return sqe;
+}
+
+static void armar_accept(t_uring* ring, int socket_servidor)
+{
+	struct io_uring_sqe* sqe = uring_sqe(ring);
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = socket_servidor;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->user_data = URING_DATO_ACCEPT;
+}
+
+static void armar_recv(t_uring* ring, t_conexion_uring* conexion)
+{
+	struct io_uring_sqe* sqe = uring_sqe(ring);
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = conexion->conexion->fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT; // el kernel elige el buffer del grupo buf_group
+	sqe->buf_group = 0;
+	sqe->user_data = (unsigned long) conexion;
+	conexion->recv_armado = true;
+	conexion->cancelando = false;
+}
+
+/**
+ * @brief Cancela el recv multishot de una conexion pausada (los datos quedan en el socket hasta que se reanude)
+ */
+static void cancelar_recv(t_uring* ring, t_conexion_uring* conexion)
+{
+	struct io_uring_sqe* sqe = uring_sqe(ring);
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->addr = (unsigned long) conexion; // user_data del recv a cancelar
+	sqe->user_data = URING_DATO_CANCELACION;
+	conexion->cancelando = true;
+}
+
+/**
+ * @brief Pide aviso cuando el socket vuelva a tener lugar para las respuestas pendientes
+ */
+static void armar_salida(t_uring* ring, t_conexion_uring* conexion)
+{
+	struct io_uring_sqe* sqe = uring_sqe(ring);
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = conexion->conexion->fd;
+	sqe->poll32_events = POLLOUT;
+	sqe->user_data = (unsigned long) conexion | URING_MARCA_SALIDA;
+	conexion->esperando_salida = true;
+}
+
+/**
+ * @brief Espera el proximo aviso de los procesadores (el read completa cuando escriben el eventfd)
+ */
+static void armar_aviso(t_uring* ring, t_buzon* buzon)
+{
+	struct io_uring_sqe* sqe = uring_sqe(ring);
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = buzon->aviso;
+	sqe->addr = (unsigned long) &buzon->contador;
+	sqe->len = sizeof(buzon->contador);
+	sqe->user_data = URING_DATO_AVISO;
+}
+
+static void liberar_conexion(t_conexion_uring* conexion)
+{
+	log_info(logger, "El cliente (fd %d) se desconecto", conexion->conexion->fd);
+	conexion_destruir(conexion->conexion);
+	free(conexion);
+}
+
+/**
+ * @brief Envia lo que se pueda de la salida, reanuda la lectura si corresponde y, si el socket sigue lleno, arma el poll
+ * @note La conexion no tiene que estar cerrandose ni con un poll de salida armado
+ */
+static void despachar_salida(t_uring* ring, t_conexion_uring* conexion, t_procesar_frame procesar)
+{
+	int estado = conexion_vaciar(conexion->conexion);
+	// Al reanudar primero va lo que quedo en el lector: el recv cancelado ya lo habia entregado y puede volver a pausarla
+	if(estado != -1 && conexion_reanudar(conexion->conexion) && (estado = conexion_retomar(conexion->conexion, procesar)) != -1) {
+		if(!conexion_pausada(conexion->conexion)) {
+			if(!conexion->recv_armado)
+				armar_recv(ring, conexion); // si la cancelacion todavia no completo, se vuelve a armar cuando complete
+		}
+		else if(conexion->recv_armado && !conexion->cancelando)
+			cancelar_recv(ring, conexion);
+		estado = conexion_salida_pendiente(conexion->conexion); // puede haber quedado un CREDITO
+	}
+	if(estado == -1) {
+		if(!conexion->recv_armado) { // pausada: no queda ningun recv que vaya a terminar
+			liberar_conexion(conexion);
+			return;
+		}
+		conexion->cerrando = true;
+		shutdown(conexion->conexion->fd, SHUT_RDWR);
+		return;
+	}
+	if(estado == 1)
+		armar_salida(ring, conexion);
+	else if(!conexion->recv_armado && conexion_terminada(conexion->conexion))
+		liberar_conexion(conexion); // el cliente habia cerrado su lado y ya tiene todo contestado
+}
+
+/**
+ * @brief Procesa la completion de un poll de salida: envia lo que se pueda y, si sigue lleno, lo vuelve a armar
+ */
+static void completar_salida(t_uring* ring, struct io_uring_cqe* cqe, t_procesar_frame procesar)
+{
+	t_conexion_uring* conexion = (t_conexion_uring*) (unsigned long) (cqe->user_data & ~URING_MARCA_SALIDA);
+	conexion->esperando_salida = false;
+	if(conexion->liberar) {
+		liberar_conexion(conexion);
+		return;
+	}
+	if(!conexion->cerrando)
+		despachar_salida(ring, conexion, procesar);
+}
+
+/**
+ * @brief Recoge lo que devolvieron los procesadores y las publicaciones, y envia la salida de cada conexion
+ */
+static void completar_aviso(t_uring* ring, t_buzon* buzon, t_procesar_frame procesar)
+{
+	armar_aviso(ring, buzon);
+	t_devolucion* devolucion = buzon_recoger(buzon);
+	while(devolucion != NULL) {
+		t_devolucion* siguiente = (t_devolucion*) devolucion->nodo.siguiente;
+		t_conexion_uring* conexion = devolucion->conexion->dueno; // se lee antes: recoger puede liberar la conexion
+		// Con un poll de salida armado, lo recogido se envia cuando complete
+		if(conexion_recoger(devolucion) && !conexion->cerrando && !conexion->esperando_salida)
+			despachar_salida(ring, conexion, procesar);
+		devolucion = siguiente;
+	}
+}
+
+/**
+ * @brief Procesa la completion de un recv multishot
+ */
+static void completar_recv(t_uring* ring, struct io_uring_cqe* cqe, t_procesar_frame procesar)
+{
+	t_conexion_uring* conexion = (t_conexion_uring*) (unsigned long) cqe->user_data;
+	bool sigue_armado = cqe->flags & IORING_CQE_F_MORE;
+
+	if(cqe->res > 0) {
+		unsigned short id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+		if(!conexion->cerrando
+			&& conexion_consumir(conexion->conexion, ring->buffers + (size_t) id * URING_TAMANIO_BUFFER, cqe->res, procesar) == -1) {
+			// Frame invalido: shutdown() hace que el recv termine con 0 y ahi se libera la conexion
+			conexion->cerrando = true;
+			shutdown(conexion->conexion->fd, SHUT_RDWR);
+		}
+		else if(!conexion->cerrando && !conexion->esperando_salida && conexion_salida_pendiente(conexion->conexion))
+			armar_salida(ring, conexion); // el socket no acepto todas las respuestas
+		bool pausada = !conexion->cerrando && conexion_pausada(conexion->conexion);
+		uring_devolver_buffer(ring, id);
+		if(!sigue_armado) {
+			conexion->recv_armado = false;
+			if(!pausada)
+				armar_recv(ring, conexion); // el kernel corto el multishot (ej. CQ llena): se vuelve a armar
+		}
+		else if(pausada && !conexion->cancelando)
+			cancelar_recv(ring, conexion); // la salida paso la marca alta: no se lee hasta que baje
+		return;
+	}
+
+	if(sigue_armado)
+		return;
+
+	conexion->recv_armado = false;
+	if((cqe->res == -ENOBUFS || cqe->res == -ECANCELED) && !conexion->cerrando) {
+		// Sin buffers libres se reintenta cuando se devuelvan; cancelado por la pausa, se arma al reanudar
+		if(!conexion_pausada(conexion->conexion))
+			armar_recv(ring, conexion);
+		return;
+	}
+
+	// 0 = el cliente cerro su lado: puede estar esperando respuestas (de los procesadores o que no entraron en el socket)
+	if(cqe->res == 0 && !conexion->cerrando) {
+		conexion->conexion->cerro_cliente = true;
+		if(!conexion_terminada(conexion->conexion))
+			return; // se libera en despachar_salida(), con todo contestado
+	}
+
+	// < 0 = error, o ya no queda nada que contestar. En ambos casos termina solo esta conexion
+	if(conexion->esperando_salida) {
+		// Con shutdown() el poll completa enseguida (POLLHUP) y ahi se libera
+		conexion->liberar = true;
+		shutdown(conexion->conexion->fd, SHUT_RDWR);
+		return;
+	}
+	liberar_conexion(conexion);
+}
+
+static void completar_accept(t_uring* ring, struct io_uring_cqe* cqe, int socket_servidor, t_buzon* buzon)
+{
+	if(cqe->res >= 0) {
+		log_info(logger, "Se conecto un cliente! (fd %d)", cqe->res);
+		t_conexion_uring* conexion = malloc(sizeof(t_conexion_uring));
+		conexion->conexion = conexion_crear(cqe->res, buzon);
+		conexion->conexion->dueno = conexion;
+		conexion->cerrando = false;
+		conexion->esperando_salida = false;
+		conexion->liberar = false;
+		armar_recv(ring, conexion);
+	}
+	else
+		log_warning(logger, "accept fallo: %s", strerror(-cqe->res));
+
+	if(!(cqe->flags & IORING_CQE_F_MORE))
+		armar_accept(ring, socket_servidor); // el multishot termino: se vuelve a armar
+}
+
+int ejecutar_uring_loop(int socket_servidor, t_procesar_frame procesar)
+{
+	t_uring ring;
+	if(uring_iniciar(&ring) == -1) {
+		log_warning(logger, "io_uring no disponible (%s), se usa epoll", strerror(errno));
+		return -1;
+	}
+
+	for(unsigned short id = 0; id < URING_CANTIDAD_BUFFERS; id++)
+		uring_devolver_buffer(&ring, id);
+	uring_publicar_buffers(&ring);
+
+	armar_accept(&ring, socket_servidor);
+
+	// Sin buzon los frames se procesan en este hilo y sus clientes no se pueden suscribir
+	t_buzon* buzon = buzon_crear();
+	if(buzon != NULL)
+		armar_aviso(&ring, buzon);
+	else
+		log_warning(logger, "No se pudo crear el buzon del event loop: procesa sus frames en su hilo y sin suscripciones");
+
+	while(1) {
+		// Una sola syscall: envia todas las SQEs del lote anterior y espera nuevas completions
+		if(uring_enviar_y_esperar(&ring, 1) == -1) {
+			log_error(logger, "io_uring_enter fallo: %s", strerror(errno));
+			return EXIT_FAILURE;
+		}
+
+		unsigned head = *ring.cq_head;
+		unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+		for(; head != tail; head++) {
+			struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+			if(cqe->user_data == URING_DATO_ACCEPT)
+				completar_accept(&ring, cqe, socket_servidor, buzon);
+			else if(cqe->user_data == URING_DATO_CANCELACION)
+				continue; // el recv cancelado avisa por su propia completion
+			else if(cqe->user_data == URING_DATO_AVISO)
+				completar_aviso(&ring, buzon, procesar);
+			else if(cqe->user_data & URING_MARCA_SALIDA)
+				completar_salida(&ring, cqe, procesar);
+			else
+				completar_recv(&ring, cqe, procesar);
+		}
+		__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+		uring_publicar_buffers(&ring); // todos los buffers consumidos en el lote vuelven juntos
+	}
+}
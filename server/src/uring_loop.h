@@ -0,0 +1,44 @@
+/**
+ * @file uring_loop.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) del backend io_uring del servidor
+ *
+ * Alternativa a event_loop.h: en lugar de que epoll avise y despues se haga un recv() por campo,
+ * el kernel deja los bytes recibidos directamente en buffers provistos (buffer ring) y avisa por la cola de completions.
+ * Un recv multishot por conexion queda armado y produce una completion por cada lectura.
+ * @see https://man7.org/linux/man-pages/man7/io_uring.7.html
+ */
+
+#ifndef URING_LOOP_H_
+#define URING_LOOP_H_
+
+// Librerias standard de POSIX/Linux
+#include<linux/io_uring.h> // estructuras y constantes del ABI de io_uring
+#include<sys/syscall.h> // __NR_io_uring_setup, __NR_io_uring_enter, __NR_io_uring_register
+#include<sys/mman.h> // mmap de las colas compartidas con el kernel
+#include<poll.h> // POLLOUT para esperar lugar en el socket
+
+// Inclusión de la conexion (y de las utilidades)
+#include "conexion.h"
+// Inclusión del pool de procesadores (buzon del event loop)
+#include "procesadores.h"
+
+/* Tamanio de la cola de envios (SQ). La de completions (CQ) es mas grande porque los multishot generan muchas */
+#define URING_ENTRADAS_SQ 256
+#define URING_ENTRADAS_CQ 4096
+
+/* Buffers provistos al kernel para los recv multishot (la cantidad tiene que ser potencia de 2) */
+#define URING_CANTIDAD_BUFFERS 512
+#define URING_TAMANIO_BUFFER 4096
+
+/**
+ * @brief Atiende a todos los clientes del socket de escucha usando io_uring
+ * @param socket_servidor fd del socket ya bindeado y en escucha (ver iniciar_servidor())
+ * @param procesar funcion que se llama por cada frame completo de cualquier cliente
+ * @return -1 si io_uring no esta disponible (kernel viejo o deshabilitado) y hay que usar epoll,
+ * EXIT_FAILURE si fallo en funcionamiento (en funcionamiento normal no retorna)
+ */
+int ejecutar_uring_loop(int socket_servidor, t_procesar_frame procesar);
+
+#endif /* URING_LOOP_H_ */
@@ -17,9 +17,12 @@
  */
 
 #include"utils.h"
+#include"paquete_vista.h"
 
 t_log* logger;
 
+t_limites_protocolo limites = { .frame_maximo = PROTOCOLO_FRAME_MAXIMO, .elementos_maximo = PROTOCOLO_ELEMENTOS_MAXIMO };
+
 int iniciar_servidor(void)
 {
 	// Quitar esta línea cuando hayamos terminado de implementar la funcion
@@ -73,7 +76,13 @@ int iniciar_servidor(void)
 	// bind: Asocia el socket a una dirección IP y a un número de puerto
 	// ai_addr: direccion del puerto
 	// ai_adrlen: tamaño de la estructura de dirección
-	bind(socket_servidor, server_info->ai_addr, server_info->ai_addrlen);
+	if(bind(socket_servidor, server_info->ai_addr, server_info->ai_addrlen) == -1) {
+		// Ej.: el puerto lo tiene otro proceso sin SO_REUSEPORT
+		log_error(logger, "No se pudo bindear el puerto %s: %s", PUERTO, strerror(errno));
+		freeaddrinfo(server_info);
+		close(socket_servidor);
+		return -1;
+	}
 	// bind dice: "Este socket va a escuchar en esta IP y este puerto."
 
 	// Escuchamos las conexiones entrantes
@@ -112,35 +121,72 @@ int esperar_cliente(int socket_servidor)
 	return socket_cliente;
 }
 
-/*
-int handshake_servidor(int socket_cliente)
+int aceptar_cliente(int socket_servidor)
 {
-	size_t bytes;
+	// accept4 acepta y, en la misma syscall, deja el socket nuevo en modo no bloqueante (SOCK_NONBLOCK)
+	TRAZA_INICIO(tramo);
+	int socket_cliente = accept4(socket_servidor, NULL, NULL, SOCK_NONBLOCK);
+	TRAZA_FIN(tramo, "aceptar_cliente:accept4");
+	if(socket_cliente == -1)
+		return -1; // EAGAIN: no hay mas clientes en la cola de listen() (o error real, lo decide quien llama con errno)
 
-	int32_t handshake;
-	int32_t resultOk = 0;
-	int32_t resultError = -1;
-	
-	// recibe el handshake del cliente
-	 el servidor espera recibir 4 bytes desde el cliente
-	socket_cliente: el socket que representa al cliente (resultado de accept()).
-	MSG_WAITALL: asegura que se reciban todos los bytes esperados (4 bytes en este caso) antes de continuar.
-	El dato recibido se guarda en la variable handshake.
-	
-	bytes = recv(socket_cliente, &handshake, sizeof(int32_t), MSG_WAITALL);
-	// lee el mensaje del cliente que, según el protocolo, debería ser 1.
-	
-	if (handshake == 1) { //Verifica si el handshake es válido
-		//es correcto, se asume que el cliente está usando el protocolo esperado.
-		// responde al cliente
-		// Se envía el valor 0 al cliente como señal de "Handshake OK".
-		bytes = send(socket_cliente, &resultOk, sizeof(int32_t), 0);
-	} else { //Si fue incorrecto
-		bytes = send(socket_cliente, &resultError, sizeof(int32_t), 0);
-		//Se envía -1 como señal de "Handshake ERROR".
+	log_info(logger, "Se conecto un cliente! (fd %d)", socket_cliente);
+	return socket_cliente;
+}
+
+int configurar_no_bloqueante(int fd)
+{
+	int flags = fcntl(fd, F_GETFL, 0); // leo los flags actuales para no pisarlos
+	if(flags == -1)
+		return -1;
+	return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+int escribir_todo(int fd, const void* datos, size_t cantidad, off_t posicion)
+{
+	const uint8_t* resto = datos;
+	while(cantidad > 0) {
+		ssize_t escritos = posicion == -1 ? write(fd, resto, cantidad) : pwrite(fd, resto, cantidad, posicion);
+		if(escritos == -1) {
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		resto += escritos;
+		cantidad -= escritos;
+		if(posicion != -1)
+			posicion += escritos;
 	}
+	return 0;
+}
+
+int handshake_servidor(int socket_cliente, const void* saludo, uint8_t* capacidades)
+{
+	// El saludo es | magia | 'T' | 'P' | capacidades pedidas | version maxima del cliente |
+	int version = protocolo_decodificar_handshake(saludo, capacidades);
+	if(version == -1)
+		return -1;
+	*capacidades &= PROTOCOLO_CAPACIDADES_SOPORTADAS; // solo se acepta lo que este servidor sabe hacer
+
+	// Se usa la mas nueva que entiendan los dos; 0 en la respuesta significa "rechazado"
+	if(version > PROTOCOLO_VERSION_MAXIMA)
+		version = PROTOCOLO_VERSION_MAXIMA;
+	if(version < PROTOCOLO_VERSION_1)
+		version = 0;
+
+	uint8_t respuesta[PROTOCOLO_TAMANIO_HANDSHAKE];
+	protocolo_codificar_handshake(respuesta, version, *capacidades);
+	// MSG_NOSIGNAL: si el cliente ya se fue, send() devuelve -1 en lugar de matar al servidor con SIGPIPE
+	TRAZA_INICIO(tramo);
+	ssize_t enviados = send(socket_cliente, respuesta, sizeof(respuesta), MSG_NOSIGNAL);
+	TRAZA_FIN(tramo, "handshake_servidor:send");
+	if(enviados != sizeof(respuesta) || version == 0)
+		return -1;
+
+	log_info(logger, "Handshake OK con el cliente (fd %d): protocolo v%d%s", socket_cliente, version,
+		(*capacidades & PROTOCOLO_CAPACIDAD_COMPRESION) ? " con compresion" : "");
+	return version;
 }
-*/
 
 int recibir_operacion(int socket_cliente)
 {
@@ -152,7 +198,10 @@ int recibir_operacion(int socket_cliente)
 	 * sizeof(int): se espera 1 int
 	 * MSG_WAITALL: le dice a recv() que espere hasta recibir todos los bytes solicitados, no solo una parte.
 	 */
-	if(recv(socket_cliente, &cod_op, sizeof(int), MSG_WAITALL) > 0) // Verifica que se haya recibido al menos un byte
+	TRAZA_INICIO(tramo);
+	ssize_t recibidos = recv(socket_cliente, &cod_op, sizeof(int), MSG_WAITALL);
+	TRAZA_FIN(tramo, "recibir_operacion:recv");
+	if(recibidos > 0) // Verifica que se haya recibido al menos un byte
 		return cod_op; // Si la recepción fue exitosa, se retorna el código recibido (cod_op)
 	else // Si no se reciben datos
 	{
@@ -168,11 +217,28 @@ void* recibir_buffer(int* size, int socket_cliente)
 	void * buffer; // variable puntero genérica
 
 	// Recive el tamanio del buffer y alamcena en size
-	recv(socket_cliente, size, sizeof(int), MSG_WAITALL);
-	// Reserva memoria para los datos del buffer
-	buffer = malloc(*size);
+	TRAZA_INICIO(tramo_size);
+	ssize_t recibidos = recv(socket_cliente, size, sizeof(int), MSG_WAITALL);
+	TRAZA_FIN(tramo_size, "recibir_buffer:recv size");
+	if(recibidos != sizeof(int))
+		return NULL; // el cliente se fue antes de mandar el tamanio
+	// El tamanio lo manda el cliente: se valida antes de reservar (uno corrupto podria pedir gigas)
+	if(*size < 0 || (uint32_t) *size > limites.frame_maximo) {
+		log_warning(logger, "Frame de %d bytes rechazado (maximo %u, fd %d)", *size, limites.frame_maximo, socket_cliente);
+		return NULL;
+	}
+	// Reserva memoria para los datos del buffer (al menos 1 byte: malloc(0) puede devolver NULL)
+	TRAZA_INICIO(tramo_malloc);
+	buffer = malloc(*size > 0 ? *size : 1);
+	TRAZA_FIN(tramo_malloc, "recibir_buffer:malloc");
 	// Recibe el rsto de los datos enviados y los almacena en buffer
-	recv(socket_cliente, buffer, *size, MSG_WAITALL);
+	TRAZA_INICIO(tramo_payload);
+	recibidos = recv(socket_cliente, buffer, *size, MSG_WAITALL);
+	TRAZA_FIN(tramo_payload, "recibir_buffer:recv payload");
+	if(recibidos != *size) {
+		free(buffer); // payload cortado: no se devuelve a medias
+		return NULL;
+	}
 
 	return buffer; // Devuelve el puntero al bloque de memoria con los datos recibidos.
 }
@@ -182,32 +248,50 @@ void recibir_mensaje(int socket_cliente)
 	int size;
 	// Recibe el MENSAJE a traves del buffer en na cadena de texto
 	char* buffer = recibir_buffer(&size, socket_cliente);
-	log_info(logger, "Me llego el mensaje: %s", buffer); // Loggea el MSJ
+	if(buffer == NULL)
+		return;
+	TRAZA_INICIO(tramo);
+	log_info(logger, "Me llego el mensaje: %.*s", size, buffer); // Loggea el MSJ (sin confiar en que traiga '\0')
+	TRAZA_FIN(tramo, "recibir_mensaje:log_info");
 	free(buffer); // Libera la memoria reservada para el buffer
 }
 
 t_list* recibir_paquete(int socket_cliente)
 {
 	int size; // tamaño total del buffer recibido
-	int desplazamiento = 0; // cursor para recorrer el buffer
 	void * buffer; // donde se almacena el bloque recibido
-	t_list* valores = list_create(); // lista de elementos (ej. strings)
-	int tamanio; // tamaño de cada elemento individual
 
 	// Recibir el buffer del socket
 	buffer = recibir_buffer(&size, socket_cliente);
-	while(desplazamiento < size) // Loop para desempaquetar datos (todo el buffer)
-	{
-		// Leer el tamaño del siguiente elemento
-		memcpy(&tamanio, buffer + desplazamiento, sizeof(int));
-		desplazamiento+=sizeof(int); // anvanza el cursor
+	if(buffer == NULL)
+		return list_create();
+	t_list* valores = deserializar_paquete(buffer, size); // desempaqueto los elementos
+	free(buffer); // Liberar el buffer original
+	return valores; // Devolver la lista con los datos
+}
+
+t_list* deserializar_paquete(void* buffer, int size)
+{
+	t_list* valores = list_create(); // lista de elementos (ej. strings)
 
-		// Leer el dato en sí
+	// Se ubican los elementos sin copiar (ver paquete_vista.h) y despues se copia cada uno a la lista
+	t_paquete_vista* vista = paquete_vista_crear(buffer, size, PROTOCOLO_VERSION_1, false);
+	if(vista == NULL) {
+		log_warning(logger, "Paquete mal formado: un elemento se sale del buffer o son demasiados");
+		return valores;
+	}
+
+	for(int i = 0; i < vista->cantidad; i++) {
+		int tamanio;
+		void* elemento = paquete_vista_elemento(vista, i, &tamanio);
+		TRAZA_INICIO(tramo_copia);
 		char* valor = malloc(tamanio); // reserva memoria para el dato valor
-		memcpy(valor, buffer+desplazamiento, tamanio); // Copia los bytes correspondientes desde el buffer
-		desplazamiento+=tamanio; // avanza el cursor
+		memcpy(valor, elemento, tamanio); // Copia los bytes correspondientes desde el buffer
+		TRAZA_FIN(tramo_copia, "deserializar_paquete:malloc");
+		TRAZA_INICIO(tramo_lista);
 		list_add(valores, valor); // Agregar el valor a la lista
+		TRAZA_FIN(tramo_lista, "deserializar_paquete:list_add");
 	}
-	free(buffer); // Liberar el buffer original
+	paquete_vista_destruir(vista); // el buffer no es de la vista: sigue siendo de quien llamo
 	return valores; // Devolver la lista con los datos
 }
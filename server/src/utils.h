@@ -28,40 +28,40 @@
 #include<sys/socket.h> // Proporciona la interfaz principal para trabajar con sockets (socket, bind, listen, etc.) (struct sockaddr)
 #include<unistd.h> // Contiene funciones POSIX básicas (read, write, close, etc.) Syscalls al SO
 #include<netdb.h> // Para trabajar con resolución de nombres de host y puertos (getaddrinfo(), freeaddrinfo()) (struct addrinfo)
+#include<fcntl.h> // Permite cambiar los flags de un fd (O_NONBLOCK)
+#include<errno.h> // Variable errno para distinguir EAGAIN/EINTR de errores reales
 
 // Librerías de la biblioteca Commons (de so-unix/utn)
 #include<commons/log.h> // Para crear logs fácilmente (t_log* logger, log_info, etc.).
 #include<commons/collections/list.h>
 
+// Protocolo compartido con el cliente (op_code, formato de los frames, handshake)
+#include<protocolo.h>
+#include<traza.h> // marcas de cada etapa del camino caliente (solo en debug)
+
 /* define un nombre simbólico (macro) llamado PUERTO,
  que será reemplazado por el valor "4444" en tiempo de compilación.*/
 #define PUERTO "4444"
 
-/**
- * @brief Define los tipos de operación que pueden ser enviados a través del socket
- * 
- * Permite saber qué tipo de contenido está llegando en una conexión, y así tomar decisiones distintas según el valor.
- */
-typedef enum
-{
-	MENSAJE,
-	PAQUETE
-}op_code;
-
 // Declaracion de variable global
 extern t_log* logger;
 
+/* Limites de los frames que se aceptan de los clientes (FRAME_MAXIMO_KB y PAQUETE_ELEMENTOS_MAXIMO en servidor.config) */
+extern t_limites_protocolo limites;
+
 /**
  * @brief Recibir datos dinámicos desde un socket
  * @param size (int) tamaño del buffer que va a llegar
  * @param socket_cliente (int) fd del socket ya conectado y verificado handshake
- * @return buffer (void*) retorna el buffer con los datos enviados y su tamanio (como variable generica)
+ * @return buffer (void*) retorna el buffer con los datos enviados y su tamanio (como variable generica),
+ * o NULL si el cliente se desconecto o el tamanio es negativo o supera limites.frame_maximo (no se reserva nada)
  */
 void* recibir_buffer(int*, int);
 
 /**
  * @brief Crea un socket de escucha, lo configura, lo bindea a un IP y puerto, y queda en escucha
- * @return socket_servidor (un fd)
+ * @return socket_servidor (un fd), o -1 si no se pudo bindear
+ * @note Por SO_REUSEPORT se puede llamar varias veces (una por worker) y todos los sockets escuchan en PUERTO
  */
 int iniciar_servidor(void);
 
@@ -73,14 +73,58 @@ int iniciar_servidor(void);
  */
 int esperar_cliente(int);
 
+/**
+ * @brief Acepta un cliente pendiente sin bloquear, dejando su socket en modo no bloqueante
+ * @param socket_servidor fd (int) del socket del server en escucha (no bloqueante)
+ * @return socket_cliente: fd (int) del socket aceptado, o -1 si no habia conexiones pendientes (errno == EAGAIN) o hubo error
+ * @note Pensada para el event loop: se llama en bucle hasta que devuelva -1
+ */
+int aceptar_cliente(int);
+
+/**
+ * @brief Pone un fd en modo no bloqueante (O_NONBLOCK)
+ * @param fd descriptor a configurar
+ * @return 0 si se pudo configurar, -1 si fallo fcntl()
+ */
+int configurar_no_bloqueante(int);
+
+/**
+ * @brief Escribe todo el bloque en un archivo, reintentando escrituras parciales e interrupciones (EINTR)
+ * @param posicion offset donde escribir con pwrite(), o -1 para escribir con write() en la posicion actual del fd
+ * @return 0 si se escribio todo, -1 si fallo (errno queda con el error)
+ * @note La comparten el grabador de capturas y la persistencia
+ */
+int escribir_todo(int fd, const void* datos, size_t cantidad, off_t posicion);
+
+/**
+ * @brief Responde el handshake de un cliente y devuelve la version de protocolo acordada
+ * @param socket_cliente fd del socket del cliente
+ * @param saludo los PROTOCOLO_TAMANIO_HANDSHAKE bytes que mando el cliente
+ * @param capacidades donde guardar las capacidades acordadas (las pedidas por el cliente que este servidor soporta)
+ * @return version acordada (la menor entre la del cliente y PROTOCOLO_VERSION_MAXIMA), o -1 si el saludo es invalido
+ * @note El cliente la inicia con handshake_cliente(). Si una conexion no arranca con el handshake se atiende como v1
+ */
+int handshake_servidor(int socket_cliente, const void* saludo, uint8_t* capacidades);
+
 /**
  * @brief Recibir un paquete compuesto por múltiples elementos (strings o bloques de datos) desde un socket, y almacenarlos en una lista (t_list*)
  * @param socket_cliente (int) fd del socket
  * @pre @p socket_cliente conectado, bindeado y aceptado
- * @return @p valores (t_list*) lista de elementos recibidos
+ * @return @p valores (t_list*) lista de elementos recibidos (vacia si el paquete estaba mal formado)
+ * @note Se mantiene por compatibilidad: recibir_paquete_vista() hace lo mismo sin copiar cada elemento
  */
 t_list* recibir_paquete(int);
 
+/**
+ * @brief Desempaqueta un buffer de PAQUETE (v1) ya recibido en una lista de elementos
+ * @param buffer bloque con los elementos serializados (| int tamanio | tamanio bytes | ...)
+ * @param size tamanio total del buffer en bytes
+ * @return @p valores (t_list*) lista con una copia de cada elemento (liberar con list_destroy_and_destroy_elements(valores, free))
+ * @note No libera @p buffer: el dueño sigue siendo quien lo recibio.
+ * Hace una reserva por elemento; para evitarlo usar paquete_vista_crear()
+ */
+t_list* deserializar_paquete(void*, int);
+
 /**
  * @brief Recibir un mensaje enviado desde un cliente por un socket
  * @param socket_cliente (int) fd del socket listo para comunicar
@@ -0,0 +1,80 @@
+/**
+ * @file workers.c
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief Codigo fuente de los workers del servidor
+ *
+ * Cada worker llama a iniciar_servidor() por su cuenta: como el socket tiene SO_REUSEPORT,
+ * todos quedan escuchando en el mismo PUERTO y el kernel balancea las conexiones entre ellos.
+ * @see https://man7.org/linux/man-pages/man7/socket.7.html (SO_REUSEPORT)
+ */
+
+#include "workers.h"
+
+int cantidad_de_cores(void)
+{
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? cores : 1;
+}
+
+/**
+ * @brief Funcion de cada hilo: se fija a su CPU, abre su socket de escucha y corre el event loop
+ */
+static void* correr_worker(void* arg)
+{
+	t_worker* worker = arg;
+
+	// Fijar el hilo a un CPU: las conexiones de este worker no saltan de cache en cache
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(worker->cpu, &cpus);
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+		log_warning(logger, "Worker %d: no se pudo fijar al CPU %d", worker->id, worker->cpu);
+
+	metricas_registrar_hilo(); // cada worker cuenta en sus propias metricas, sin compartirlas
+	char nombre[16];
+	snprintf(nombre, sizeof(nombre), "worker %d", worker->id);
+	pthread_setname_np(pthread_self(), nombre); // asi se distingue en top -H, gdb y las trazas
+
+	int socket_servidor = iniciar_servidor(); // socket propio, gracias a SO_REUSEPORT
+	if(socket_servidor == -1) {
+		log_error(logger, "Worker %d: no se pudo abrir el socket de escucha", worker->id);
+		return NULL;
+	}
+
+	log_info(logger, "Worker %d escuchando en el CPU %d", worker->id, worker->cpu);
+	// ejecutar_uring_loop() solo retorna -1 si io_uring no esta disponible: ahi se sigue con epoll
+	if(worker->backend != BACKEND_IO_URING || ejecutar_uring_loop(socket_servidor, worker->procesar) == -1)
+		ejecutar_event_loop(socket_servidor, worker->procesar);
+	close(socket_servidor);
+	return NULL;
+}
+
+int ejecutar_workers(int cantidad, t_backend_io backend, t_procesar_frame procesar)
+{
+	if(cantidad <= 0)
+		cantidad = cantidad_de_cores();
+
+	int cores = cantidad_de_cores();
+	t_worker* workers = malloc(cantidad * sizeof(t_worker));
+	int lanzados = 0;
+
+	for(int i = 0; i < cantidad; i++) {
+		workers[lanzados].id = i;
+		workers[lanzados].cpu = i % cores; // si hay mas workers que cores, se reparten en ronda
+		workers[lanzados].backend = backend;
+		workers[lanzados].procesar = procesar;
+		if(pthread_create(&workers[lanzados].hilo, NULL, correr_worker, &workers[lanzados]) != 0) {
+			log_error(logger, "No se pudo crear el worker %d", i);
+			continue;
+		}
+		lanzados++;
+	}
+
+	// Los event loops no terminan en funcionamiento normal: main() se queda esperando aca
+	for(int i = 0; i < lanzados; i++)
+		pthread_join(workers[i].hilo, NULL);
+
+	free(workers);
+	return lanzados > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file workers.h
+ * @author JuliKoro
+ * @date 16 Oct 2026
+ * @brief "header file" (encabezado) de los workers del servidor
+ *
+ * Cada worker es un hilo con su propio socket de escucha (SO_REUSEPORT) y su propio event loop,
+ * fijado a un CPU. El kernel reparte las conexiones nuevas entre los sockets, sin lock compartido en accept().
+ * @see https://man7.org/linux/man-pages/man7/socket.7.html (SO_REUSEPORT)
+ */
+
+#ifndef WORKERS_H_
+#define WORKERS_H_
+
+// Librerias standard de POSIX/Linux
+#include<pthread.h> // pthread_create, pthread_join, pthread_setaffinity_np, pthread_setname_np
+#include<sched.h> // cpu_set_t, CPU_ZERO, CPU_SET
+
+// Inclusión de los backends de I/O
+#include "event_loop.h"
+#include "uring_loop.h"
+
+/**
+ * @brief Mecanismo con el que cada worker espera y recibe datos de los sockets (IO_BACKEND en servidor.config)
+ */
+typedef enum
+{
+	BACKEND_EPOLL, /**< epoll edge-triggered + recv() no bloqueante (por defecto) */
+	BACKEND_IO_URING /**< io_uring con recv multishot y buffer ring; si no esta disponible se usa epoll */
+} t_backend_io;
+
+/**
+ * @brief Un hilo del servidor con su socket de escucha y su event loop
+ */
+typedef struct
+{
+	pthread_t hilo; /**< hilo que corre el event loop */
+	int id; /**< numero de worker (0..N-1), solo para los logs */
+	int cpu; /**< CPU al que queda fijado el hilo */
+	t_backend_io backend; /**< event loop a usar */
+	t_procesar_frame procesar; /**< funcion que procesa cada frame recibido */
+} t_worker;
+
+/**
+ * @brief Devuelve la cantidad de cores disponibles (valor por defecto de WORKERS)
+ */
+int cantidad_de_cores(void);
+
+/**
+ * @brief Lanza @p cantidad workers y espera a que terminen
+ * @param cantidad cantidad de hilos (si es <= 0 se usa cantidad_de_cores())
+ * @param backend mecanismo de I/O de cada worker
+ * @param procesar funcion que procesa cada frame completo de cualquier cliente
+ * @return EXIT_SUCCESS cuando terminan todos los workers, EXIT_FAILURE si no se pudo lanzar ninguno
+ */
+int ejecutar_workers(int cantidad, t_backend_io backend, t_procesar_frame procesar);
+
+#endif /* WORKERS_H_ */